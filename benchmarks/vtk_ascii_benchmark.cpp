@@ -0,0 +1,84 @@
+#include <iostream>
+#include <fstream>
+#include <iomanip>
+#include <chrono>
+#include <vector>
+#include <string>
+#include <random>
+#include <cstdio>
+#include <functional>
+
+#include <vtk_asciiformatter.hpp>
+
+// Throughput of the ascii formatting: std::ofstream::operator<< against VTK_AsciiFormatter.
+// Usage: vtkasciibenchmark [number of values]
+int main(int argc, char** argv)
+{
+    const size_t novalues = (argc > 1) ? std::stoul(argv[1]) : 2000000;
+    const std::string path = "vtk_ascii_benchmark.tmp";
+
+    std::mt19937_64 random(42);
+    std::uniform_real_distribution<double> uniform(-1000.0, 1000.0);
+    std::vector<double> doubles(novalues);
+    std::vector<size_t> indices(novalues);
+    for (size_t i=0; i<novalues; i++)
+    {
+        doubles[i] = uniform(random);
+        indices[i] = random() % 100000000;
+    }
+
+    // runs one variant, reports the throughput of the written text
+    auto measure = [&](const std::string& name, const std::function<void(std::ofstream&)>& variant)
+    {
+        std::ofstream outfile(path, std::ios::out | std::ios::binary);
+        const auto start = std::chrono::steady_clock::now();
+        variant(outfile);
+        outfile.close();
+        const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now()-start).count();
+        std::ifstream infile(path, std::ios::binary | std::ios::ate);
+        const double megabytes = static_cast<double>(infile.tellg())/1e6;
+        std::cout << std::left << std::setw(42) << name
+                  << std::right << std::setw(10) << std::fixed << std::setprecision(3) << seconds << " s "
+                  << std::setw(10) << std::setprecision(1) << megabytes/seconds << " MB/s "
+                  << std::setw(10) << std::setprecision(2) << novalues/seconds/1e6 << " Mvalues/s" << std::endl;
+    };
+
+    std::cout << "Formatting " << novalues << " values" << std::endl;
+    measure("Float64 ostream (6 digits, lossy)", [&](std::ofstream& outfile)
+    {
+        for (auto &value : doubles) outfile << value << " ";
+    });
+    measure("Float64 ostream (17 digits)", [&](std::ofstream& outfile)
+    {
+        outfile << std::setprecision(17);
+        for (auto &value : doubles) outfile << value << " ";
+    });
+    measure("Float64 to_chars (6 digits)", [&](std::ofstream& outfile)
+    {
+        VTK_AsciiFormatter formatter(6);
+        formatter.attach(&outfile);
+        for (auto &value : doubles) formatter.value(value);
+        formatter.flush();
+    });
+    measure("Float64 to_chars (shortest round trip)", [&](std::ofstream& outfile)
+    {
+        VTK_AsciiFormatter formatter;
+        formatter.attach(&outfile);
+        for (auto &value : doubles) formatter.value(value);
+        formatter.flush();
+    });
+    measure("UInt64 ostream", [&](std::ofstream& outfile)
+    {
+        for (auto &value : indices) outfile << value << " ";
+    });
+    measure("UInt64 to_chars", [&](std::ofstream& outfile)
+    {
+        VTK_AsciiFormatter formatter;
+        formatter.attach(&outfile);
+        for (auto &value : indices) formatter.value(value);
+        formatter.flush();
+    });
+
+    std::remove(path.c_str());
+    return 0;
+}
@@ -0,0 +1,121 @@
+#pragma once
+
+#include <vector>
+#include <cmath>
+#include <string>
+#include <stdexcept>
+#include <random>
+#include <algorithm>
+
+#include <vtk_definitions.hpp>
+
+/*
+Synthetic meshes for the benchmarks: a structured block of n x n x n hexahedra on [0,1]^3,
+optionally every hexahedron split into 6 tetrahedra.
+The fields are smooth functions of the coordinates, so the compression sees realistic data.
+*/
+struct VTK_BenchmarkMesh
+{
+    VTK_CELLTYPE CellType;
+    std::vector<double> XI;            // 3 coordinates per point
+    std::vector<size_t> Elmt;          // nodes of the cells, flattened
+    std::vector<double> Temperature;   // 1 value per point
+    std::vector<double> Velocity;      // 3 values per point
+    std::vector<double> Pressure;      // 1 value per cell
+    std::vector<int> Material;         // 1 value per cell
+
+    size_t NoPoints() const { return XI.size()/3; }
+    size_t NoCells() const { return Elmt.size()/VTK_CELL_NODES(CellType); }
+};
+
+// Generates a block with about no_cells cells of type VTK_HEXAHEDRON or VTK_TETRA
+inline VTK_BenchmarkMesh VTK_GenerateBenchmarkMesh(size_t no_cells, VTK_CELLTYPE cell_type)
+{
+    if (cell_type != VTK_HEXAHEDRON && cell_type != VTK_TETRA) throw std::runtime_error("Error generating the benchmark mesh! Only VTK_HEXAHEDRON and VTK_TETRA are supported.");
+    const size_t cells_per_hex = (cell_type == VTK_TETRA) ? 6 : 1;
+    const size_t n = std::max<size_t>(1, static_cast<size_t>(std::llround(std::cbrt(static_cast<double>(no_cells)/cells_per_hex))));
+    const size_t np = n+1;
+    const double h = 1.0/n;
+    const double pi = 3.14159265358979323846;
+
+    VTK_BenchmarkMesh mesh;
+    mesh.CellType = cell_type;
+    mesh.XI.resize(3*np*np*np);
+    mesh.Temperature.resize(np*np*np);
+    mesh.Velocity.resize(3*np*np*np);
+    for (size_t k=0; k<np; k++)
+        for (size_t j=0; j<np; j++)
+            for (size_t i=0; i<np; i++)
+            {
+                const size_t p = (k*np+j)*np+i;
+                const double x = i*h, y = j*h, z = k*h;
+                mesh.XI[3*p] = x;
+                mesh.XI[3*p+1] = y;
+                mesh.XI[3*p+2] = z;
+                mesh.Temperature[p] = 300.0+50.0*std::sin(3.0*x)*std::cos(2.0*y)+10.0*z;
+                mesh.Velocity[3*p] = -std::sin(pi*y);
+                mesh.Velocity[3*p+1] = std::sin(pi*x);
+                mesh.Velocity[3*p+2] = 0.1*z*(1.0-z);
+            }
+
+    // the 8 corners of hexahedron (i,j,k) in VTK order and its split into 6 tetrahedra around the diagonal 0-6
+    const size_t corner[8][3] = {{0,0,0}, {1,0,0}, {1,1,0}, {0,1,0}, {0,0,1}, {1,0,1}, {1,1,1}, {0,1,1}};
+    const size_t tets[6][4] = {{0,1,2,6}, {0,2,3,6}, {0,3,7,6}, {0,7,4,6}, {0,4,5,6}, {0,5,1,6}};
+    mesh.Elmt.reserve(n*n*n*cells_per_hex*VTK_CELL_NODES(cell_type));
+    for (size_t k=0; k<n; k++)
+        for (size_t j=0; j<n; j++)
+            for (size_t i=0; i<n; i++)
+            {
+                size_t nodes[8];
+                for (size_t c=0; c<8; c++) nodes[c] = ((k+corner[c][2])*np+j+corner[c][1])*np+i+corner[c][0];
+                if (cell_type == VTK_HEXAHEDRON) mesh.Elmt.insert(mesh.Elmt.end(), nodes, nodes+8);
+                else for (auto &tet : tets) for (size_t c=0; c<4; c++) mesh.Elmt.push_back(nodes[tet[c]]);
+            }
+
+    mesh.Pressure.resize(mesh.NoCells());
+    mesh.Material.resize(mesh.NoCells());
+    for (size_t c=0; c<mesh.NoCells(); c++)
+    {
+        mesh.Pressure[c] = 1e5*(1.0+0.01*std::sin(0.001*c));
+        mesh.Material[c] = static_cast<int>((c/cells_per_hex)%n < n/2 ? 1 : 2);
+    }
+    return mesh;
+}
+
+// Numbers the points and cells of the mesh randomly, like the numbering of a solver after partitioning or refinement
+inline void VTK_ShuffleBenchmarkMesh(VTK_BenchmarkMesh& mesh, unsigned int seed = 1)
+{
+    std::mt19937_64 random(seed);
+    const size_t no_points = mesh.NoPoints(), no_cells = mesh.NoCells(), no_nodes = VTK_CELL_NODES(mesh.CellType);
+    std::vector<size_t> points(no_points), cells(no_cells);
+    for (size_t p=0; p<no_points; p++) points[p] = p;
+    for (size_t c=0; c<no_cells; c++) cells[c] = c;
+    std::shuffle(points.begin(), points.end(), random);
+    std::shuffle(cells.begin(), cells.end(), random);
+
+    // point p moves to points[p], cell c moves to cells[c]
+    VTK_BenchmarkMesh shuffled;
+    shuffled.CellType = mesh.CellType;
+    shuffled.XI.resize(mesh.XI.size());
+    shuffled.Temperature.resize(mesh.Temperature.size());
+    shuffled.Velocity.resize(mesh.Velocity.size());
+    for (size_t p=0; p<no_points; p++)
+    {
+        for (size_t d=0; d<3; d++)
+        {
+            shuffled.XI[3*points[p]+d] = mesh.XI[3*p+d];
+            shuffled.Velocity[3*points[p]+d] = mesh.Velocity[3*p+d];
+        }
+        shuffled.Temperature[points[p]] = mesh.Temperature[p];
+    }
+    shuffled.Elmt.resize(mesh.Elmt.size());
+    shuffled.Pressure.resize(no_cells);
+    shuffled.Material.resize(no_cells);
+    for (size_t c=0; c<no_cells; c++)
+    {
+        for (size_t i=0; i<no_nodes; i++) shuffled.Elmt[no_nodes*cells[c]+i] = points[mesh.Elmt[no_nodes*c+i]];
+        shuffled.Pressure[cells[c]] = mesh.Pressure[c];
+        shuffled.Material[cells[c]] = mesh.Material[c];
+    }
+    mesh = std::move(shuffled);
+}
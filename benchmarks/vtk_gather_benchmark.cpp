@@ -0,0 +1,79 @@
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <vector>
+#include <string>
+#include <cstring>
+#include <functional>
+
+#include <vtk_array.hpp>
+
+// element of an array of structs as it is found in solver codes
+struct Node
+{
+    int id;
+    double coordinates[3];
+    double stress[9];
+    double temperature;
+    char flag;
+};
+
+// the generic gather: two multiplies and one copy per value
+void genericGather(const char* data, size_t no_components, size_t entity_stride, size_t component_stride, size_t first_entity, size_t no_entities, char* buffer)
+{
+    for (size_t ENTITY=first_entity; ENTITY<first_entity+no_entities; ENTITY++)
+        for (size_t COMP=0; COMP<no_components; COMP++)
+        {
+            std::memcpy(buffer, data+ENTITY*entity_stride+COMP*component_stride, sizeof(double));
+            buffer += sizeof(double);
+        }
+}
+
+// Throughput of VTK_DataArray::gather(...) against the generic loop for the common layouts.
+// Usage: vtkgatherbenchmark [number of entities]
+int main(int argc, char** argv)
+{
+    const size_t noentities = (argc > 1) ? std::stoul(argv[1]) : 2000000;
+    const size_t chunk = 1 << 14;
+    const size_t repetitions = 5;
+
+    std::vector<Node> nodes(noentities);
+    std::vector<double> contiguous(3*noentities);
+    for (size_t i=0; i<noentities; i++)
+    {
+        nodes[i].id = static_cast<int>(i);
+        for (size_t c=0; c<3; c++) nodes[i].coordinates[c] = contiguous[3*i+c] = 0.5*i+c;
+        for (size_t c=0; c<9; c++) nodes[i].stress[c] = 0.1*i-c;
+        nodes[i].temperature = 1.0*i;
+    }
+    std::vector<char> buffer(chunk*9*sizeof(double));
+
+    // gathers the whole array in chunks as the writer does, reports the gathered bytes per second
+    auto measure = [&](const std::string& name, const double* data_start, std::array<size_t, 2> shape, std::array<size_t, 2> strides)
+    {
+        const VTK_DataArray<double> data(name, data_start, shape, strides);
+        auto run = [&](const std::function<void(size_t, size_t)>& gather)
+        {
+            const auto start = std::chrono::steady_clock::now();
+            for (size_t r=0; r<repetitions; r++)
+                for (size_t first=0; first<data.NoEntities(); first+=chunk) gather(first, std::min(chunk, data.NoEntities()-first));
+            return std::chrono::duration<double>(std::chrono::steady_clock::now()-start).count()/repetitions;
+        };
+        const char* raw = reinterpret_cast<const char*>(data_start);
+        const double generic = run([&](size_t first, size_t n){ genericGather(raw, shape[1], strides[0], strides[1], first, n, buffer.data()); });
+        const double specialized = run([&](size_t first, size_t n){ data.gather(first, n, buffer.data()); });
+        const double gigabytes = static_cast<double>(data.ByteSize())/1e9;
+        std::cout << std::left << std::setw(36) << name
+                  << std::right << std::setw(8) << std::fixed << std::setprecision(2) << gigabytes/generic << " GB/s generic "
+                  << std::setw(8) << gigabytes/specialized << " GB/s specialized "
+                  << std::setw(8) << generic/specialized << "x" << std::endl;
+    };
+
+    std::cout << "Gathering " << noentities << " entities" << std::endl;
+    measure("Float64x3 contiguous", contiguous.data(), {noentities, 3}, {3*sizeof(double), sizeof(double)});
+    measure("Float64x1 array of structs", &nodes[0].temperature, {noentities, 1}, {sizeof(Node), sizeof(double)});
+    measure("Float64x3 array of structs", nodes[0].coordinates, {noentities, 3}, {sizeof(Node), sizeof(double)});
+    measure("Float64x9 array of structs", nodes[0].stress, {noentities, 9}, {sizeof(Node), sizeof(double)});
+    measure("Float64x3 struct of arrays", contiguous.data(), {noentities/3, 3}, {sizeof(double), noentities*sizeof(double)});
+    return 0;
+}
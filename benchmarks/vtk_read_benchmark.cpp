@@ -0,0 +1,101 @@
+#include <iostream>
+#include <fstream>
+#include <iomanip>
+#include <chrono>
+#include <vector>
+#include <string>
+#include <cstdio>
+#include <thread>
+
+#include <vtk_reader.hpp>
+#include <vtk_unstructuredgrid.hpp>
+
+#include "vtk_benchmark_mesh.hpp"
+
+// Times the restart from every output mode of VTK_UnstructuredGrid::write(...) on a synthetic mesh:
+// the file is read back into the buffers of the mesh, and only viewed (VTK_Reader::read) without the conversion.
+// The files are read right after they are written, so they are usually in the page cache.
+// Usage: vtkreadbenchmark [number of cells (1000)] [hex|tet (hex)] [number of threads (all)]
+// Returns 1 if a file is not read back identically.
+int main(int argc, char** argv)
+{
+    const size_t nocells = (argc > 1) ? std::stoul(argv[1]) : 1000;
+    const VTK_CELLTYPE celltype = (argc > 2 && std::string(argv[2]) == "tet") ? VTK_TETRA : VTK_HEXAHEDRON;
+    const unsigned int nothreads = (argc > 3) ? std::stoul(argv[3]) : std::max(1u, std::thread::hardware_concurrency());
+    const std::string path = "vtk_read_benchmark_"+std::to_string(nocells)+"_"+(celltype == VTK_TETRA ? "tet" : "hex")+".vtu";
+
+    const VTK_BenchmarkMesh mesh = VTK_GenerateBenchmarkMesh(nocells, celltype);
+    VTK_UnstructuredGrid VTKOUT;
+    VTKOUT.setPoints(mesh.XI);
+    VTKOUT.setElements(mesh.Elmt, mesh.CellType);
+    VTKOUT.addNodeData("Temperature", mesh.Temperature, 1);
+    VTKOUT.addNodeData("Velocity", mesh.Velocity, 3);
+    VTKOUT.addCellData("Pressure", mesh.Pressure, 1);
+    VTKOUT.addCellData("Material", mesh.Material, 1);
+    VTKOUT.setNumberOfThreads(nothreads);
+
+    std::vector<std::pair<std::string, VTK_WriteSettings>> modes;
+    auto mode = [&modes](const std::string& name, VTK_OUTPUTFORMAT format, VTK_COMPRESSOR compressor)
+    {
+        VTK_WriteSettings settings;
+        settings.format = format;
+        settings.compressor = compressor;
+        modes.push_back({name, settings});
+    };
+    mode("ascii", VTK_ASCII, VTK_NO_COMPRESSION);
+    mode("binary", VTK_BINARY, VTK_NO_COMPRESSION);
+    mode("appended", VTK_APPENDED_RAW, VTK_NO_COMPRESSION);
+#ifdef VTK_WITH_ZLIB
+    mode("binary zlib", VTK_BINARY, VTK_ZLIB);
+    mode("appended zlib", VTK_APPENDED_RAW, VTK_ZLIB);
+#endif
+#ifdef VTK_WITH_LZ4
+    mode("appended lz4", VTK_APPENDED_RAW, VTK_LZ4);
+#endif
+
+    std::cout << "Reading " << mesh.NoCells() << " cells, " << mesh.NoPoints() << " points on " << nothreads << " threads" << std::endl;
+    std::cout << std::left << std::setw(20) << "mode" << std::right << std::setw(10) << "view s" << std::setw(10) << "restart s" << std::setw(12) << "MB"
+              << std::setw(12) << "MB/s" << std::setw(14) << "Mcells/s" << std::endl;
+    int failures = 0;
+    for (auto &entry : modes)
+    {
+        VTKOUT.setWriteSettings(entry.second);
+        VTKOUT.write(path);
+        std::ifstream infile(path, std::ios::binary | std::ios::ate);
+        const double megabytes = static_cast<double>(infile.tellg())/1e6;
+
+        // all arrays as views or decoded arrays
+        auto start = std::chrono::steady_clock::now();
+        {
+            VTK_Reader reader(path);
+            reader.setNumberOfThreads(nothreads);
+            for (auto &info : reader.Arrays()) reader.read(info.section, info.name);
+        }
+        const double view_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now()-start).count();
+
+        // the restart: all arrays converted into the buffers of the solver
+        start = std::chrono::steady_clock::now();
+        VTK_Reader reader(path);
+        reader.setNumberOfThreads(nothreads);
+        const std::vector<double> XI = reader.values<double>("Points", "Coordinates");
+        const std::vector<size_t> Elmt = reader.values<size_t>("Cells", "connectivity");
+        const std::vector<double> Temperature = reader.values<double>("PointData", "Temperature");
+        const std::vector<double> Velocity = reader.values<double>("PointData", "Velocity");
+        const std::vector<double> Pressure = reader.values<double>("CellData", "Pressure");
+        const std::vector<int> Material = reader.values<int>("CellData", "Material");
+        const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now()-start).count();
+        std::cout << std::left << std::setw(20) << entry.first
+                  << std::right << std::fixed << std::setw(10) << std::setprecision(3) << view_seconds
+                  << std::setw(10) << std::setprecision(3) << seconds
+                  << std::setw(12) << std::setprecision(2) << megabytes
+                  << std::setw(12) << std::setprecision(1) << megabytes/seconds
+                  << std::setw(14) << std::setprecision(2) << mesh.NoCells()/seconds/1e6 << std::endl;
+        std::remove(path.c_str());
+        if (XI != mesh.XI || Elmt != mesh.Elmt || Temperature != mesh.Temperature || Velocity != mesh.Velocity || Pressure != mesh.Pressure || Material != mesh.Material)
+        {
+            std::cout << "Error reading " << entry.first << "! The values differ from the written mesh." << std::endl;
+            failures++;
+        }
+    }
+    return failures > 0 ? 1 : 0;
+}
@@ -0,0 +1,156 @@
+#include <iostream>
+#include <fstream>
+#include <iomanip>
+#include <chrono>
+#include <vector>
+#include <string>
+#include <cstdio>
+#include <thread>
+#include <functional>
+#include <sys/resource.h>
+
+#include <vtk_unstructuredgrid.hpp>
+
+#include "vtk_benchmark_mesh.hpp"
+
+// Resets the peak resident set size of the process (Linux only, ignored elsewhere)
+void resetPeakRSS()
+{
+    std::ofstream clear_refs("/proc/self/clear_refs");
+    if (clear_refs) clear_refs << "5";
+}
+
+// Peak resident set size in MB since the last reset, falls back to the peak of the whole run
+double peakRSS()
+{
+    std::ifstream status("/proc/self/status");
+    std::string line;
+    while (std::getline(status, line))
+        if (line.compare(0, 6, "VmHWM:") == 0) return std::stod(line.substr(6))/1024.0;
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss/1024.0;
+}
+
+// Times every output mode of VTK_UnstructuredGrid::write(...) and the boundary surface of writeSurface(...) on a synthetic mesh,
+// the last mode with error bounded fields, and the last mode on the randomly numbered mesh without and with the reorderings of setReordering(...).
+// Usage: vtkwritebenchmark [number of cells (1000)] [hex|tet (hex)] [number of threads (all)] [minimum MB/s of every mode (0)] [stream|mapped|async (stream)]
+// Returns 1 if a write fails or a mode stays below the minimum throughput.
+int main(int argc, char** argv)
+{
+    const size_t nocells = (argc > 1) ? std::stoul(argv[1]) : 1000;
+    const VTK_CELLTYPE celltype = (argc > 2 && std::string(argv[2]) == "tet") ? VTK_TETRA : VTK_HEXAHEDRON;
+    const unsigned int nothreads = (argc > 3) ? std::stoul(argv[3]) : std::max(1u, std::thread::hardware_concurrency());
+    const double minimum = (argc > 4) ? std::stod(argv[4]) : 0.0;
+    const std::string backendname = (argc > 5) ? argv[5] : "stream";
+    const VTK_FILEBACKEND backend = (backendname == "mapped") ? VTK_MAPPED_FILE : (backendname == "async") ? VTK_ASYNC_FILE : VTK_STREAM_FILE;
+    // the files are named by the run, so that several runs (e.g. the ctest entries under ctest -j) do not share them
+    const std::string basename = "vtk_write_benchmark_"+std::to_string(nocells)+"_"+(celltype == VTK_TETRA ? "tet" : "hex")+"_"+backendname;
+    const std::string path = basename+".vtu";
+
+    const VTK_BenchmarkMesh mesh = VTK_GenerateBenchmarkMesh(nocells, celltype);
+    VTK_UnstructuredGrid VTKOUT;
+    VTKOUT.setPoints(mesh.XI);
+    VTKOUT.setElements(mesh.Elmt, mesh.CellType);
+    VTKOUT.addNodeData("Temperature", mesh.Temperature, 1);
+    VTKOUT.addNodeData("Velocity", mesh.Velocity, 3);
+    VTKOUT.addCellData("Pressure", mesh.Pressure, 1);
+    VTKOUT.addCellData("Material", mesh.Material, 1);
+    VTKOUT.setNumberOfThreads(nothreads);
+    VTKOUT.setFileBackend(backend);
+
+    std::vector<std::pair<std::string, VTK_WriteSettings>> modes;
+    auto mode = [&modes](const std::string& name, VTK_OUTPUTFORMAT format, VTK_COMPRESSOR compressor, bool float32)
+    {
+        VTK_WriteSettings settings;
+        settings.format = format;
+        settings.compressor = compressor;
+        settings.float32_fields = float32;
+        modes.push_back({name, settings});
+    };
+    mode("ascii", VTK_ASCII, VTK_NO_COMPRESSION, false);
+    mode("binary", VTK_BINARY, VTK_NO_COMPRESSION, false);
+    mode("appended", VTK_APPENDED_RAW, VTK_NO_COMPRESSION, false);
+    mode("appended float32", VTK_APPENDED_RAW, VTK_NO_COMPRESSION, true);
+#ifdef VTK_WITH_ZLIB
+    mode("binary zlib", VTK_BINARY, VTK_ZLIB, false);
+    mode("appended zlib", VTK_APPENDED_RAW, VTK_ZLIB, false);
+#endif
+#ifdef VTK_WITH_LZ4
+    mode("appended lz4", VTK_APPENDED_RAW, VTK_LZ4, false);
+#endif
+
+    std::cout << "Writing " << mesh.NoCells() << " cells, " << mesh.NoPoints() << " points on " << nothreads << " threads, " << backendname << " file backend" << std::endl;
+    std::cout << std::left << std::setw(24) << "mode" << std::right << std::setw(10) << "s" << std::setw(12) << "MB"
+              << std::setw(12) << "MB/s" << std::setw(14) << "Mcells/s" << std::setw(14) << "peak RSS MB" << std::endl;
+    int failures = 0;
+    // writes one mode into a fresh file, truncating the file of the previous mode may flush it within the timing
+    auto run = [&](const std::string& name, const std::string& file, const std::function<bool()>& write)
+    {
+        std::remove(file.c_str());
+        resetPeakRSS();
+        const auto start = std::chrono::steady_clock::now();
+        const bool good = write();
+        const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now()-start).count();
+        std::ifstream infile(file, std::ios::binary | std::ios::ate);
+        const double megabytes = static_cast<double>(infile.tellg())/1e6;
+        std::cout << std::left << std::setw(24) << name
+                  << std::right << std::fixed << std::setw(10) << std::setprecision(3) << seconds
+                  << std::setw(12) << std::setprecision(2) << megabytes
+                  << std::setw(12) << std::setprecision(1) << megabytes/seconds
+                  << std::setw(14) << std::setprecision(2) << mesh.NoCells()/seconds/1e6
+                  << std::setw(14) << std::setprecision(1) << peakRSS() << std::endl;
+        std::remove(file.c_str());
+        if (!good || megabytes <= 0.0)
+        {
+            std::cout << "Error writing " << name << "!" << std::endl;
+            failures++;
+        }
+        else if (megabytes/seconds < minimum)
+        {
+            std::cout << name << " is below " << minimum << " MB/s" << std::endl;
+            failures++;
+        }
+    };
+    for (auto &entry : modes)
+    {
+        VTKOUT.setWriteSettings(entry.second);
+        run(entry.first, path, [&]{ return VTKOUT.write(path); });
+    }
+
+    // the boundary surface only, the faces are found in the first write and reused by the following ones
+    VTKOUT.setWriteSettings(modes[2].second);
+    const std::string surfacepath = basename+".vtp";
+    run("surface first", surfacepath, [&]{ return VTKOUT.writeSurface(surfacepath); });
+    run("surface appended", surfacepath, [&]{ return VTKOUT.writeSurface(surfacepath); });
+
+    // the fields within error bounds in the last mode: rounded to 1e-4 relative, and as UInt32 steps of 1e-4 absolute
+    VTKOUT.setWriteSettings(modes.back().second);
+    for (auto name : {"Temperature", "Velocity", "Pressure"}) VTKOUT.setErrorBound(name, VTK_RELATIVE_ERROR, 1e-4);
+    run("bounded rounded", path, [&]{ return VTKOUT.write(path); });
+    for (auto name : {"Temperature", "Velocity", "Pressure"}) VTKOUT.setErrorBound(name, VTK_ABSOLUTE_ERROR, 1e-4, VTK_QUANTIZED_INTEGERS);
+    run("bounded quantized", path, [&]{ return VTKOUT.write(path); });
+
+    // the mesh numbered randomly in the last mode, as it is and reordered: the first write includes finding the order, the following reuse it
+    VTK_BenchmarkMesh shuffled = mesh;
+    VTK_ShuffleBenchmarkMesh(shuffled);
+    VTK_UnstructuredGrid SHUFFLED;
+    SHUFFLED.setPoints(shuffled.XI);
+    SHUFFLED.setElements(shuffled.Elmt, shuffled.CellType);
+    SHUFFLED.addNodeData("Temperature", shuffled.Temperature, 1);
+    SHUFFLED.addNodeData("Velocity", shuffled.Velocity, 3);
+    SHUFFLED.addCellData("Pressure", shuffled.Pressure, 1);
+    SHUFFLED.addCellData("Material", shuffled.Material, 1);
+    SHUFFLED.setNumberOfThreads(nothreads);
+    SHUFFLED.setFileBackend(backend);
+    SHUFFLED.setWriteSettings(modes.back().second);
+    const std::vector<std::pair<std::string, VTK_REORDERING>> reorderings = {{"shuffled", VTK_NO_REORDERING}, {"shuffled morton", VTK_MORTON},
+                                                                             {"shuffled hilbert", VTK_HILBERT}, {"shuffled rcm", VTK_RCM}};
+    for (auto &reordering : reorderings)
+    {
+        SHUFFLED.setReordering(reordering.second);
+        run(reordering.first, path, [&]{ return SHUFFLED.write(path); });
+        if (reordering.second != VTK_NO_REORDERING) run(reordering.first+" again", path, [&]{ return SHUFFLED.write(path); });
+    }
+    return failures > 0 ? 1 : 0;
+}
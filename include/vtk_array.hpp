@@ -4,8 +4,18 @@
 #include <iostream>
 #include <fstream>
 #include <sstream>
+#include <array>
+#include <vector>
+#include <cstring>
+#include <cstdint>
+#include <algorithm>
+#include <stdexcept>
+#include <memory>
+#include <type_traits>
 
 #include "vtk_definitions.hpp"
+#include "vtk_asciiformatter.hpp"
+#include "vtk_gather.hpp"
 
 //abstract base class
 class VTK_Array
@@ -13,10 +23,70 @@ class VTK_Array
     public:
         virtual ~VTK_Array() {};
     public:
+        virtual std::string Name() const = 0;
+        virtual std::string Type() const = 0;
         virtual size_t NoComponents() const = 0;
         virtual size_t NoEntities() const = 0;
+        // size of one value in bytes, as written in the binary formats
+        virtual size_t ValueSize() const = 0;
+        // additional attributes of the DataArray tag, each followed by a space, e.g. the scale of quantized values
+        virtual std::string Attributes() const {return "";}
         virtual void print() const = 0;
-        virtual bool write(std::ofstream& OUTFILE) const = 0;
+    public:
+        // Ascii interface: formats the values of the entities [first_entity, first_entity+no_entities)
+        virtual void format(VTK_AsciiFormatter& formatter, size_t first_entity, size_t no_entities) const = 0;
+    public:
+        // Binary interface: pointer to the raw values if they lie continuous in memory, nullptr otherwise
+        virtual const char* ContiguousData() const {return nullptr;}
+        // Binary interface: copies the raw values of the entities [first_entity, first_entity+no_entities) into buffer
+        virtual void gather(size_t first_entity, size_t no_entities, char* buffer) const = 0;
+    public:
+        size_t ByteSize() const {return NoEntities()*NoComponents()*ValueSize();}
+
+        // Writes the ascii DataArray through the formatter
+        bool writeAscii(VTK_AsciiFormatter& formatter, bool with_components = true) const
+        {
+            std::string tag = "<DataArray Name=\""+Name()+"\" ";
+            if (with_components) tag += "NumberOfComponents=\""+std::to_string(NoComponents())+"\" ";
+            tag += "format=\"ascii\" type=\""+Type()+"\" "+Attributes()+">";
+            formatter.text(tag);
+            format(formatter, 0, NoEntities());
+            formatter.text("</DataArray>\n");
+            return true;
+        }
+
+        // Writes the data array in ascii format to file
+        bool write(std::ofstream& OUTFILE) const
+        {
+            VTK_AsciiFormatter formatter;
+            formatter.attach(&OUTFILE);
+            writeAscii(formatter);
+            formatter.flush();
+            return OUTFILE.good();
+        }
+
+        // Binary interface: copies the bytes [first_byte, first_byte+no_bytes) of the packed values into buffer,
+        // the range does not need to be aligned to entities
+        void gatherBytes(size_t first_byte, size_t no_bytes, char* buffer) const
+        {
+            if (no_bytes == 0) return;
+            if (const char* raw = ContiguousData())
+            {
+                std::memcpy(buffer, raw+first_byte, no_bytes);
+                return;
+            }
+            const size_t entity_bytes = NoComponents()*ValueSize();
+            const size_t first = first_byte/entity_bytes;
+            const size_t last = (first_byte+no_bytes+entity_bytes-1)/entity_bytes;
+            if (first*entity_bytes == first_byte && last*entity_bytes == first_byte+no_bytes)
+            {
+                gather(first, last-first, buffer);
+                return;
+            }
+            std::vector<char> entities((last-first)*entity_bytes);
+            gather(first, last-first, entities.data());
+            std::memcpy(buffer, entities.data()+(first_byte-first*entity_bytes), no_bytes);
+        }
 };
 
 /*
@@ -80,6 +150,7 @@ class VTK_DataArray : public VTK_Array
         const T* data;
         size_t strides_between_starts_of_entities; // in bits
         size_t strides_between_starts_of_components; // in bits
+        VTK_LAYOUT Layout_; // selects the gather kernel
     public:
 //      VTK_DataArray(  
 //             std::string name_,              ->  name of the data array
@@ -97,12 +168,28 @@ class VTK_DataArray : public VTK_Array
           data(data_start_), 
           strides_between_starts_of_entities(strides_[0]), 
           strides_between_starts_of_components(strides_[1]), 
-          DataType(VTKType(data_start_[0])) 
+          DataType(VTKType(T())),
+          Layout_(VTK_ArrayLayout(sizeof(T), shape_[1], strides_[0], strides_[1]))
         {}
 
     public:
+        std::string Name() const {return DataArrayName;}
+        std::string Type() const {return DataType;}
         size_t NoComponents() const {return NoComponents_;}
         size_t NoEntities() const {return NoEntities_;}
+        size_t ValueSize() const {return sizeof(T);}
+    public:
+        // The data is continuous if components and entities follow each other without gaps
+        const char* ContiguousData() const
+        {
+            return (Layout_ == VTK_LAYOUT_CONTIGUOUS) ? (const char*) data : nullptr;
+        }
+        // Copies the values of the entities [first_entity, first_entity+no_entities) packed into buffer, see vtk_gather.hpp
+        void gather(size_t first_entity, size_t no_entities, char* buffer) const
+        {
+            const char *ptr = (const char*) data+ first_entity*strides_between_starts_of_entities;
+            VTK_Gather<T>(Layout_, ptr, NoComponents_, strides_between_starts_of_entities, strides_between_starts_of_components, no_entities, buffer);
+        }
     public:
         // Print the data to std::cout
         void print() const
@@ -121,45 +208,305 @@ class VTK_DataArray : public VTK_Array
             }
         }
     public:
-        // Writes data to file
-        bool write(std::ofstream& OUTFILE) const
-        {   
-            std::string format("ascii");
-            // open data array
-            OUTFILE << "<DataArray ";
-            OUTFILE << "Name=\""                << DataArrayName << "\" ";
-            OUTFILE << "NumberOfComponents=\""  << NoComponents_ << "\" ";
-            OUTFILE << "format=\""              << format << "\" ";
-            OUTFILE << "type=\""                << DataType << "\" ";
-            OUTFILE << ">";
-            for (size_t ENTITY=0; ENTITY<NoEntities_; ENTITY++)
-                for (size_t COMP=0; COMP<NoComponents_; COMP++)
+        // Formats the values of the entities [first_entity, first_entity+no_entities)
+        void format(VTK_AsciiFormatter& formatter, size_t first_entity, size_t no_entities) const
+        {
+            const char *entity = (const char*) data+ first_entity*strides_between_starts_of_entities;
+            for (size_t ENTITY=0; ENTITY<no_entities; ENTITY++, entity+=strides_between_starts_of_entities)
+            {
+                const char *ptr = entity;
+                for (size_t COMP=0; COMP<NoComponents_; COMP++, ptr+=strides_between_starts_of_components)
                 {
-                    char *ptr = (char*) data+ ENTITY*strides_between_starts_of_entities + COMP*strides_between_starts_of_components;
-                    OUTFILE << *(T*) ptr<< " ";
+                    T value;
+                    std::memcpy(&value, ptr, sizeof(T));
+                    formatter.value(value);
                 }
-            // close data array
-            OUTFILE << "</DataArray>" << std::endl;
-            return true;
+            }
         }
         // Writes ELEMENT data to file ->! Skipps the NumberOfComponents tag
         bool ewrite(std::ofstream& OUTFILE) const
         {   
-            std::string format("ascii");
-            // open data array
-            OUTFILE << "<DataArray ";
-            OUTFILE << "Name=\""                << DataArrayName << "\" ";
-            OUTFILE << "format=\""              << format << "\" ";
-            OUTFILE << "type=\""                << DataType << "\" ";
-            OUTFILE << ">";
-            for (size_t ENTITY=0; ENTITY<NoEntities_; ENTITY++)
-                for (size_t COMP=0; COMP<NoComponents_; COMP++)
-                {
-                    char *ptr = (char*) data+ ENTITY*strides_between_starts_of_entities + COMP*strides_between_starts_of_components;
-                    OUTFILE << *(T*) ptr<< " ";
-                }
-            // close data array
-            OUTFILE << "</DataArray>" << std::endl;
-            return true;
+            VTK_AsciiFormatter formatter;
+            formatter.attach(&OUTFILE);
+            writeAscii(formatter, false);
+            formatter.flush();
+            return OUTFILE.good();
+        }
+};
+
+// storage of VTK_OwnedDataArray, initialized before the VTK_DataArray which points into it
+struct VTK_ArrayStorage
+{
+    std::vector<char> Storage_;
+    // Hands the memory back for reuse, the array must not be used afterwards
+    std::vector<char> releaseStorage() { return std::move(Storage_); }
+};
+
+/*
+VTK_OwnedDataArray(
+                   const VTK_Array& source_,   -> array of type T to copy, e.g. a VTK_DataArray<T> or VTK_GeneratedArray<T, F>
+                   std::vector<char> storage_  -> memory to reuse for the copy (optional)
+                   )
+Packed copy of an array which owns its values, e.g. a snapshot of a field written in the background.
+The memory can be handed back via releaseStorage() and reused for the next copy.
+*/
+template <typename T>
+class VTK_OwnedDataArray : public VTK_ArrayStorage, public VTK_DataArray<T>
+{
+    public:
+        VTK_OwnedDataArray(const VTK_Array& source_, std::vector<char> storage_ = std::vector<char>())
+        : VTK_ArrayStorage{copy(source_, std::move(storage_))},
+          VTK_DataArray<T>(source_.Name(), reinterpret_cast<const T*>(Storage_.data()), {source_.NoEntities(), source_.NoComponents()}, {source_.NoComponents()*sizeof(T), sizeof(T)})
+        {}
+    private:
+        static std::vector<char> copy(const VTK_Array& source_, std::vector<char> storage_)
+        {
+            if (source_.Type() != VTKType(T()) || source_.ValueSize() != sizeof(T)) throw std::runtime_error("Error copying DataArray "+source_.Name()+"! Expected type "+VTKType(T())+", got "+source_.Type());
+            storage_.resize(source_.ByteSize());
+            source_.gather(0, source_.NoEntities(), storage_.data());
+            return storage_;
         }
-};
\ No newline at end of file
+};
+
+/*
+VTK_ConvertedArray<From, To>(
+                             const VTK_Array& source_   -> array of type From, has to outlive the view
+                             )
+View on an array which converts the values to To while writing, e.g. Float64 fields written as Float32
+or the UInt64 connectivity written as UInt32. The values are converted in ranges of ConversionEntities.
+*/
+template <typename From, typename To>
+class VTK_ConvertedArray : public VTK_Array
+{
+    private:
+        const VTK_Array& Source_;
+        static constexpr size_t ConversionEntities = 1 << 12;
+    public:
+        VTK_ConvertedArray(const VTK_Array& source_) : Source_(source_)
+        {
+            if (source_.Type() != VTKType(From()) || source_.ValueSize() != sizeof(From)) throw std::runtime_error("Error converting DataArray "+source_.Name()+"! Expected type "+VTKType(From())+", got "+source_.Type());
+        }
+    public:
+        std::string Name() const {return Source_.Name();}
+        std::string Type() const {return VTKType(To());}
+        size_t NoComponents() const {return Source_.NoComponents();}
+        size_t NoEntities() const {return Source_.NoEntities();}
+        size_t ValueSize() const {return sizeof(To);}
+        void print() const
+        {
+            VTK_AsciiFormatter formatter;
+            formatter.attach(&std::cout);
+            format(formatter, 0, NoEntities());
+            formatter.text("\n");
+            formatter.flush();
+        }
+        void gather(size_t first_entity, size_t no_entities, char* buffer) const
+        {
+            convert(first_entity, no_entities, [&buffer](const To* values, size_t n)
+            {
+                std::memcpy(buffer, values, n*sizeof(To));
+                buffer += n*sizeof(To);
+            });
+        }
+        void format(VTK_AsciiFormatter& formatter, size_t first_entity, size_t no_entities) const
+        {
+            convert(first_entity, no_entities, [&formatter](const To* values, size_t n){ for (size_t i=0; i<n; i++) formatter.value(values[i]); });
+        }
+    private:
+        // calls f(values, n) for the converted values of consecutive ranges of [first_entity, first_entity+no_entities)
+        template <typename F>
+        void convert(size_t first_entity, size_t no_entities, F&& f) const
+        {
+            thread_local std::vector<From> source;
+            thread_local std::vector<To> converted;
+            const size_t m = NoComponents();
+            for (size_t first=first_entity; first<first_entity+no_entities; first+=ConversionEntities)
+            {
+                const size_t n = std::min(ConversionEntities, first_entity+no_entities-first);
+                source.resize(n*m);
+                converted.resize(n*m);
+                Source_.gather(first, n, reinterpret_cast<char*>(source.data()));
+                for (size_t i=0; i<n*m; i++) converted[i] = static_cast<To>(source[i]);
+                f(converted.data(), n*m);
+            }
+        }
+};
+
+// value type of a generator: T if given explicitly, the result of generator(entity, component) otherwise
+template <typename T>
+struct VTK_TypeIdentity { using type = T; };
+template <typename T, typename F>
+using VTK_GeneratedType = typename std::conditional_t<std::is_void_v<T>, std::invoke_result<const F&, size_t, size_t>, VTK_TypeIdentity<T>>::type;
+
+/*
+VTK_GeneratedArray<T, F>(
+                         std::string name_,        -> name of the data array
+                         size_t no_entities_,      -> number of entities e.g. 100 nodes
+                         size_t no_components_,    -> number of components e.g. 3 for a vector
+                         F generator_              -> computes the values, either per value
+                                                         T generator_(size_t entity, size_t component)
+                                                      or per range, filling the packed values of the entities [first_entity, first_entity+no_entities)
+                                                         void generator_(size_t first_entity, size_t no_entities, T* values)
+                         )
+Array whose values are computed while writing, e.g. a velocity magnitude or element volumes without a temporary vector.
+The values are generated in ranges of GenerationEntities (binary output writes them directly into the encoding buffer).
+The writer encodes ranges on several threads at once, the generator must be safe to call concurrently
+and whatever it reads has to outlive the write.
+Usually created by VTK_UnstructuredGrid::addNodeData(name, no_components, generator), e.g.
+    VTKOUT.addNodeData("Magnitude", 1, [&U](size_t node, size_t){ return std::hypot(U[3*node], U[3*node+1], U[3*node+2]); });
+*/
+template <typename T, typename F>
+class VTK_GeneratedArray : public VTK_Array
+{
+    private:
+        std::string Name_;
+        size_t NoEntities_, NoComponents_;
+        F Generator_;
+        static constexpr size_t GenerationEntities = 1 << 12;
+        static constexpr bool FillsRanges = std::is_invocable_v<const F&, size_t, size_t, T*>;
+        static_assert(FillsRanges || std::is_invocable_r_v<T, const F&, size_t, size_t>, "The generator has to be callable as T(size_t entity, size_t component) or void(size_t first_entity, size_t no_entities, T* values)");
+    public:
+        VTK_GeneratedArray(std::string name_, size_t no_entities_, size_t no_components_, F generator_)
+        : Name_(name_), NoEntities_(no_entities_), NoComponents_(no_components_), Generator_(std::move(generator_))
+        {}
+    public:
+        std::string Name() const {return Name_;}
+        std::string Type() const {return VTKType(T());}
+        size_t NoComponents() const {return NoComponents_;}
+        size_t NoEntities() const {return NoEntities_;}
+        size_t ValueSize() const {return sizeof(T);}
+        void print() const
+        {
+            VTK_AsciiFormatter formatter;
+            formatter.attach(&std::cout);
+            format(formatter, 0, NoEntities_);
+            formatter.text("\n");
+            formatter.flush();
+        }
+        void gather(size_t first_entity, size_t no_entities, char* buffer) const
+        {
+            // an aligned buffer is filled in place, otherwise through a range buffer
+            if (reinterpret_cast<std::uintptr_t>(buffer) % alignof(T) == 0)
+            {
+                fill(first_entity, no_entities, reinterpret_cast<T*>(buffer));
+                return;
+            }
+            generate(first_entity, no_entities, [&buffer](const T* values, size_t n)
+            {
+                std::memcpy(buffer, values, n*sizeof(T));
+                buffer += n*sizeof(T);
+            });
+        }
+        void format(VTK_AsciiFormatter& formatter, size_t first_entity, size_t no_entities) const
+        {
+            generate(first_entity, no_entities, [&formatter](const T* values, size_t n){ for (size_t i=0; i<n; i++) formatter.value(values[i]); });
+        }
+    private:
+        // computes the packed values of the entities [first_entity, first_entity+no_entities) into values
+        void fill(size_t first_entity, size_t no_entities, T* values) const
+        {
+            if constexpr (FillsRanges)
+            {
+                Generator_(first_entity, no_entities, values);
+            }
+            else
+            {
+                for (size_t ENTITY=first_entity; ENTITY<first_entity+no_entities; ENTITY++)
+                    for (size_t COMP=0; COMP<NoComponents_; COMP++)
+                        *values++ = static_cast<T>(Generator_(ENTITY, COMP));
+            }
+        }
+        // calls f(values, n) for the generated values of consecutive ranges of [first_entity, first_entity+no_entities)
+        template <typename G>
+        void generate(size_t first_entity, size_t no_entities, G&& f) const
+        {
+            thread_local std::vector<T> values;
+            for (size_t first=first_entity; first<first_entity+no_entities; first+=GenerationEntities)
+            {
+                const size_t n = std::min(GenerationEntities, first_entity+no_entities-first);
+                values.resize(n*NoComponents_);
+                fill(first, n, values.data());
+                f(values.data(), n*NoComponents_);
+            }
+        }
+};
+
+/*
+VTK_IndexedArray(
+                 const VTK_Array& source_,                             -> array which is viewed, has to outlive the view
+                 std::shared_ptr<const std::vector<size_t>> indices_   -> entity i of the view is entity (*indices_)[i] of the source
+                 )
+VTK_IndexedArray(
+                 const VTK_Array& source_,
+                 size_t first_, size_t count_                          -> the view holds the entities [first_, first_+count_) of the source
+                 )
+View on a subset or permutation of the entities of another array, nothing is copied.
+Runs of consecutive indices are gathered at once.
+*/
+class VTK_IndexedArray : public VTK_Array
+{
+    private:
+        const VTK_Array& Source_;
+        std::shared_ptr<const std::vector<size_t>> Indices_;
+        size_t First_, Count_;
+    public:
+        VTK_IndexedArray(const VTK_Array& source_, std::shared_ptr<const std::vector<size_t>> indices_)
+        : Source_(source_), Indices_(indices_), First_(0), Count_(indices_->size())
+        {}
+        VTK_IndexedArray(const VTK_Array& source_, size_t first_, size_t count_)
+        : Source_(source_), Indices_(nullptr), First_(first_), Count_(count_)
+        {}
+    public:
+        std::string Name() const {return Source_.Name();}
+        std::string Type() const {return Source_.Type();}
+        size_t NoComponents() const {return Source_.NoComponents();}
+        size_t NoEntities() const {return Count_;}
+        size_t ValueSize() const {return Source_.ValueSize();}
+        void print() const
+        {
+            VTK_AsciiFormatter formatter;
+            formatter.attach(&std::cout);
+            format(formatter, 0, Count_);
+            formatter.text("\n");
+            formatter.flush();
+        }
+        const char* ContiguousData() const
+        {
+            const char* raw = Indices_ ? nullptr : Source_.ContiguousData();
+            return raw ? raw+First_*NoComponents()*ValueSize() : nullptr;
+        }
+        void gather(size_t first_entity, size_t no_entities, char* buffer) const
+        {
+            const size_t entity_bytes = NoComponents()*ValueSize();
+            forRuns(first_entity, no_entities, [&](size_t source_first, size_t n)
+            {
+                Source_.gather(source_first, n, buffer);
+                buffer += n*entity_bytes;
+            });
+        }
+        void format(VTK_AsciiFormatter& formatter, size_t first_entity, size_t no_entities) const
+        {
+            forRuns(first_entity, no_entities, [&](size_t source_first, size_t n){ Source_.format(formatter, source_first, n); });
+        }
+    private:
+        // calls f(source_first, n) for the runs of consecutive source entities of [first_entity, first_entity+no_entities)
+        template <typename F>
+        void forRuns(size_t first_entity, size_t no_entities, F&& f) const
+        {
+            if (!Indices_)
+            {
+                if (no_entities > 0) f(First_+first_entity, no_entities);
+                return;
+            }
+            const std::vector<size_t>& indices = *Indices_;
+            size_t i = first_entity;
+            const size_t last = first_entity+no_entities;
+            while (i < last)
+            {
+                size_t n = 1;
+                while (i+n < last && indices[i+n] == indices[i]+n) n++;
+                f(indices[i], n);
+                i += n;
+            }
+        }
+};
@@ -0,0 +1,107 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <ostream>
+#include <charconv>
+#include <cstring>
+#include <stdexcept>
+#include <type_traits>
+#include <algorithm>
+
+/*
+VTK_AsciiFormatter(
+                   int precision_,     -> 0: shortest representation which reads back to the identical value (default)
+                                          n: n significant digits for floating point values
+                   size_t capacity_    -> size of the char buffer in bytes
+                   )
+Formats the values of the ascii format via std::to_chars into one large reusable char buffer,
+no locale, no allocation per value. Every value is followed by a single space.
+If a stream is attached, the buffer is flushed to it in large writes whenever it runs full,
+otherwise the buffer grows and keeps the formatted text (used to encode ranges in parallel).
+Example:
+    VTK_AsciiFormatter formatter;
+    formatter.attach(&outfile);
+    formatter.value(0.1); formatter.value(size_t(42));
+    formatter.flush();
+*/
+class VTK_AsciiFormatter
+{
+    public:
+        VTK_AsciiFormatter(int precision_ = 0, size_t capacity_ = 1 << 20)
+        : OUTFILE(nullptr), Precision_(precision_), Size_(0), Buffer_(std::max<size_t>(capacity_, 2*MaxValueChars))
+        {}
+    public:
+        // Attach the stream the buffer is flushed to, nullptr keeps everything in the buffer
+        void attach(std::ostream* OUTFILE_) { flush(); OUTFILE = OUTFILE_; }
+        void setPrecision(int precision_) { Precision_ = precision_; }
+        int Precision() const { return Precision_; }
+
+        template <typename T>
+        void value(const T& v)
+        {
+            reserve(MaxValueChars);
+            char* first = Buffer_.data()+Size_;
+            char* last = Buffer_.data()+Buffer_.size();
+            std::to_chars_result result;
+            if constexpr (std::is_floating_point<T>::value)
+            {
+                if (Precision_ > 0) result = std::to_chars(first, last, v, std::chars_format::general, std::min(Precision_, MaxPrecision));
+                else result = std::to_chars(first, last, v);
+            }
+            else if constexpr (std::is_enum<T>::value) result = std::to_chars(first, last, static_cast<typename std::underlying_type<T>::type>(v));
+            else result = std::to_chars(first, last, v);
+            *result.ptr = ' ';
+            Size_ = result.ptr+1-Buffer_.data();
+        }
+
+        void text(const char* str, size_t n)
+        {
+            if (OUTFILE != nullptr && n >= Buffer_.size())
+            {
+                flush();
+                OUTFILE->write(str, n);
+                return;
+            }
+            reserve(n);
+            std::memcpy(Buffer_.data()+Size_, str, n);
+            Size_ += n;
+        }
+        void text(const std::string& str) { text(str.data(), str.size()); }
+
+        // Writes the buffer to the attached stream
+        void flush()
+        {
+            if (OUTFILE == nullptr || Size_ == 0) return;
+            OUTFILE->write(Buffer_.data(), Size_);
+            Size_ = 0;
+        }
+
+        // Access to the formatted text if no stream is attached
+        const char* data() const { return Buffer_.data(); }
+        size_t size() const { return Size_; }
+        void clear() { Size_ = 0; }
+        // Moves the formatted text into out, the formatter continues empty
+        void release(std::vector<char>& out)
+        {
+            Buffer_.resize(Size_);
+            out.swap(Buffer_);
+            Size_ = 0;
+            Buffer_.resize(std::max(Buffer_.capacity(), 2*MaxValueChars));
+        }
+    private:
+        void reserve(size_t n)
+        {
+            if (Size_+n <= Buffer_.size()) return;
+            if (OUTFILE != nullptr) flush();
+            if (Size_+n > Buffer_.size()) Buffer_.resize(std::max(2*Buffer_.size(), Size_+n));
+        }
+    private:
+        // longest formatted value: 17 significant digits, sign, point, exponent (or 20 digits of an integer) and the space
+        static constexpr size_t MaxValueChars = 64;
+        static constexpr int MaxPrecision = 40;
+        std::ostream* OUTFILE;
+        int Precision_;
+        size_t Size_;
+        std::vector<char> Buffer_;
+};
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <array>
+
+// Number of characters of the base64 encoding of n bytes (including padding)
+inline size_t VTK_Base64Length(size_t n) { return 4*((n+2)/3); }
+
+// Encodes n bytes into VTK_Base64Length(n) characters at out, the last group is padded
+inline size_t VTK_Base64Encode(const char* bytes, size_t n, char* out)
+{
+    static const char* table = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    const unsigned char* in = reinterpret_cast<const unsigned char*>(bytes);
+    char* start = out;
+    for (; n >= 3; n-=3, in+=3, out+=4)
+    {
+        const uint32_t v = (uint32_t(in[0]) << 16) | (uint32_t(in[1]) << 8) | uint32_t(in[2]);
+        out[0] = table[(v >> 18) & 0x3f];
+        out[1] = table[(v >> 12) & 0x3f];
+        out[2] = table[(v >> 6) & 0x3f];
+        out[3] = table[v & 0x3f];
+    }
+    if (n > 0)
+    {
+        const unsigned char b0 = in[0], b1 = n > 1 ? in[1] : 0;
+        out[0] = table[b0 >> 2];
+        out[1] = table[((b0 & 0x03) << 4) | (b1 >> 4)];
+        out[2] = n > 1 ? table[(b1 & 0x0f) << 2] : '=';
+        out[3] = '=';
+        out += 4;
+    }
+    return out-start;
+}
+
+// Number of bytes encoded by n base64 characters, n is a multiple of 4 and the last group may be padded
+inline size_t VTK_Base64DecodedLength(const char* chars, size_t n)
+{
+    if (n < 4) return 0;
+    return 3*(n/4)-(chars[n-1] == '=' ? 1 : 0)-(chars[n-2] == '=' ? 1 : 0);
+}
+
+// Decodes n characters (a multiple of 4) into VTK_Base64DecodedLength(chars, n) bytes at out, returns false on invalid characters
+inline bool VTK_Base64Decode(const char* chars, size_t n, char* bytes)
+{
+    static const std::array<int8_t, 256> table = []()
+    {
+        std::array<int8_t, 256> values;
+        values.fill(-1);
+        const char* alphabet = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+        for (int i=0; i<64; i++) values[static_cast<unsigned char>(alphabet[i])] = static_cast<int8_t>(i);
+        values['='] = 0;
+        return values;
+    }();
+    const unsigned char* in = reinterpret_cast<const unsigned char*>(chars);
+    unsigned char* out = reinterpret_cast<unsigned char*>(bytes);
+    const size_t length = VTK_Base64DecodedLength(chars, n);
+    for (size_t group=0; group<n/4; group++, in+=4)
+    {
+        const int8_t a = table[in[0]], b = table[in[1]], c = table[in[2]], d = table[in[3]];
+        if ((a | b | c | d) < 0) return false;
+        const uint32_t v = (uint32_t(a) << 18) | (uint32_t(b) << 12) | (uint32_t(c) << 6) | uint32_t(d);
+        // the padded last group writes only its encoded bytes
+        const size_t first = 3*group;
+        if (first < length) out[first] = static_cast<unsigned char>(v >> 16);
+        if (first+1 < length) out[first+1] = static_cast<unsigned char>(v >> 8);
+        if (first+2 < length) out[first+2] = static_cast<unsigned char>(v);
+    }
+    return true;
+}
@@ -0,0 +1,296 @@
+#pragma once
+
+#include <string>
+#include <iostream>
+#include <vector>
+#include <cstring>
+#include <cstdint>
+#include <algorithm>
+#include <stdexcept>
+
+#include "vtk_definitions.hpp"
+#include "vtk_array.hpp"
+
+/*
+VTK_CellBlock{
+              VTK_CELLTYPE type,   -> type of all cells of the block
+              size_t no_cells,     -> number of consecutive cells
+              size_t no_nodes      -> nodes per cell, 0 takes VTK_CELL_NODES(type) (required for polygons and polyhedra)
+              }
+Consecutive cells of one type and node count, e.g. {{VTK_TETRA, 1000}, {VTK_PYRAMID, 200}, {VTK_HEXAHEDRON, 5000}}.
+*/
+struct VTK_CellBlock
+{
+    VTK_CELLTYPE type;
+    size_t no_cells;
+    size_t no_nodes = 0;
+};
+
+inline size_t VTK_BlockNodes(const VTK_CellBlock& block) { return block.no_nodes > 0 ? block.no_nodes : VTK_CELL_NODES(block.type); }
+
+// Run-length encoding of the cells: the blocks with their first cell and first connectivity entry
+class VTK_CellBlocks
+{
+    private:
+        std::vector<VTK_CellBlock> Blocks_;
+        std::vector<size_t> FirstCell_, FirstOffset_; // one more entry than blocks
+    public:
+        VTK_CellBlocks(const std::vector<VTK_CellBlock>& blocks = std::vector<VTK_CellBlock>())
+        : FirstCell_(1, 0), FirstOffset_(1, 0)
+        {
+            for (auto &block : blocks)
+            {
+                if (block.no_cells == 0) continue;
+                Blocks_.push_back(block);
+                FirstCell_.push_back(FirstCell_.back()+block.no_cells);
+                FirstOffset_.push_back(FirstOffset_.back()+block.no_cells*VTK_BlockNodes(block));
+            }
+        }
+    public:
+        const std::vector<VTK_CellBlock>& Blocks() const {return Blocks_;}
+        size_t NoCells() const {return FirstCell_.back();}
+        // length of the connectivity
+        size_t NoNodes() const {return FirstOffset_.back();}
+        // block of a cell
+        size_t block(size_t cell) const {return std::upper_bound(FirstCell_.begin(), FirstCell_.end(), cell)-FirstCell_.begin()-1;}
+        // end of the nodes of a cell in the connectivity
+        size_t offset(size_t cell) const
+        {
+            const size_t b = block(cell);
+            return FirstOffset_[b]+(cell-FirstCell_[b]+1)*VTK_BlockNodes(Blocks_[b]);
+        }
+        // calls f(block, first_cell, n) for the parts of [first_cell, first_cell+no_cells) in the blocks
+        template <typename F>
+        void forBlocks(size_t first_cell, size_t no_cells, F&& f) const
+        {
+            if (no_cells == 0) return;
+            const size_t last = first_cell+no_cells;
+            for (size_t b=block(first_cell); first_cell<last; b++)
+            {
+                const size_t n = std::min(last, FirstCell_[b+1])-first_cell;
+                f(b, first_cell, n);
+                first_cell += n;
+            }
+        }
+        size_t FirstOffset(size_t b) const {return FirstOffset_[b];}
+        size_t FirstCell(size_t b) const {return FirstCell_[b];}
+};
+
+/*
+Blocks of the cells given in CSR format, i.e. the nodes of cell i are connectivity[offsets[i]..offsets[i+1]).
+Returns no blocks if the cells form more than max_blocks runs of equal type and node count.
+*/
+inline std::vector<VTK_CellBlock> VTK_DetectCellBlocks(const size_t* offsets, const VTK_CELLTYPE* types, size_t no_cells, size_t max_blocks)
+{
+    std::vector<VTK_CellBlock> blocks;
+    for (size_t i=0; i<no_cells; i++)
+    {
+        const size_t no_nodes = offsets[i+1]-offsets[i];
+        if (!blocks.empty() && blocks.back().type == types[i] && blocks.back().no_nodes == no_nodes)
+        {
+            blocks.back().no_cells++;
+            continue;
+        }
+        if (blocks.size() == max_blocks) return std::vector<VTK_CellBlock>();
+        blocks.push_back({types[i], 1, no_nodes});
+    }
+    return blocks;
+}
+
+/*
+Arrays of the <Cells> section besides the connectivity.
+The values are generated from the blocks while writing, or converted from the offsets and types given by the caller.
+offsets -> end of every cell in the connectivity, Int32 while the last offset fits, Int64 otherwise
+types   -> the VTK_CELLTYPE of every cell
+*/
+class VTK_CellOffsetArray : public VTK_Array
+{
+    private:
+        VTK_CellBlocks Blocks_;
+        const size_t* Offsets_; // CSR offsets (no_cells+1 entries) or nullptr
+        size_t NoCells_;
+        bool Int64_;
+    public:
+        VTK_CellOffsetArray(size_t no_cells, unsigned int no_nodes) : VTK_CellOffsetArray(std::vector<VTK_CellBlock>{{VTK_EMPTY_CELL, no_cells, no_nodes}}) {}
+        VTK_CellOffsetArray(const std::vector<VTK_CellBlock>& blocks)
+        : Blocks_(blocks), Offsets_(nullptr), NoCells_(Blocks_.NoCells()), Int64_(Blocks_.NoNodes() > INT32_MAX) {}
+        VTK_CellOffsetArray(const size_t* offsets, size_t no_cells)
+        : Offsets_(offsets), NoCells_(no_cells), Int64_(offsets[no_cells] > INT32_MAX) {}
+    public:
+        std::string Name() const {return "offsets";}
+        std::string Type() const {return Int64_ ? "Int64" : "Int32";}
+        size_t NoComponents() const {return 1;}
+        size_t NoEntities() const {return NoCells_;}
+        size_t ValueSize() const {return Int64_ ? sizeof(int64_t) : sizeof(int32_t);}
+        // end of the nodes of a cell in the connectivity
+        size_t offset(size_t cell) const {return Offsets_ ? Offsets_[cell+1] : Blocks_.offset(cell);}
+        void print() const
+        {
+            for (size_t i=0; i<NoCells_; i++) std::cout << offset(i) << " ";
+            std::cout << std::endl;
+        }
+        void format(VTK_AsciiFormatter& formatter, size_t first_entity, size_t no_entities) const
+        {
+            forOffsets(first_entity, no_entities, [&formatter](size_t value){ formatter.value(value); });
+        }
+        void gather(size_t first_entity, size_t no_entities, char* buffer) const
+        {
+            if (Int64_) fill<int64_t>(first_entity, no_entities, buffer);
+            else fill<int32_t>(first_entity, no_entities, buffer);
+        }
+    private:
+        template <typename T>
+        void fill(size_t first_entity, size_t no_entities, char* buffer) const
+        {
+            forOffsets(first_entity, no_entities, [&buffer](size_t offset)
+            {
+                const T value = static_cast<T>(offset);
+                std::memcpy(buffer, &value, sizeof(T));
+                buffer += sizeof(T);
+            });
+        }
+        // calls f(offset) for the cells [first_entity, first_entity+no_entities)
+        template <typename F>
+        void forOffsets(size_t first_entity, size_t no_entities, F&& f) const
+        {
+            if (Offsets_)
+            {
+                for (size_t i=first_entity; i<first_entity+no_entities; i++) f(Offsets_[i+1]);
+                return;
+            }
+            Blocks_.forBlocks(first_entity, no_entities, [&](size_t b, size_t first, size_t n)
+            {
+                const size_t no_nodes = VTK_BlockNodes(Blocks_.Blocks()[b]);
+                size_t value = Blocks_.FirstOffset(b)+(first-Blocks_.FirstCell(b))*no_nodes;
+                for (size_t i=0; i<n; i++) f(value += no_nodes);
+            });
+        }
+};
+
+class VTK_CellTypeArray : public VTK_Array
+{
+    private:
+        VTK_CellBlocks Blocks_;
+        const VTK_CELLTYPE* Types_; // one type per cell or nullptr
+        size_t NoCells_;
+    public:
+        VTK_CellTypeArray(size_t no_cells, VTK_CELLTYPE cell_type) : VTK_CellTypeArray(std::vector<VTK_CellBlock>{{cell_type, no_cells}}) {}
+        VTK_CellTypeArray(const std::vector<VTK_CellBlock>& blocks) : Blocks_(blocks), Types_(nullptr), NoCells_(Blocks_.NoCells()) {}
+        VTK_CellTypeArray(const VTK_CELLTYPE* types, size_t no_cells) : Types_(types), NoCells_(no_cells) {}
+    public:
+        std::string Name() const {return "types";}
+        std::string Type() const {return "UInt8";}
+        size_t NoComponents() const {return 1;}
+        size_t NoEntities() const {return NoCells_;}
+        size_t ValueSize() const {return sizeof(uint8_t);}
+        VTK_CELLTYPE type(size_t cell) const {return Types_ ? Types_[cell] : Blocks_.Blocks()[Blocks_.block(cell)].type;}
+        // true if the types are run-length encoded, see blocks(...)
+        bool Blocked() const {return Types_ == nullptr;}
+        // the blocks of the cells [first_cell, first_cell+no_cells)
+        std::vector<VTK_CellBlock> blocks(size_t first_cell, size_t no_cells) const
+        {
+            std::vector<VTK_CellBlock> blocks;
+            Blocks_.forBlocks(first_cell, no_cells, [&](size_t b, size_t, size_t n)
+            {
+                blocks.push_back(Blocks_.Blocks()[b]);
+                blocks.back().no_cells = n;
+            });
+            return blocks;
+        }
+        void print() const
+        {
+            for (size_t i=0; i<NoCells_; i++) std::cout << type(i) << " ";
+            std::cout << std::endl;
+        }
+        void format(VTK_AsciiFormatter& formatter, size_t first_entity, size_t no_entities) const
+        {
+            if (Types_)
+            {
+                for (size_t i=first_entity; i<first_entity+no_entities; i++) formatter.value(static_cast<int>(Types_[i]));
+                return;
+            }
+            Blocks_.forBlocks(first_entity, no_entities, [&](size_t b, size_t, size_t n)
+            {
+                for (size_t i=0; i<n; i++) formatter.value(static_cast<int>(Blocks_.Blocks()[b].type));
+            });
+        }
+        void gather(size_t first_entity, size_t no_entities, char* buffer) const
+        {
+            if (Types_)
+            {
+                for (size_t i=0; i<no_entities; i++) buffer[i] = static_cast<char>(Types_[first_entity+i]);
+                return;
+            }
+            // one memset per run
+            Blocks_.forBlocks(first_entity, no_entities, [&](size_t b, size_t, size_t n)
+            {
+                std::memset(buffer, static_cast<uint8_t>(Blocks_.Blocks()[b].type), n);
+                buffer += n;
+            });
+        }
+};
+
+/*
+faceoffsets of the <Cells> section: end of the faces of every VTK_POLYHEDRON in the faces array, -1 for all other cells.
+Generated from the CSR offsets of the faces (no_cells+1 entries), empty ranges mark cells without faces.
+*/
+class VTK_FaceOffsetArray : public VTK_Array
+{
+    private:
+        const size_t* FaceOffsets_;
+        size_t NoCells_;
+    public:
+        VTK_FaceOffsetArray(const size_t* faceoffsets, size_t no_cells) : FaceOffsets_(faceoffsets), NoCells_(no_cells) {}
+    public:
+        std::string Name() const {return "faceoffsets";}
+        std::string Type() const {return "Int64";}
+        size_t NoComponents() const {return 1;}
+        size_t NoEntities() const {return NoCells_;}
+        size_t ValueSize() const {return sizeof(int64_t);}
+        int64_t offset(size_t cell) const {return FaceOffsets_[cell+1] > FaceOffsets_[cell] ? static_cast<int64_t>(FaceOffsets_[cell+1]) : -1;}
+        void print() const
+        {
+            for (size_t i=0; i<NoCells_; i++) std::cout << offset(i) << " ";
+            std::cout << std::endl;
+        }
+        void format(VTK_AsciiFormatter& formatter, size_t first_entity, size_t no_entities) const
+        {
+            for (size_t i=first_entity; i<first_entity+no_entities; i++) formatter.value(offset(i));
+        }
+        void gather(size_t first_entity, size_t no_entities, char* buffer) const
+        {
+            for (size_t i=first_entity; i<first_entity+no_entities; i++, buffer+=sizeof(int64_t))
+            {
+                const int64_t value = offset(i);
+                std::memcpy(buffer, &value, sizeof(int64_t));
+            }
+        }
+};
+
+/*
+Faces of the 3D cell types in VTK node order, the normals point outwards. Empty for all other cell types.
+The faces of the quadratic cells alternate corner and midside nodes, e.g. {0, 4, 1, 8, 3, 7} of a VTK_QUADRATIC_TETRA.
+*/
+inline const std::vector<std::vector<unsigned int>>& VTK_CELL_FACES(VTK_CELLTYPE type)
+{
+    static const std::vector<std::vector<unsigned int>> none;
+    static const std::vector<std::vector<unsigned int>> tetra = {{0,1,3}, {1,2,3}, {2,0,3}, {0,2,1}};
+    static const std::vector<std::vector<unsigned int>> voxel = {{0,4,6,2}, {1,3,7,5}, {0,1,5,4}, {2,6,7,3}, {0,2,3,1}, {4,5,7,6}};
+    static const std::vector<std::vector<unsigned int>> hexahedron = {{0,4,7,3}, {1,2,6,5}, {0,1,5,4}, {3,7,6,2}, {0,3,2,1}, {4,5,6,7}};
+    static const std::vector<std::vector<unsigned int>> wedge = {{0,1,2}, {3,5,4}, {0,3,4,1}, {1,4,5,2}, {2,5,3,0}};
+    static const std::vector<std::vector<unsigned int>> pyramid = {{0,3,2,1}, {0,1,4}, {1,2,4}, {2,3,4}, {3,0,4}};
+    static const std::vector<std::vector<unsigned int>> quadratic_tetra = {{0,4,1,8,3,7}, {1,5,2,9,3,8}, {2,6,0,7,3,9}, {0,6,2,5,1,4}};
+    static const std::vector<std::vector<unsigned int>> quadratic_hexahedron = {{0,16,4,15,7,19,3,11}, {1,9,2,18,6,13,5,17}, {0,8,1,17,5,12,4,16},
+                                                                               {3,19,7,14,6,18,2,10}, {0,11,3,10,2,9,1,8}, {4,12,5,13,6,14,7,15}};
+    switch (type)
+    {
+    case VTK_TETRA:                 return tetra;
+    case VTK_VOXEL:                 return voxel;
+    case VTK_HEXAHEDRON:            return hexahedron;
+    case VTK_WEDGE:                 return wedge;
+    case VTK_PYRAMID:               return pyramid;
+    case VTK_QUADRATIC_TETRA:       return quadratic_tetra;
+    case VTK_QUADRATIC_HEXAHEDRON:  return quadratic_hexahedron;
+    default: return none;
+    }
+}
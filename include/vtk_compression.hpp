@@ -0,0 +1,182 @@
+#pragma once
+
+#include <vector>
+#include <string>
+#include <cstring>
+#include <cstdint>
+#include <stdexcept>
+#include <algorithm>
+#include <chrono>
+
+#ifdef VTK_WITH_ZLIB
+#include <zlib.h>
+#endif
+#ifdef VTK_WITH_LZ4
+#include <lz4.h>
+#include <lz4hc.h>
+#endif
+
+#include "vtk_definitions.hpp"
+#include "vtk_array.hpp"
+#include "vtk_threadpool.hpp"
+
+// Uncompressed size of the compression blocks, rounded down to whole entities of an array
+constexpr size_t VTK_COMPRESSION_BLOCK_BYTES = 1 << 16;
+
+// Compresses n bytes of src into dst (dst is resized to the compressed size)
+inline void VTK_CompressBlock(VTK_COMPRESSOR compressor, [[maybe_unused]] int level, [[maybe_unused]] const char* src, [[maybe_unused]] size_t n, [[maybe_unused]] std::vector<char>& dst)
+{
+    switch (compressor)
+    {
+#ifdef VTK_WITH_ZLIB
+    case VTK_ZLIB:
+    {
+        uLongf size = compressBound(static_cast<uLong>(n));
+        dst.resize(size);
+        if (compress2(reinterpret_cast<Bytef*>(dst.data()), &size, reinterpret_cast<const Bytef*>(src), static_cast<uLong>(n), level) != Z_OK)
+            throw std::runtime_error("Error compressing DataArray! zlib failed.");
+        dst.resize(size);
+        return;
+    }
+#endif
+#ifdef VTK_WITH_LZ4
+    case VTK_LZ4:
+    {
+        // levels up to 1 are the fast default, higher levels compress harder with LZ4HC (up to LZ4HC_CLEVEL_MAX)
+        dst.resize(LZ4_compressBound(static_cast<int>(n)));
+        const int size = (level > 1) ? LZ4_compress_HC(src, dst.data(), static_cast<int>(n), static_cast<int>(dst.size()), std::min(level, LZ4HC_CLEVEL_MAX))
+                                     : LZ4_compress_default(src, dst.data(), static_cast<int>(n), static_cast<int>(dst.size()));
+        if (size <= 0) throw std::runtime_error("Error compressing DataArray! lz4 failed.");
+        dst.resize(size);
+        return;
+    }
+#endif
+    default:
+        throw std::runtime_error("Error compressing DataArray! Compressor "+VTKCompressorName(compressor)+" is not available in this build.");
+    }
+}
+
+// Decompresses the n bytes of the block src into the raw_size bytes at dst, failures throw
+inline void VTK_DecompressBlock(VTK_COMPRESSOR compressor, [[maybe_unused]] const char* src, [[maybe_unused]] size_t n, [[maybe_unused]] char* dst, [[maybe_unused]] size_t raw_size)
+{
+    switch (compressor)
+    {
+#ifdef VTK_WITH_ZLIB
+    case VTK_ZLIB:
+    {
+        uLongf size = static_cast<uLongf>(raw_size);
+        if (uncompress(reinterpret_cast<Bytef*>(dst), &size, reinterpret_cast<const Bytef*>(src), static_cast<uLong>(n)) != Z_OK || size != raw_size)
+            throw std::runtime_error("Error decompressing DataArray! zlib failed.");
+        return;
+    }
+#endif
+#ifdef VTK_WITH_LZ4
+    case VTK_LZ4:
+    {
+        const int size = LZ4_decompress_safe(src, dst, static_cast<int>(n), static_cast<int>(raw_size));
+        if (size < 0 || static_cast<size_t>(size) != raw_size) throw std::runtime_error("Error decompressing DataArray! lz4 failed.");
+        return;
+    }
+#endif
+    default:
+        throw std::runtime_error("Error decompressing DataArray! Compressor "+VTKCompressorName(compressor)+" is not available in this build.");
+    }
+}
+
+/*
+Multi-block compressed representation of one VTK_Array, as expected by the VTK readers:
+header -> [number of blocks, uncompressed block size, uncompressed size of last block, compressed size of block 1, ..., of block n]
+          every entry is UInt32 or UInt64 (header_type)
+blocks -> the compressed blocks in order
+*/
+struct VTK_CompressedArray
+{
+    std::vector<char> header;
+    std::vector<std::vector<char>> blocks;
+
+    size_t ByteSize() const
+    {
+        size_t size = header.size();
+        for (auto &block : blocks) size += block.size();
+        return size;
+    }
+};
+
+/*
+Splits every array into blocks of VTK_COMPRESSION_BLOCK_BYTES and compresses all blocks of all arrays
+as independent tasks on the pool (or sequentially if pool is nullptr).
+Continuous arrays are compressed straight from the source buffer, strided arrays are gathered per block.
+If seconds is not nullptr, it receives the time spent per array, summed over all threads.
+The blocks of all arrays are returned at once, their sizes are needed for the headers and offsets in front of the data.
+*/
+inline std::vector<VTK_CompressedArray> VTK_CompressArrays(const std::vector<const VTK_Array*>& arrays, VTK_COMPRESSOR compressor, int level, bool uint64_header, VTK_ThreadPool* pool,
+                                                           std::vector<double>* seconds = nullptr)
+{
+    std::vector<VTK_CompressedArray> compressed(arrays.size());
+    std::vector<size_t> block_entities(arrays.size());
+    std::vector<std::pair<size_t, size_t>> tasks; // (array, block)
+    for (size_t a=0; a<arrays.size(); a++)
+    {
+        const size_t entity_bytes = arrays[a]->NoComponents()*arrays[a]->ValueSize();
+        const size_t entities = arrays[a]->NoEntities();
+        block_entities[a] = std::max<size_t>(1, VTK_COMPRESSION_BLOCK_BYTES/std::max<size_t>(1, entity_bytes));
+        const size_t no_blocks = (entity_bytes == 0) ? 0 : (entities+block_entities[a]-1)/block_entities[a];
+        compressed[a].blocks.resize(no_blocks);
+        for (size_t b=0; b<no_blocks; b++) tasks.push_back({a, b});
+    }
+
+    auto compress = [&](size_t t)
+    {
+        const VTK_Array& data = *arrays[tasks[t].first];
+        const size_t block = tasks[t].second;
+        const size_t entity_bytes = data.NoComponents()*data.ValueSize();
+        const size_t first = block*block_entities[tasks[t].first];
+        const size_t n = std::min(block_entities[tasks[t].first], data.NoEntities()-first);
+        std::vector<char>& dst = compressed[tasks[t].first].blocks[block];
+        if (const char* raw = data.ContiguousData())
+        {
+            VTK_CompressBlock(compressor, level, raw+first*entity_bytes, n*entity_bytes, dst);
+            return;
+        }
+        thread_local std::vector<char> buffer;
+        buffer.resize(n*entity_bytes);
+        data.gather(first, n, buffer.data());
+        VTK_CompressBlock(compressor, level, buffer.data(), n*entity_bytes, dst);
+    };
+    if (seconds == nullptr) VTK_ParallelFor(pool, tasks.size(), compress);
+    else
+    {
+        std::vector<double> task_seconds(tasks.size());
+        VTK_ParallelFor(pool, tasks.size(), [&](size_t t)
+        {
+            const auto start = std::chrono::steady_clock::now();
+            compress(t);
+            task_seconds[t] = std::chrono::duration<double>(std::chrono::steady_clock::now()-start).count();
+        });
+        seconds->assign(arrays.size(), 0.0);
+        for (size_t t=0; t<tasks.size(); t++) (*seconds)[tasks[t].first] += task_seconds[t];
+    }
+
+    // assemble the headers
+    for (size_t a=0; a<arrays.size(); a++)
+    {
+        const size_t entity_bytes = arrays[a]->NoComponents()*arrays[a]->ValueSize();
+        const size_t total = arrays[a]->ByteSize();
+        const size_t no_blocks = compressed[a].blocks.size();
+        const size_t block_size = block_entities[a]*entity_bytes;
+        std::vector<uint64_t> values = {no_blocks, block_size, no_blocks > 0 ? total-(no_blocks-1)*block_size : 0};
+        for (auto &block : compressed[a].blocks) values.push_back(block.size());
+        if (uint64_header)
+        {
+            compressed[a].header.resize(values.size()*sizeof(uint64_t));
+            std::memcpy(compressed[a].header.data(), values.data(), compressed[a].header.size());
+        }
+        else
+        {
+            std::vector<uint32_t> values32(values.begin(), values.end());
+            compressed[a].header.resize(values32.size()*sizeof(uint32_t));
+            std::memcpy(compressed[a].header.data(), values32.data(), compressed[a].header.size());
+        }
+    }
+    return compressed;
+}
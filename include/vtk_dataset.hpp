@@ -0,0 +1,473 @@
+#pragma once
+
+#include <memory>
+#include <functional>
+#include <chrono>
+#include <cmath>
+
+#include <vtk_array.hpp>
+#include <vtk_compression.hpp>
+#include <vtk_pieces.hpp>
+#include <vtk_quantization.hpp>
+#include <vtk_threadpool.hpp>
+#include <vtk_statistics.hpp>
+#include <vtk_sink.hpp>
+
+/*
+Points and Cells of a grid encoded into memory for one VTK_WriteSettings.
+Reused by VTK_TimeSeries for every step while the mesh does not change.
+One entry per geometry array: Coordinates, connectivity, offsets, types and for polyhedra faces and faceoffsets.
+bytes -> ascii, binary: the complete DataArray elements; appended: the blocks of the <AppendedData> section
+tags  -> appended: the DataArray tags without offset
+arrays -> name, type and size of the arrays for VTK_WriteStatistics
+*/
+struct VTK_EncodedGeometry
+{
+    VTK_WriteSettings settings;
+    bool uint64_header;
+    size_t NoPoints, NoCells;
+    std::vector<std::string> tags;
+    std::vector<std::vector<char>> bytes;
+    std::vector<VTK_ArrayStatistics> arrays;
+};
+
+// Name, type and size of an array, the remaining statistics are collected while writing
+inline VTK_ArrayStatistics VTK_DescribeArray(const VTK_Array& data)
+{
+    VTK_ArrayStatistics statistics;
+    statistics.name = data.Name();
+    statistics.type = data.Type();
+    statistics.entities = data.NoEntities();
+    statistics.components = data.NoComponents();
+    statistics.raw_bytes = data.ByteSize();
+    return statistics;
+}
+
+// Type of a field as VTK_WriteDataSet(...) writes it with settings
+inline std::string VTK_WrittenType(const VTK_Array& data, const VTK_WriteSettings& settings)
+{
+    const auto bound = settings.error_bounds.find(data.Name());
+    if (bound != settings.error_bounds.end() && bound->second.mode != VTK_LOSSLESS && bound->second.storage == VTK_QUANTIZED_INTEGERS) return "UInt32";
+    return (settings.float32_fields && data.Type() == "Float64") ? "Float32" : data.Type();
+}
+
+/*
+VTK_DataSetSection{
+                   std::string name,     -> element of the geometry arrays, e.g. "Points", "Cells", "Coordinates"
+                   size_t no_arrays,     -> number of geometry arrays in the element
+                   bool with_components  -> write NumberOfComponents for the arrays of the element
+                   }
+*/
+struct VTK_DataSetSection
+{
+    std::string name;
+    size_t no_arrays;
+    bool with_components;
+};
+
+/*
+VTK_DataSetLayout{
+                  std::string type,          -> dataset type, e.g. "UnstructuredGrid", "ImageData", "RectilinearGrid"
+                  std::string attributes,    -> attributes of the dataset element, e.g. "WholeExtent=\"0 9 0 9 0 9\" Origin=..."
+                  std::string piece,         -> attributes of the <Piece> element, e.g. "NumberOfCells=\"10\" NumberOfPoints=\"20\""
+                  std::vector<VTK_DataSetSection> sections -> the geometry elements in the order of the geometry arrays
+                  }
+*/
+struct VTK_DataSetLayout
+{
+    std::string type;
+    std::string attributes;
+    std::string piece;
+    std::vector<VTK_DataSetSection> sections;
+};
+
+/*
+Writes a dataset to sink, failures of the sink throw.
+layout          -> dataset type, attributes and the sections of the geometry arrays
+geometry_arrays -> the arrays of the sections one after another, encoded during the write
+geometry        -> the same arrays encoded before, used instead of geometry_arrays if not nullptr
+node_data       -> arrays of the <PointData> section
+cell_data       -> arrays of the <CellData> section
+statistics      -> filled with the statistics of the file if not nullptr
+*/
+inline bool VTK_WriteDataSet(VTK_Sink& sink, const VTK_WriteSettings& settings, const VTK_DataSetLayout& layout,
+                             const std::vector<const VTK_Array*>& geometry_arrays, const VTK_EncodedGeometry* geometry,
+                             const std::vector<const VTK_Array*>& node_data, const std::vector<const VTK_Array*>& cell_data,
+                             VTK_ThreadPool* pool, VTK_WriteStatistics* statistics = nullptr)
+{
+    const auto start = std::chrono::steady_clock::now();
+    // fields with an error bound are rounded or quantized, Float64 fields are converted on the fly if requested
+    std::vector<std::unique_ptr<VTK_Array>> converted;
+    auto fields = [&](const std::vector<const VTK_Array*>& data)
+    {
+        std::vector<const VTK_Array*> written(data);
+        for (auto &field : written)
+        {
+            const auto bound = settings.error_bounds.find(field->Name());
+            if (bound != settings.error_bounds.end() && bound->second.mode != VTK_LOSSLESS)
+            {
+                converted.push_back(VTK_ErrorBoundedArray(*field, bound->second, pool));
+                field = converted.back().get();
+            }
+            if (settings.float32_fields && field->Type() == "Float64")
+            {
+                converted.emplace_back(new VTK_ConvertedArray<double, float>(*field));
+                field = converted.back().get();
+            }
+        }
+        return written;
+    };
+    const std::vector<const VTK_Array*> node_fields = fields(node_data);
+    const std::vector<const VTK_Array*> cell_fields = fields(cell_data);
+
+    // all arrays which are encoded during the write in the order they appear in the file
+    std::vector<const VTK_Array*> arrays;
+    if (geometry == nullptr) arrays.insert(arrays.end(), geometry_arrays.begin(), geometry_arrays.end());
+    arrays.insert(arrays.end(), node_fields.begin(), node_fields.end());
+    arrays.insert(arrays.end(), cell_fields.begin(), cell_fields.end());
+
+    const bool binary = (settings.format != VTK_ASCII);
+    const bool compressed = binary && (settings.compressor != VTK_NO_COMPRESSION);
+    // the byte count headers switch to UInt64 as soon as one array exceeds 4GB
+    bool uint64_header = false;
+    for (auto &data : arrays) uint64_header |= data->ByteSize() > UINT32_MAX;
+    if (geometry != nullptr)
+    {
+        if (geometry->settings != settings || (uint64_header && !geometry->uint64_header)) throw std::runtime_error("Error writing "+sink.Name()+"! The encoded geometry does not match the settings.");
+        uint64_header = geometry->uint64_header;
+    }
+    // statistics: the geometry arrays come first, the encoded arrays follow
+    const size_t first_encoded = (geometry != nullptr) ? geometry->bytes.size() : 0;
+    const size_t no_geometry = (geometry != nullptr) ? geometry->bytes.size() : geometry_arrays.size();
+    size_t no_section_arrays = 0;
+    for (auto &section : layout.sections) no_section_arrays += section.no_arrays;
+    if (no_section_arrays != no_geometry) throw std::runtime_error("Error writing "+sink.Name()+"! The layout demands "+std::to_string(no_section_arrays)+" geometry arrays, got "+std::to_string(no_geometry));
+    if (statistics != nullptr)
+    {
+        *statistics = VTK_WriteStatistics();
+        statistics->file = sink.Name();
+        statistics->settings = settings;
+        statistics->threads = (pool != nullptr) ? pool->NoThreads() : 1;
+        if (geometry != nullptr) statistics->arrays.assign(geometry->arrays.begin(), geometry->arrays.end());
+        for (auto &data : arrays) statistics->arrays.push_back(VTK_DescribeArray(*data));
+        for (auto &array : statistics->arrays) statistics->raw_bytes += array.raw_bytes;
+    }
+
+    // compressed arrays have to be encoded before the offsets are known, their blocks are held until the file is written
+    std::vector<VTK_CompressedArray> compressed_arrays;
+    std::vector<double> compress_seconds;
+    if (compressed) compressed_arrays = VTK_CompressArrays(arrays, settings.compressor, settings.compression_level, uint64_header, pool, statistics ? &compress_seconds : nullptr);
+
+    // the file is assembled as ordered pieces, which are encoded on the pool
+    VTK_PieceList pieces;
+    size_t index = 0, offset = 0;
+    auto dataarray = [&](const VTK_Array& data, bool with_components)
+    {
+        const size_t i = index++;
+        const VTK_CompressedArray* compressed_data = compressed ? &compressed_arrays[i] : nullptr;
+        pieces.setArray(static_cast<int>(first_encoded+i));
+        if (settings.format == VTK_ASCII) VTK_AddAsciiArray(pieces, data, with_components, settings.precision);
+        else if (settings.format == VTK_BINARY) VTK_AddBinaryArray(pieces, data, with_components, uint64_header, compressed_data);
+        else
+        {
+            VTK_AddAppendedTag(pieces, data, with_components, offset);
+            offset += VTK_AppendedByteSize(data, uint64_header, compressed_data);
+        }
+        pieces.setArray(-1);
+    };
+    auto geometryarray = [&](size_t g, bool with_components)
+    {
+        if (geometry == nullptr) return dataarray(*geometry_arrays[g], with_components);
+        pieces.setArray(static_cast<int>(g));
+        if (settings.format != VTK_APPENDED_RAW) pieces.view(geometry->bytes[g].data(), geometry->bytes[g].size());
+        else
+        {
+            pieces.text(geometry->tags[g]+"offset=\""+std::to_string(offset)+"\" />\n");
+            offset += geometry->bytes[g].size();
+        }
+        pieces.setArray(-1);
+    };
+
+    std::string byte_order = "LittleEndian";
+    pieces.text("<?xml version=\"1.0\" ?>\n");
+    if (binary)
+    {
+        pieces.text("<VTKFile byte_order=\""+byte_order+"\" header_type=\""+(uint64_header ? "UInt64" : "UInt32")+"\" ");
+        if (compressed) pieces.text("compressor=\""+VTKCompressorName(settings.compressor)+"\" ");
+        pieces.text("type=\""+layout.type+"\" version=\"1.0\">\n");
+    }
+    else pieces.text("<VTKFile byte_order=\""+byte_order+"\" type=\""+layout.type+"\" version=\"0.1\">\n");
+    pieces.text("<"+layout.type+(layout.attributes.empty() ? "" : " "+layout.attributes)+">\n");
+    pieces.text("<Piece "+layout.piece+">\n");
+    size_t g = 0;
+    for (auto &section : layout.sections)
+    {
+        pieces.text("<"+section.name+">\n");
+        for (size_t i=0; i<section.no_arrays; i++) geometryarray(g++, section.with_components);
+        pieces.text("</"+section.name+">\n");
+    }
+    pieces.text("<PointData>\n");
+    for (auto &data : node_fields) dataarray(*data, true);
+    pieces.text("</PointData>\n");
+    pieces.text("<CellData>\n");
+    for (auto &data : cell_fields) dataarray(*data, true);
+    pieces.text("</CellData>\n");
+    pieces.text("</Piece>\n");
+    pieces.text("</"+layout.type+">\n");
+    if (settings.format == VTK_APPENDED_RAW)
+    {
+        // the structure before is known in size, the raw section after the underscore is aligned in the file
+        pieces.text(VTK_AppendedDataStart(pieces.ByteSize(), uint64_header));
+        if (geometry != nullptr)
+            for (size_t g=0; g<geometry->bytes.size(); g++)
+            {
+                pieces.setArray(static_cast<int>(g));
+                pieces.view(geometry->bytes[g].data(), geometry->bytes[g].size());
+            }
+        for (size_t i=0; i<arrays.size(); i++)
+        {
+            pieces.setArray(static_cast<int>(first_encoded+i));
+            VTK_AddAppendedArray(pieces, *arrays[i], uint64_header, compressed ? &compressed_arrays[i] : nullptr);
+        }
+        pieces.setArray(-1);
+        pieces.text("\n</AppendedData>\n");
+    }
+    pieces.text("</VTKFile>\n");
+
+    if (statistics == nullptr)
+    {
+        pieces.write(sink, pool);
+        sink.close();
+        return true;
+    }
+
+    pieces.write(sink, pool, statistics);
+    sink.close();
+    for (size_t i=0; i<compress_seconds.size(); i++)
+    {
+        statistics->arrays[first_encoded+i].encode_seconds += compress_seconds[i];
+        statistics->encode_seconds += compress_seconds[i];
+    }
+    statistics->seconds = std::chrono::duration<double>(std::chrono::steady_clock::now()-start).count();
+    return true;
+}
+
+/*
+Fields, write settings and output of every dataset type, e.g. VTK_UnstructuredGrid, VTK_ImageData and VTK_RectilinearGrid.
+The derived types provide the number of points and cells and write their geometry in writeSink(...).
+*/
+class VTK_DataSet
+{
+    public:
+        VTK_DataSet() : CellData_(0), NodeData_(0), NoThreads_(1) {}
+        virtual ~VTK_DataSet() { clearData(); }
+        VTK_DataSet(const VTK_DataSet&) = delete;
+        VTK_DataSet& operator=(const VTK_DataSet&) = delete;
+    protected:
+        std::vector<VTK_Array*> CellData_;
+        std::vector<VTK_Array*> NodeData_;
+    public:
+        virtual size_t NoPoints() const = 0;
+        virtual size_t NoCells() const = 0;
+
+        // Set cell data
+        template <typename T>
+        bool addCellData(const std::string name, const T* data_start_, std::array<size_t, 2> shape_, std::array<size_t, 2> strides_);
+
+        // convenience overload for m-component element data in a flattened format data_vector = {d11, d12, ..., d1m, d21, ..., dem} (e=number of elements)
+        template <typename T>
+        bool addCellData(const std::string name, const std::vector<T> &data_vector, const size_t no_components) { return addCellData(name, data_vector.data(), {NoCells(), no_components}, {sizeof(T)*no_components, sizeof(T)}); }
+
+        // Set node data
+        template <typename T>
+        bool addNodeData(const std::string name, const T* data_start_, std::array<size_t, 2> shape_, std::array<size_t, 2> strides_);
+
+        // convenience overload for m-component noda data in a flattened format data_vector = {d11, d12, ..., d1m, d21, ..., dnm} (n=number of nodes)
+        template <typename T>
+        bool addNodeData(const std::string name, const std::vector<T> &data_vector, const size_t no_components) { return addNodeData(name, data_vector.data(), {NoPoints(), no_components}, {sizeof(T)*no_components, sizeof(T)}); }
+
+        // Set cell or node data computed while writing instead of a temporary vector, see VTK_GeneratedArray.
+        // generator is either T(size_t entity, size_t component) or void(size_t first_entity, size_t no_entities, T* values),
+        // T has to be given for the second form, e.g. addCellData<double>("Volume", 1, [&](size_t first, size_t n, double* values){...})
+        template <typename T = void, typename F>
+        bool addCellData(const std::string name, const size_t no_components, F generator);
+        template <typename T = void, typename F>
+        bool addNodeData(const std::string name, const size_t no_components, F generator);
+
+        // Add cell or node data given by any VTK_Array, the dataset takes the ownership
+        bool addCellData(VTK_Array* data);
+        bool addNodeData(VTK_Array* data);
+
+        // Remove all cell and node data, e.g. to add the fields of the next time step
+        void clearData();
+
+        const std::vector<VTK_Array*>& NodeData() const {return NodeData_;}
+        const std::vector<VTK_Array*>& CellData() const {return CellData_;}
+
+    public:
+        // Select how the data arrays are written (VTK_ASCII by default)
+        void setFormat(VTK_OUTPUTFORMAT format) { settings_.format = format; }
+
+        // Select the block compression of the binary formats, level -1 is the default level of the compressor.
+        // Higher levels compress harder: zlib 1-9, lz4 2-12 switch to LZ4HC (-1, 0 and 1 are the fast lz4).
+        void setCompressor(VTK_COMPRESSOR compressor, int level = -1) { settings_.compressor = compressor; settings_.compression_level = level; }
+
+        // Precision of floating point values in the ascii format,
+        // 0 is the shortest representation which reads back to the identical value (default), n>0 are n significant digits
+        void setPrecision(int digits) { settings_.precision = digits; }
+
+        // Write Float64 node and cell data as Float32, halves the size of the fields
+        void setFloat32Fields(bool float32) { settings_.float32_fields = float32; }
+
+        // Write the node or cell data name within an error bound, see VTK_ERRORBOUND and VTK_LOSSYSTORAGE, e.g.
+        //     VTKOUT.setErrorBound("Stress", VTK_RELATIVE_ERROR, 1e-3);
+        //     VTKOUT.setErrorBound("Velocity", VTK_ABSOLUTE_ERROR, 1e-4, VTK_QUANTIZED_INTEGERS);
+        // The bound belongs to the name and stays for the fields of the next steps, VTK_LOSSLESS removes it.
+        void setErrorBound(const std::string& name, VTK_ERRORBOUND mode, double bound, VTK_LOSSYSTORAGE storage = VTK_ROUNDED_VALUES);
+
+        // All of the above at once
+        void setWriteSettings(const VTK_WriteSettings& settings) { settings_ = settings; }
+        const VTK_WriteSettings& WriteSettings() const { return settings_; }
+
+        // Number of threads used to encode the data arrays (1 by default, i.e. sequential).
+        // Arrays and ranges of large arrays are encoded in parallel, the file is identical for any number of threads.
+        void setNumberOfThreads(unsigned int no_threads) { NoThreads_ = no_threads > 0 ? no_threads : 1; }
+
+        // Writes the file, failures throw a std::runtime_error
+        bool write(std::string path_to_file);
+
+        // Writes to any sink, e.g. a VTK_MemorySink for in-situ consumers (the statistics sidecar is not written)
+        bool write(VTK_Sink& sink);
+
+        // Sink used by write(path_to_file): VTK_STREAM_FILE (default), VTK_MAPPED_FILE or VTK_ASYNC_FILE, see vtk_sink.hpp
+        void setFileBackend(VTK_FILEBACKEND backend) { FileBackend_ = backend; }
+
+        // Statistics of every write (disabled by default, the writer does not measure anything then), see VTK_WriteStatistics.
+        // callback -> called with the statistics after every write
+        // sidecar  -> writes the statistics as JSON next to the file, "file.vtu" -> "file.vtu.json"
+        void setStatisticsCallback(std::function<void(const VTK_WriteStatistics&)> callback) { StatisticsCallback_ = std::move(callback); }
+        void setStatisticsSidecar(bool sidecar) { StatisticsSidecar_ = sidecar; }
+    protected:
+        virtual bool writeSink(VTK_Sink& sink, VTK_WriteStatistics* statistics) = 0;
+        // false until the points or the cells are known, fields cannot be added before
+        virtual bool PointsSet() const { return true; }
+        virtual bool CellsSet() const { return true; }
+        VTK_ThreadPool* pool()
+        {
+            if (NoThreads_ <= 1) return nullptr;
+            if (!pool_ || pool_->NoThreads() != NoThreads_) pool_.reset(new VTK_ThreadPool(NoThreads_));
+            return pool_.get();
+        }
+    protected:
+        VTK_WriteSettings settings_;
+        unsigned int NoThreads_;
+        std::unique_ptr<VTK_ThreadPool> pool_;
+        std::function<void(const VTK_WriteStatistics&)> StatisticsCallback_;
+        bool StatisticsSidecar_ = false;
+        VTK_FILEBACKEND FileBackend_ = VTK_STREAM_FILE;
+};
+
+inline bool VTK_DataSet::write(std::string path_to_file)
+{
+    std::unique_ptr<VTK_Sink> sink = VTK_OpenFileSink(path_to_file, FileBackend_);
+    if (!StatisticsCallback_ && !StatisticsSidecar_) return writeSink(*sink, nullptr);
+
+    VTK_WriteStatistics statistics;
+    writeSink(*sink, &statistics);
+    if (StatisticsSidecar_ && !statistics.writeJSON(path_to_file+".json")) throw std::runtime_error("Error writing "+path_to_file+".json!");
+    if (StatisticsCallback_) StatisticsCallback_(statistics);
+    return true;
+}
+
+inline bool VTK_DataSet::write(VTK_Sink& sink)
+{
+    if (!StatisticsCallback_) return writeSink(sink, nullptr);
+    VTK_WriteStatistics statistics;
+    writeSink(sink, &statistics);
+    StatisticsCallback_(statistics);
+    return true;
+}
+
+inline void VTK_DataSet::setErrorBound(const std::string& name, VTK_ERRORBOUND mode, double bound, VTK_LOSSYSTORAGE storage)
+{
+    if (mode == VTK_LOSSLESS)
+    {
+        settings_.error_bounds.erase(name);
+        return;
+    }
+    if (!(bound > 0) || !std::isfinite(bound)) throw std::runtime_error("Error setting the error bound of "+name+"! The bound has to be positive and finite.");
+    if (storage == VTK_QUANTIZED_INTEGERS && mode != VTK_ABSOLUTE_ERROR) throw std::runtime_error("Error setting the error bound of "+name+"! Quantized integers need an absolute error bound.");
+    settings_.error_bounds[name] = {mode, bound, storage};
+}
+
+template <typename T>
+bool VTK_DataSet::addNodeData(const std::string name, const T* data_start_, std::array<size_t, 2> shape_, std::array<size_t, 2> strides_)
+{
+    // check if points have already been set
+    if (!PointsSet()) throw std::runtime_error("Error adding NodeData! Call setPoints(...) first");
+
+    // check if node data meets number of nodes
+    if (shape_[0] != NoPoints())throw std::runtime_error("Error adding NodeData! Number of NodeData does not match number of present nodes");
+
+    // create a vtk data array
+    auto NewNodeData_ = new VTK_DataArray(name, data_start_, shape_, strides_);
+    NodeData_.push_back(NewNodeData_);
+
+    if (NewNodeData_!=nullptr) return true;
+    return false;
+}
+
+template <typename T>
+bool VTK_DataSet::addCellData(const std::string name, const T* data_start_, std::array<size_t, 2> shape_, std::array<size_t, 2> strides_)
+{
+    // check if elements have already been set
+    if (!CellsSet()) throw std::runtime_error("Error adding CellData! Call setElements(...) first");
+
+    // check if cell data meets number of elements
+    if (shape_[0] != NoCells())throw std::runtime_error("Error adding CellData! Number of CellData does not match number of present elements");
+
+    // create a vtk data array
+    auto NewCellData_ = new VTK_DataArray(name, data_start_, shape_, strides_);
+    CellData_.push_back(NewCellData_);
+
+    if (NewCellData_!=nullptr) return true;
+    return false;
+}
+
+template <typename T, typename F>
+bool VTK_DataSet::addNodeData(const std::string name, const size_t no_components, F generator)
+{
+    if (!PointsSet()) throw std::runtime_error("Error adding NodeData! Call setPoints(...) first");
+    return addNodeData(new VTK_GeneratedArray<VTK_GeneratedType<T, F>, F>(name, NoPoints(), no_components, std::move(generator)));
+}
+
+template <typename T, typename F>
+bool VTK_DataSet::addCellData(const std::string name, const size_t no_components, F generator)
+{
+    if (!CellsSet()) throw std::runtime_error("Error adding CellData! Call setElements(...) first");
+    return addCellData(new VTK_GeneratedArray<VTK_GeneratedType<T, F>, F>(name, NoCells(), no_components, std::move(generator)));
+}
+
+inline bool VTK_DataSet::addNodeData(VTK_Array* data)
+{
+    if (!PointsSet()) throw std::runtime_error("Error adding NodeData! Call setPoints(...) first");
+    if (data->NoEntities() != NoPoints()) throw std::runtime_error("Error adding NodeData! Number of NodeData does not match number of present nodes");
+    NodeData_.push_back(data);
+    return true;
+}
+
+inline bool VTK_DataSet::addCellData(VTK_Array* data)
+{
+    if (!CellsSet()) throw std::runtime_error("Error adding CellData! Call setElements(...) first");
+    if (data->NoEntities() != NoCells()) throw std::runtime_error("Error adding CellData! Number of CellData does not match number of present elements");
+    CellData_.push_back(data);
+    return true;
+}
+
+inline void VTK_DataSet::clearData()
+{
+    for (auto &data : CellData_) delete data;
+    for (auto &data : NodeData_) delete data;
+    CellData_.clear();
+    NodeData_.clear();
+}
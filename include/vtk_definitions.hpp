@@ -1,6 +1,8 @@
 #pragma once
 
 #include <string>
+#include <cstdint>
+#include <map>
 
 /**!
  * \breif The VTK-CELLTYPE
@@ -15,10 +17,13 @@
           VTK_QUADRATIC_TRIANGLE (6 Nodes),
           VTK_QUADRATIC_QUAD (8 Nodes),
           VTK_QUADRATIC_TETRA (10 Nodes),
-          VTK_QUADRATIC_HEXAHEDRON (20 Nodes)
+          VTK_QUADRATIC_HEXAHEDRON (20 Nodes),
+          VTK_POLYGON, VTK_POLYHEDRON (any number of nodes)
+VTK_EMPTY_CELL marks grids of mixed cell types, see VTK_UnstructuredGrid::CellType()
 */
 enum VTK_CELLTYPE
 {
+    VTK_EMPTY_CELL = 0,
     VTK_VERTEX = 1,
     VTK_POLY_VERTEX = 2,
     VTK_LINE = 3,
@@ -38,12 +43,13 @@ enum VTK_CELLTYPE
     VTK_QUADRATIC_QUAD = 23,
     VTK_QUADRATIC_TETRA = 24,
     VTK_QUADRATIC_HEXAHEDRON = 25,
+    VTK_POLYHEDRON = 42,
 };
 
 /*
 Nodes per VTK_CELLTYPE 
-Notice that all *POLY* types are not supported, 
-if 0 zero is returned it must be handeled outside this function.
+Notice that all *POLY* types have no fixed number of nodes,
+if 0 zero is returned the nodes have to be given with the cells, see VTK_CellBlock.
 */
 inline unsigned int VTK_CELL_NODES(VTK_CELLTYPE type)
 {
@@ -72,11 +78,126 @@ inline unsigned int VTK_CELL_NODES(VTK_CELLTYPE type)
     }
 }
 
+/*
+Output format of the data arrays
+VTK_ASCII        -> values are written as text inside of each DataArray
+VTK_APPENDED_RAW -> values are written as raw bytes into one <AppendedData> section at the end of the file,
+                    the DataArrays only hold their offset into this section
+VTK_BINARY       -> values are written base64 encoded inside of each DataArray
+*/
+enum VTK_OUTPUTFORMAT
+{
+    VTK_ASCII = 0,
+    VTK_APPENDED_RAW = 1,
+    VTK_BINARY = 2,
+};
+
+/*
+Block compression of the binary formats (VTK_APPENDED_RAW and VTK_BINARY)
+VTK_ZLIB needs the library to be built with zlib (VTK_WITH_ZLIB), VTK_LZ4 with lz4 (VTK_WITH_LZ4).
+*/
+enum VTK_COMPRESSOR
+{
+    VTK_NO_COMPRESSION = 0,
+    VTK_ZLIB = 1,
+    VTK_LZ4 = 2,
+};
+
+/*
+Order of the points and cells in the output of VTK_UnstructuredGrid, see VTK_ComputeReordering(...)
+VTK_MORTON, VTK_HILBERT -> points and cell centroids sorted along the Z-order or Hilbert curve
+VTK_RCM                 -> reverse Cuthill-McKee numbering of the points, the cells follow their lowest point
+*/
+enum VTK_REORDERING
+{
+    VTK_NO_REORDERING = 0,
+    VTK_MORTON = 1,
+    VTK_HILBERT = 2,
+    VTK_RCM = 3,
+};
+
+/*
+Error bound of the lossy output of a Float64 or Float32 field, see VTK_DataSet::setErrorBound(...)
+VTK_LOSSLESS       -> the values are written as they are
+VTK_ABSOLUTE_ERROR -> |written-value| <= bound
+VTK_RELATIVE_ERROR -> |written-value| <= bound*|value|
+*/
+enum VTK_ERRORBOUND
+{
+    VTK_LOSSLESS = 0,
+    VTK_ABSOLUTE_ERROR = 1,
+    VTK_RELATIVE_ERROR = 2,
+};
+
+/*
+Storage of the values of an error bounded field, see vtk_quantization.hpp
+VTK_ROUNDED_VALUES     -> the type is kept, the values are rounded to fewer mantissa bits (relative) or to a power of two step (absolute),
+                          the low bits become zero and the lossless compressors squeeze the array much harder
+VTK_QUANTIZED_INTEGERS -> UInt32 steps k with the DataArray attributes QuantizationScale and QuantizationOffset, value = offset+k*scale,
+                          absolute bounds only
+*/
+enum VTK_LOSSYSTORAGE
+{
+    VTK_ROUNDED_VALUES = 0,
+    VTK_QUANTIZED_INTEGERS = 1,
+};
+
+struct VTK_ErrorBound
+{
+    VTK_ERRORBOUND mode = VTK_LOSSLESS;
+    double bound = 0;
+    VTK_LOSSYSTORAGE storage = VTK_ROUNDED_VALUES;
+
+    bool operator==(const VTK_ErrorBound& other) const { return mode == other.mode && bound == other.bound && storage == other.storage; }
+    bool operator!=(const VTK_ErrorBound& other) const { return !(*this == other); }
+};
+
+// Name of the compressor class as expected by the VTK readers
+inline std::string VTKCompressorName(VTK_COMPRESSOR compressor)
+{
+    switch (compressor)
+    {
+    case VTK_ZLIB:  return "vtkZLibDataCompressor";
+    case VTK_LZ4:   return "vtkLZ4DataCompressor";
+    default: return "";
+    }
+}
+
+/*
+Settings of a write, shared by the grids, series and pieces
+format            -> VTK_OUTPUTFORMAT of the data arrays
+compressor        -> block compression of the binary formats
+compression_level -> level of the compressor, -1 is its default, higher levels compress harder (lz4 > 1 uses LZ4HC)
+precision         -> ascii: 0 shortest representation which reads back identical, n>0 n significant digits
+error_bounds      -> error bound of the node and cell data by name, the other fields are lossless
+*/
+struct VTK_WriteSettings
+{
+    VTK_OUTPUTFORMAT format = VTK_ASCII;
+    VTK_COMPRESSOR compressor = VTK_NO_COMPRESSION;
+    int compression_level = -1;
+    int precision = 0;
+    // Float64 node and cell data is written as Float32
+    bool float32_fields = false;
+    std::map<std::string, VTK_ErrorBound> error_bounds;
+
+    bool operator==(const VTK_WriteSettings& other) const
+    {
+        return format == other.format && compressor == other.compressor && compression_level == other.compression_level && precision == other.precision
+            && float32_fields == other.float32_fields && error_bounds == other.error_bounds;
+    }
+    bool operator!=(const VTK_WriteSettings& other) const { return !(*this == other); }
+};
+
 /*
 Supports only types of data: 
-UInt8, Int32, UInt64, Float64
+UInt8, Int32, UInt32, Int64, UInt64, Float32, Float64
 */
-inline std::string VTKType(const size_t &)          {return "UInt32";}
+inline std::string VTKType(const size_t &)          {return "UInt64";}
 inline std::string VTKType(const VTK_CELLTYPE &)    {return "UInt8";}
 inline std::string VTKType(const double &)          {return "Float64";}
-inline std::string VTKType(const int &)             {return "Int32";}
\ No newline at end of file
+inline std::string VTKType(const float &)           {return "Float32";}
+inline std::string VTKType(const int &)             {return "Int32";}
+inline std::string VTKType(const uint32_t &)        {return "UInt32";}
+inline std::string VTKType(const int64_t &)         {return "Int64";}
+inline std::string VTKType(const uint8_t &)         {return "UInt8";}
\ No newline at end of file
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <cstddef>
+#include <cstring>
+
+/*
+Kernels which copy strided values packed into a buffer, used by VTK_DataArray::gather(...).
+The component count N is a template parameter for the common cases (scalars, vectors, symmetric and full tensors),
+so the copy of one entity has a fixed size and the compiler turns it into a few vector loads and stores.
+The kernels work on bytes, neither src nor dst have to be aligned to T.
+*/
+enum VTK_LAYOUT {VTK_LAYOUT_CONTIGUOUS=0, VTK_LAYOUT_PACKED=1, VTK_LAYOUT_STRIDED=2};
+
+// Layout of an array with the given strides in bytes
+// contiguous -> components and entities follow each other without gaps, one memcpy
+// packed     -> the components of an entity follow each other, the entities are apart (array of structs)
+// strided    -> gaps between the components
+inline VTK_LAYOUT VTK_ArrayLayout(size_t value_size, size_t no_components, size_t entity_stride, size_t component_stride)
+{
+    const bool packed = (component_stride == value_size) || (no_components == 1);
+    if (packed && entity_stride == no_components*value_size) return VTK_LAYOUT_CONTIGUOUS;
+    return packed ? VTK_LAYOUT_PACKED : VTK_LAYOUT_STRIDED;
+}
+
+// n entities of N packed components, the entities start entity_stride bytes apart
+template <typename T, size_t N>
+inline void VTK_GatherPacked(const char* src, size_t entity_stride, size_t n, char* dst)
+{
+    constexpr size_t entity_bytes = N*sizeof(T);
+    size_t i = 0;
+    // four independent copies per iteration
+    for (; i+4 <= n; i+=4, src+=4*entity_stride, dst+=4*entity_bytes)
+    {
+        std::memcpy(dst, src, entity_bytes);
+        std::memcpy(dst+entity_bytes, src+entity_stride, entity_bytes);
+        std::memcpy(dst+2*entity_bytes, src+2*entity_stride, entity_bytes);
+        std::memcpy(dst+3*entity_bytes, src+3*entity_stride, entity_bytes);
+    }
+    for (; i<n; i++, src+=entity_stride, dst+=entity_bytes) std::memcpy(dst, src, entity_bytes);
+}
+
+// n entities of N components, the components start component_stride bytes apart
+template <typename T, size_t N>
+inline void VTK_GatherStrided(const char* src, size_t entity_stride, size_t component_stride, size_t n, char* dst)
+{
+    for (size_t i=0; i<n; i++, src+=entity_stride)
+        for (size_t c=0; c<N; c++, dst+=sizeof(T)) std::memcpy(dst, src+c*component_stride, sizeof(T));
+}
+
+// Dispatches the component count to the fixed size kernels, other counts use the runtime loop
+template <typename T>
+inline void VTK_Gather(VTK_LAYOUT layout, const char* src, size_t no_components, size_t entity_stride, size_t component_stride, size_t n, char* dst)
+{
+    if (layout == VTK_LAYOUT_CONTIGUOUS)
+    {
+        std::memcpy(dst, src, n*no_components*sizeof(T));
+        return;
+    }
+    if (layout == VTK_LAYOUT_PACKED)
+    {
+        switch (no_components)
+        {
+        case 1: return VTK_GatherPacked<T, 1>(src, entity_stride, n, dst);
+        case 2: return VTK_GatherPacked<T, 2>(src, entity_stride, n, dst);
+        case 3: return VTK_GatherPacked<T, 3>(src, entity_stride, n, dst);
+        case 6: return VTK_GatherPacked<T, 6>(src, entity_stride, n, dst);
+        case 9: return VTK_GatherPacked<T, 9>(src, entity_stride, n, dst);
+        default:
+            for (size_t i=0; i<n; i++, src+=entity_stride, dst+=no_components*sizeof(T)) std::memcpy(dst, src, no_components*sizeof(T));
+            return;
+        }
+    }
+    switch (no_components)
+    {
+    case 2: return VTK_GatherStrided<T, 2>(src, entity_stride, component_stride, n, dst);
+    case 3: return VTK_GatherStrided<T, 3>(src, entity_stride, component_stride, n, dst);
+    case 6: return VTK_GatherStrided<T, 6>(src, entity_stride, component_stride, n, dst);
+    case 9: return VTK_GatherStrided<T, 9>(src, entity_stride, component_stride, n, dst);
+    default:
+        for (size_t i=0; i<n; i++, src+=entity_stride)
+            for (size_t c=0; c<no_components; c++, dst+=sizeof(T)) std::memcpy(dst, src+c*component_stride, sizeof(T));
+        return;
+    }
+}
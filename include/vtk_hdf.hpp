@@ -0,0 +1,295 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <array>
+#include <memory>
+#include <stdexcept>
+#include <algorithm>
+
+#include <hdf5.h>
+
+#include <vtk_unstructuredgrid.hpp>
+
+// Native HDF5 type of a VTK type name, e.g. "Float64" -> H5T_NATIVE_DOUBLE
+inline hid_t VTK_HDFType(const std::string& vtk_type)
+{
+    if (vtk_type == "Float64") return H5T_NATIVE_DOUBLE;
+    if (vtk_type == "Float32") return H5T_NATIVE_FLOAT;
+    if (vtk_type == "Int32") return H5T_NATIVE_INT32;
+    if (vtk_type == "UInt32") return H5T_NATIVE_UINT32;
+    if (vtk_type == "Int64") return H5T_NATIVE_INT64;
+    if (vtk_type == "UInt64") return H5T_NATIVE_UINT64;
+    if (vtk_type == "UInt8") return H5T_NATIVE_UINT8;
+    throw std::runtime_error("Error writing VTKHDF! Unsupported type "+vtk_type);
+}
+
+/*
+VTK_HDFTimeSeries(
+                  std::string path_to_file_   -> e.g. "results/run.vtkhdf"
+                  )
+Writes the steps of a transient unstructured grid into one VTKHDF file (UnstructuredGrid with a Steps group, version 2.0).
+Points and cells are stored once and referenced by every step until the grid changes its geometry
+(setPoints(...), setElements(...) or setFaces(...)), then the new geometry is appended as a new part.
+The fields of every step are appended to extendible, chunked datasets and the file is flushed after every step,
+so it stays readable while the run continues. Every step has to provide the fields of the first step.
+Settings are taken from the grid: VTK_ZLIB compresses the chunks with shuffle and deflate, float32_fields stores Float64 fields as Float32.
+Example:
+    VTK_HDFTimeSeries series("results/run.vtkhdf");
+    VTKOUT.setPoints(XI);
+    VTKOUT.setElements(Elmt, VTK_HEXAHEDRON);
+    VTKOUT.setCompressor(VTK_ZLIB);
+    for (...)
+    {
+        VTKOUT.clearData();
+        VTKOUT.addNodeData("Temperature", T, 1);
+        series.write(VTKOUT, time);
+    }
+*/
+class VTK_HDFTimeSeries
+{
+    public:
+        VTK_HDFTimeSeries(std::string path_to_file_)
+        : Path_(path_to_file_), ChunkEntities_(1 << 16), NoSteps_(0), NoParts_(0), Grid_(nullptr), GeometryVersion_(0)
+        {
+            File_ = check(H5Fcreate(Path_.c_str(), H5F_ACC_TRUNC, H5P_DEFAULT, H5P_DEFAULT), "creating the file");
+            Root_ = check(H5Gcreate2(File_, "VTKHDF", H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT), "creating the VTKHDF group");
+            const int version[2] = {2, 0};
+            attribute(Root_, "Version", H5T_NATIVE_INT, version, 2);
+            const std::string type = "UnstructuredGrid";
+            hid_t string_type = H5Tcopy(H5T_C_S1);
+            H5Tset_size(string_type, type.size());
+            H5Tset_strpad(string_type, H5T_STR_NULLPAD);
+            attribute(Root_, "Type", string_type, type.data(), 0);
+            H5Tclose(string_type);
+            for (const char* group : {"PointData", "CellData", "FieldData"}) H5Gclose(check(H5Gcreate2(Root_, group, H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT), "creating a group"));
+            Steps_ = check(H5Gcreate2(Root_, "Steps", H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT), "creating the Steps group");
+            for (const char* group : {"PointDataOffsets", "CellDataOffsets", "FieldDataOffsets"}) H5Gclose(check(H5Gcreate2(Steps_, group, H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT), "creating a group"));
+            const int64_t no_steps = 0;
+            attribute(Steps_, "NSteps", H5T_NATIVE_INT64, &no_steps, 1);
+        }
+        ~VTK_HDFTimeSeries()
+        {
+            H5Gclose(Steps_);
+            H5Gclose(Root_);
+            H5Fclose(File_);
+        }
+        VTK_HDFTimeSeries(const VTK_HDFTimeSeries&) = delete;
+        VTK_HDFTimeSeries& operator=(const VTK_HDFTimeSeries&) = delete;
+    public:
+        // Rows per chunk of the datasets of points, cells and fields (65536 by default), set before the first write
+        void setChunkSize(size_t entities) { ChunkEntities_ = std::max<size_t>(entities, 1); }
+
+        // Appends the fields of grid as the step at time, the geometry is only written if it changed
+        bool write(const VTK_UnstructuredGrid& grid, double time);
+
+        size_t NoSteps() const { return NoSteps_; }
+    private:
+        hid_t check(hid_t id, const std::string& action) const
+        {
+            if (id < 0) throw std::runtime_error("Error writing "+Path_+"! Failed "+action+".");
+            return id;
+        }
+        // values -> no_values entries, 0 for a scalar string
+        void attribute(hid_t group, const std::string& name, hid_t type, const void* values, size_t no_values)
+        {
+            const hsize_t dims[1] = {no_values};
+            hid_t space = (no_values > 1) ? H5Screate_simple(1, dims, nullptr) : H5Screate(H5S_SCALAR);
+            if (H5Aexists(group, name.c_str()) > 0) H5Adelete(group, name.c_str());
+            hid_t attr = check(H5Acreate2(group, name.c_str(), type, space, H5P_DEFAULT, H5P_DEFAULT), "creating the attribute "+name);
+            const herr_t status = H5Awrite(attr, type, values);
+            H5Aclose(attr);
+            H5Sclose(space);
+            check(status, "writing the attribute "+name);
+        }
+        // Extendible dataset of rows with no_components columns (a vector if no_components is 0)
+        hid_t dataset(hid_t group, const std::string& name, hid_t type, size_t no_components, size_t chunk_rows)
+        {
+            const int rank = (no_components > 0) ? 2 : 1;
+            const hsize_t dims[2] = {0, no_components}, maxdims[2] = {H5S_UNLIMITED, no_components}, chunk[2] = {chunk_rows, std::max<size_t>(no_components, 1)};
+            hid_t space = H5Screate_simple(rank, dims, maxdims);
+            hid_t properties = H5Pcreate(H5P_DATASET_CREATE);
+            H5Pset_chunk(properties, rank, chunk);
+            if (Compressed_)
+            {
+                H5Pset_shuffle(properties);
+                H5Pset_deflate(properties, Level_);
+            }
+            hid_t id = H5Dcreate2(group, name.c_str(), type, space, H5P_DEFAULT, properties, H5P_DEFAULT);
+            H5Pclose(properties);
+            H5Sclose(space);
+            return check(id, "creating the dataset "+name);
+        }
+        // Appends no_rows rows of values of type to the dataset, returns the first appended row
+        size_t append(hid_t id, hid_t type, const void* values, size_t no_rows)
+        {
+            hid_t space = H5Dget_space(id);
+            const int rank = H5Sget_simple_extent_ndims(space);
+            hsize_t dims[2] = {0, 1};
+            H5Sget_simple_extent_dims(space, dims, nullptr);
+            H5Sclose(space);
+            const hsize_t start[2] = {dims[0], 0}, count[2] = {no_rows, dims[1]};
+            dims[0] += no_rows;
+            check(H5Dset_extent(id, dims), "extending a dataset");
+            space = H5Dget_space(id);
+            H5Sselect_hyperslab(space, H5S_SELECT_SET, start, nullptr, count, nullptr);
+            hid_t memory = H5Screate_simple(rank, count, nullptr);
+            const herr_t status = H5Dwrite(id, type, memory, space, H5P_DEFAULT, values);
+            H5Sclose(memory);
+            H5Sclose(space);
+            check(status, "writing a dataset");
+            return start[0];
+        }
+        // Appends the values of data in slabs of ChunkEntities_ entities, gathered through the VTK_Array interface.
+        // The components are columns of a two dimensional dataset and flattened into a vector otherwise, e.g. the connectivity.
+        // Returns the first appended row.
+        size_t append(hid_t id, const VTK_Array& data)
+        {
+            hid_t space = H5Dget_space(id);
+            const bool flat = H5Sget_simple_extent_ndims(space) == 1;
+            hsize_t dims[2] = {0, 1};
+            H5Sget_simple_extent_dims(space, dims, nullptr);
+            H5Sclose(space);
+            const hid_t type = VTK_HDFType(data.Type());
+            const size_t entity_bytes = data.NoComponents()*data.ValueSize();
+            std::vector<char> slab(std::min(data.NoEntities(), ChunkEntities_)*entity_bytes);
+            for (size_t first=0; first<data.NoEntities(); first+=ChunkEntities_)
+            {
+                const size_t n = std::min(ChunkEntities_, data.NoEntities()-first);
+                data.gather(first, n, slab.data());
+                append(id, type, slab.data(), flat ? n*data.NoComponents() : n);
+            }
+            return dims[0];
+        }
+        size_t appendValue(hid_t group, const std::string& name, int64_t value)
+        {
+            hid_t id = check(H5Dopen2(group, name.c_str(), H5P_DEFAULT), "opening the dataset "+name);
+            const size_t row = append(id, H5T_NATIVE_INT64, &value, 1);
+            H5Dclose(id);
+            return row;
+        }
+        size_t appendArray(hid_t group, const std::string& name, const VTK_Array& data)
+        {
+            hid_t id = check(H5Dopen2(group, name.c_str(), H5P_DEFAULT), "opening the dataset "+name);
+            const size_t row = append(id, data);
+            H5Dclose(id);
+            return row;
+        }
+        void createLayout(const VTK_UnstructuredGrid& grid, const std::vector<const VTK_Array*>& node_fields, const std::vector<const VTK_Array*>& cell_fields);
+        void writeGeometry(const VTK_UnstructuredGrid& grid);
+    private:
+        std::string Path_;
+        hid_t File_, Root_, Steps_;
+        size_t ChunkEntities_;
+        bool Compressed_ = false;
+        unsigned int Level_ = 6;
+        size_t NoSteps_, NoParts_;
+        // first point, cell and connectivity id of the last part in the datasets of the root group
+        std::array<int64_t, 3> PartOffsets_ = {0, 0, 0};
+        const VTK_UnstructuredGrid* Grid_;
+        size_t GeometryVersion_;
+        // name, type and components of the fields of the first step
+        std::vector<std::string> NodeFields_, CellFields_;
+};
+
+inline void VTK_HDFTimeSeries::createLayout(const VTK_UnstructuredGrid& grid, const std::vector<const VTK_Array*>& node_fields, const std::vector<const VTK_Array*>& cell_fields)
+{
+    const VTK_WriteSettings& settings = grid.WriteSettings();
+    if (settings.compressor == VTK_LZ4) throw std::runtime_error("Error writing "+Path_+"! VTKHDF supports VTK_ZLIB compression only.");
+    Compressed_ = (settings.compressor == VTK_ZLIB);
+    Level_ = (settings.compression_level < 0) ? 6 : static_cast<unsigned int>(std::min(settings.compression_level, 9));
+
+    for (const char* name : {"NumberOfPoints", "NumberOfCells", "NumberOfConnectivityIds"}) H5Dclose(dataset(Root_, name, H5T_NATIVE_INT64, 0, 64));
+    H5Dclose(dataset(Root_, "Points", H5T_NATIVE_DOUBLE, 3, ChunkEntities_));
+    H5Dclose(dataset(Root_, "Connectivity", H5T_NATIVE_INT64, 0, ChunkEntities_));
+    H5Dclose(dataset(Root_, "Offsets", H5T_NATIVE_INT64, 0, ChunkEntities_));
+    H5Dclose(dataset(Root_, "Types", H5T_NATIVE_UINT8, 0, ChunkEntities_));
+
+    for (const char* name : {"Values"}) H5Dclose(dataset(Steps_, name, H5T_NATIVE_DOUBLE, 0, 256));
+    for (const char* name : {"PartOffsets", "NumberOfParts", "PointOffsets"}) H5Dclose(dataset(Steps_, name, H5T_NATIVE_INT64, 0, 256));
+    for (const char* name : {"CellOffsets", "ConnectivityIdOffsets"}) H5Dclose(dataset(Steps_, name, H5T_NATIVE_INT64, 1, 256));
+
+    auto fields = [&](const std::vector<const VTK_Array*>& data, const char* group_name, const char* offsets_name, std::vector<std::string>& names)
+    {
+        hid_t group = H5Gopen2(Root_, group_name, H5P_DEFAULT);
+        hid_t offsets = H5Gopen2(Steps_, offsets_name, H5P_DEFAULT);
+        for (auto &field : data)
+        {
+            // scalars are vectors, the components of other fields are columns
+            const size_t no_components = (field->NoComponents() == 1) ? 0 : field->NoComponents();
+            const hid_t type = (settings.float32_fields && field->Type() == "Float64") ? H5T_NATIVE_FLOAT : VTK_HDFType(field->Type());
+            H5Dclose(dataset(group, field->Name(), type, no_components, ChunkEntities_));
+            H5Dclose(dataset(offsets, field->Name(), H5T_NATIVE_INT64, 0, 256));
+            names.push_back(field->Name()+" "+field->Type()+" "+std::to_string(field->NoComponents()));
+        }
+        H5Gclose(offsets);
+        H5Gclose(group);
+    };
+    fields(node_fields, "PointData", "PointDataOffsets", NodeFields_);
+    fields(cell_fields, "CellData", "CellDataOffsets", CellFields_);
+}
+
+inline void VTK_HDFTimeSeries::writeGeometry(const VTK_UnstructuredGrid& grid)
+{
+    if (grid.Faces() != nullptr) throw std::runtime_error("Error writing "+Path_+"! Polyhedra are not supported by the VTKHDF writer.");
+    // the new part starts behind the previous one
+    const size_t no_ids = grid.Connectivity()->NoEntities()*grid.Connectivity()->NoComponents();
+    PartOffsets_[0] = static_cast<int64_t>(appendArray(Root_, "Points", *grid.Points()));
+    PartOffsets_[1] = static_cast<int64_t>(appendArray(Root_, "Types", *grid.Types()));
+    PartOffsets_[2] = static_cast<int64_t>(appendArray(Root_, "Connectivity", *grid.Connectivity()));
+    appendValue(Root_, "NumberOfPoints", static_cast<int64_t>(grid.NoPoints()));
+    appendValue(Root_, "NumberOfCells", static_cast<int64_t>(grid.NoCells()));
+    appendValue(Root_, "NumberOfConnectivityIds", static_cast<int64_t>(no_ids));
+    // VTKHDF offsets start with 0 in every part
+    appendValue(Root_, "Offsets", 0);
+    appendArray(Root_, "Offsets", *grid.Offsets());
+    NoParts_++;
+    Grid_ = &grid;
+    GeometryVersion_ = grid.GeometryVersion();
+}
+
+inline bool VTK_HDFTimeSeries::write(const VTK_UnstructuredGrid& grid, double time)
+{
+    if (grid.Offsets() == nullptr || grid.Points() == nullptr) throw std::runtime_error("Error writing "+Path_+"! Call setPoints(...) and setElements(...) first");
+    // Float64 fields are converted by HDF5 if they are stored as Float32
+    const std::vector<const VTK_Array*> node_fields(grid.NodeData().begin(), grid.NodeData().end()), cell_fields(grid.CellData().begin(), grid.CellData().end());
+    if (NoSteps_ == 0) createLayout(grid, node_fields, cell_fields);
+
+    // every step holds the fields of the first step
+    auto match = [](const std::vector<const VTK_Array*>& data, const std::vector<std::string>& names)
+    {
+        if (data.size() != names.size()) return false;
+        for (size_t i=0; i<data.size(); i++)
+            if (names[i] != data[i]->Name()+" "+data[i]->Type()+" "+std::to_string(data[i]->NoComponents())) return false;
+        return true;
+    };
+    if (!match(node_fields, NodeFields_) || !match(cell_fields, CellFields_)) throw std::runtime_error("Error writing "+Path_+"! Every step has to provide the NodeData and CellData of the first step.");
+
+    if (NoParts_ == 0 || &grid != Grid_ || grid.GeometryVersion() != GeometryVersion_) writeGeometry(grid);
+
+    hid_t values = check(H5Dopen2(Steps_, "Values", H5P_DEFAULT), "opening the dataset Values");
+    append(values, H5T_NATIVE_DOUBLE, &time, 1);
+    H5Dclose(values);
+    appendValue(Steps_, "PartOffsets", static_cast<int64_t>(NoParts_-1));
+    appendValue(Steps_, "NumberOfParts", 1);
+    appendValue(Steps_, "PointOffsets", PartOffsets_[0]);
+    appendValue(Steps_, "CellOffsets", PartOffsets_[1]);
+    appendValue(Steps_, "ConnectivityIdOffsets", PartOffsets_[2]);
+
+    auto fields = [&](const std::vector<const VTK_Array*>& data, const char* group_name, const char* offsets_name)
+    {
+        hid_t group = H5Gopen2(Root_, group_name, H5P_DEFAULT);
+        hid_t offsets = H5Gopen2(Steps_, offsets_name, H5P_DEFAULT);
+        for (auto &field : data) appendValue(offsets, field->Name(), static_cast<int64_t>(appendArray(group, field->Name(), *field)));
+        H5Gclose(offsets);
+        H5Gclose(group);
+    };
+    fields(node_fields, "PointData", "PointDataOffsets");
+    fields(cell_fields, "CellData", "CellDataOffsets");
+
+    NoSteps_++;
+    const int64_t no_steps = static_cast<int64_t>(NoSteps_);
+    attribute(Steps_, "NSteps", H5T_NATIVE_INT64, &no_steps, 1);
+    check(H5Fflush(File_, H5F_SCOPE_GLOBAL), "flushing the file");
+    return true;
+}
@@ -0,0 +1,199 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <fstream>
+#include <algorithm>
+
+#include <vtk_unstructuredgrid.hpp>
+
+// File of piece i of a partitioned grid: "dir/run.pvtu" -> "dir/run_i.vtu"
+inline std::string VTK_PieceFileName(const std::string& path_to_pvtu, size_t piece)
+{
+    const size_t dot = path_to_pvtu.rfind(".pvtu");
+    const std::string basename = (dot == std::string::npos) ? path_to_pvtu : path_to_pvtu.substr(0, dot);
+    return basename+"_"+std::to_string(piece)+".vtu";
+}
+
+/*
+Writes the .pvtu master file of a grid which is split into no_pieces .vtu files named by VTK_PieceFileName(...).
+The arrays of the PPointData and PCellData sections are taken from prototype, e.g. the piece of the calling rank:
+    VTK_UnstructuredGrid piece;
+    ... setPoints, setElements, addNodeData of this rank ...
+    piece.write(VTK_PieceFileName("results/run.pvtu", rank));
+    if (rank == 0) VTK_WritePVTU("results/run.pvtu", no_ranks, piece);
+*/
+inline bool VTK_WritePVTU(const std::string& path_to_pvtu, size_t no_pieces, const VTK_UnstructuredGrid& prototype)
+{
+    auto pdataarray = [&prototype](const VTK_Array& data, bool with_components)
+    {
+        // the type as it is written to the pieces
+        const std::string type = VTK_WrittenType(data, prototype.WriteSettings());
+        std::string tag = "<PDataArray type=\""+type+"\" Name=\""+data.Name()+"\" ";
+        if (with_components) tag += "NumberOfComponents=\""+std::to_string(data.NoComponents())+"\" ";
+        return tag+"/>\n";
+    };
+    // the piece files are referenced relative to the master file
+    const size_t slash = path_to_pvtu.find_last_of("/\\");
+    const std::string directory = (slash == std::string::npos) ? "" : path_to_pvtu.substr(0, slash+1);
+
+    std::ofstream pvtu(path_to_pvtu, std::ios::out | std::ios::binary);
+    pvtu << "<?xml version=\"1.0\" ?>" << std::endl;
+    pvtu << "<VTKFile type=\"PUnstructuredGrid\" version=\"0.1\" byte_order=\"LittleEndian\">" << std::endl;
+    pvtu << "<PUnstructuredGrid GhostLevel=\"0\">" << std::endl;
+    pvtu << "<PPoints>" << std::endl;
+    pvtu << "<PDataArray type=\"Float64\" Name=\"Coordinates\" NumberOfComponents=\"3\" />" << std::endl;
+    pvtu << "</PPoints>" << std::endl;
+    pvtu << "<PPointData>" << std::endl;
+    for (auto &data : prototype.NodeData()) pvtu << pdataarray(*data, true);
+    pvtu << "</PPointData>" << std::endl;
+    pvtu << "<PCellData>" << std::endl;
+    for (auto &data : prototype.CellData()) pvtu << pdataarray(*data, true);
+    pvtu << "</PCellData>" << std::endl;
+    for (size_t i=0; i<no_pieces; i++) pvtu << "<Piece Source=\"" << VTK_PieceFileName(path_to_pvtu, i).substr(directory.size()) << "\"/>" << std::endl;
+    pvtu << "</PUnstructuredGrid>" << std::endl;
+    pvtu << "</VTKFile>" << std::endl;
+    return pvtu.good();
+}
+
+/*
+VTK_PartitionedGrid(
+                    size_t no_pieces_   -> number of .vtu files the grid is split into
+                    )
+A grid written as a .pvtu master file and one .vtu file per piece, the pieces are written concurrently.
+Every piece is a VTK_UnstructuredGrid, either filled by the caller via piece(i) or by partition(mesh),
+which splits a grid into contiguous cell ranges.
+Example:
+    VTK_PartitionedGrid partitioned(4);
+    partitioned.setFormat(VTK_APPENDED_RAW);
+    partitioned.setNumberOfThreads(4);
+    partitioned.partition(VTKOUT);
+    partitioned.write("results/run.pvtu");
+*/
+class VTK_PartitionedGrid
+{
+    public:
+        VTK_PartitionedGrid(size_t no_pieces_)
+        : NoThreads_(1), Storage_(no_pieces_)
+        {
+            if (no_pieces_ == 0) throw std::runtime_error("Error creating the partitioned grid! At least one piece is needed.");
+            for (size_t i=0; i<no_pieces_; i++) Pieces_.emplace_back(new VTK_UnstructuredGrid());
+        }
+    public:
+        size_t NoPieces() const { return Pieces_.size(); }
+        VTK_UnstructuredGrid& piece(size_t i) { return *Pieces_.at(i); }
+        const VTK_UnstructuredGrid& piece(size_t i) const { return *Pieces_.at(i); }
+
+        // Settings of all pieces, see VTK_UnstructuredGrid
+        void setFormat(VTK_OUTPUTFORMAT format) { for (auto &grid : Pieces_) grid->setFormat(format); }
+        void setCompressor(VTK_COMPRESSOR compressor, int level = -1) { for (auto &grid : Pieces_) grid->setCompressor(compressor, level); }
+        void setPrecision(int digits) { for (auto &grid : Pieces_) grid->setPrecision(digits); }
+        void setFloat32Fields(bool float32) { for (auto &grid : Pieces_) grid->setFloat32Fields(float32); }
+        void setWriteSettings(const VTK_WriteSettings& settings) { for (auto &grid : Pieces_) grid->setWriteSettings(settings); }
+        void setFileBackend(VTK_FILEBACKEND backend) { for (auto &grid : Pieces_) grid->setFileBackend(backend); }
+
+        // Number of pieces written at the same time (1 by default)
+        void setNumberOfThreads(unsigned int no_threads) { NoThreads_ = no_threads > 0 ? no_threads : 1; }
+
+        // Splits mesh into NoPieces() contiguous cell ranges, mesh and its arrays have to outlive the pieces.
+        // Coordinates and connectivity are copied and renumbered per piece, the fields are views on the fields of mesh.
+        void partition(const VTK_UnstructuredGrid& mesh);
+
+        // Writes the pieces next to the master file, see VTK_PieceFileName(...)
+        bool write(std::string path_to_pvtu);
+    private:
+        // coordinates, connectivity and used points of a piece created by partition(...)
+        struct PieceStorage
+        {
+            std::vector<double> Points_;
+            std::vector<size_t> Connectivity_;
+            // cells of mixed types without blocks
+            std::vector<size_t> Offsets_;
+            std::vector<VTK_CELLTYPE> Types_;
+            std::shared_ptr<std::vector<size_t>> NodeIds_;
+        };
+        VTK_ThreadPool* pool()
+        {
+            const unsigned int no_threads = static_cast<unsigned int>(std::min<size_t>(NoThreads_, Pieces_.size()));
+            if (no_threads <= 1) return nullptr;
+            if (!pool_ || pool_->NoThreads() != no_threads) pool_.reset(new VTK_ThreadPool(no_threads));
+            return pool_.get();
+        }
+    private:
+        unsigned int NoThreads_;
+        std::vector<std::unique_ptr<VTK_UnstructuredGrid>> Pieces_;
+        std::vector<PieceStorage> Storage_;
+        std::unique_ptr<VTK_ThreadPool> pool_;
+};
+
+inline void VTK_PartitionedGrid::partition(const VTK_UnstructuredGrid& mesh)
+{
+    if (mesh.Points() == nullptr || mesh.Connectivity() == nullptr) throw std::runtime_error("Error partitioning the grid! Call setPoints(...) and setElements(...) first");
+    if (mesh.Faces() != nullptr) throw std::runtime_error("Error partitioning the grid! Polyhedra are not supported.");
+    const VTK_Array& points = *mesh.Points();
+    const VTK_Array& connectivity = *mesh.Connectivity();
+    const VTK_CellOffsetArray& offsets = *mesh.Offsets();
+    const VTK_CellTypeArray& types = *mesh.Types();
+    const size_t no_pieces = Pieces_.size();
+
+    VTK_ParallelFor(pool(), no_pieces, [&](size_t p)
+    {
+        const size_t first = p*mesh.NoCells()/no_pieces;
+        const size_t no_cells = (p+1)*mesh.NoCells()/no_pieces-first;
+        PieceStorage& storage = Storage_[p];
+        VTK_UnstructuredGrid& grid = *Pieces_[p];
+
+        // used points of the cell range, sorted to keep the order of the source grid
+        const size_t first_node = (first == 0) ? 0 : offsets.offset(first-1);
+        const size_t no_nodes = (no_cells == 0) ? 0 : offsets.offset(first+no_cells-1)-first_node;
+        storage.Connectivity_.resize(no_nodes);
+        connectivity.gatherBytes(first_node*sizeof(size_t), no_nodes*sizeof(size_t), reinterpret_cast<char*>(storage.Connectivity_.data()));
+        auto node_ids = std::make_shared<std::vector<size_t>>(storage.Connectivity_);
+        std::sort(node_ids->begin(), node_ids->end());
+        node_ids->erase(std::unique(node_ids->begin(), node_ids->end()), node_ids->end());
+        for (auto &node : storage.Connectivity_) node = std::lower_bound(node_ids->begin(), node_ids->end(), node)-node_ids->begin();
+        storage.NodeIds_ = node_ids;
+
+        storage.Points_.resize(3*node_ids->size());
+        VTK_IndexedArray(points, node_ids).gather(0, node_ids->size(), reinterpret_cast<char*>(storage.Points_.data()));
+
+        grid.clearData();
+        grid.setPoints(storage.Points_);
+        if (types.Blocked()) grid.setElements(storage.Connectivity_, types.blocks(first, no_cells));
+        else
+        {
+            storage.Offsets_.resize(no_cells+1);
+            storage.Types_.resize(no_cells);
+            storage.Offsets_[0] = 0;
+            for (size_t i=0; i<no_cells; i++)
+            {
+                storage.Offsets_[i+1] = offsets.offset(first+i)-first_node;
+                storage.Types_[i] = types.type(first+i);
+            }
+            grid.setElements(storage.Connectivity_, storage.Offsets_, storage.Types_);
+        }
+        for (auto &data : mesh.NodeData()) grid.addNodeData(new VTK_IndexedArray(*data, node_ids));
+        for (auto &data : mesh.CellData()) grid.addCellData(new VTK_IndexedArray(*data, first, no_cells));
+    });
+}
+
+inline bool VTK_PartitionedGrid::write(std::string path_to_pvtu)
+{
+    // all pieces have to provide the same fields for the master file
+    const VTK_UnstructuredGrid& prototype = *Pieces_[0];
+    for (auto &grid : Pieces_)
+    {
+        bool match = grid->NodeData().size() == prototype.NodeData().size() && grid->CellData().size() == prototype.CellData().size();
+        for (size_t i=0; match && i<prototype.NodeData().size(); i++)
+            match = grid->NodeData()[i]->Name() == prototype.NodeData()[i]->Name() && grid->NodeData()[i]->Type() == prototype.NodeData()[i]->Type() && grid->NodeData()[i]->NoComponents() == prototype.NodeData()[i]->NoComponents();
+        for (size_t i=0; match && i<prototype.CellData().size(); i++)
+            match = grid->CellData()[i]->Name() == prototype.CellData()[i]->Name() && grid->CellData()[i]->Type() == prototype.CellData()[i]->Type() && grid->CellData()[i]->NoComponents() == prototype.CellData()[i]->NoComponents();
+        if (!match) throw std::runtime_error("Error writing "+path_to_pvtu+"! The pieces do not provide the same NodeData and CellData.");
+    }
+
+    std::vector<char> good(Pieces_.size(), false);
+    VTK_ParallelFor(pool(), Pieces_.size(), [&](size_t p){ good[p] = Pieces_[p]->write(VTK_PieceFileName(path_to_pvtu, p)); });
+    if (std::find(good.begin(), good.end(), false) != good.end()) return false;
+    return VTK_WritePVTU(path_to_pvtu, Pieces_.size(), prototype);
+}
@@ -0,0 +1,356 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <ostream>
+#include <functional>
+#include <cstring>
+#include <chrono>
+
+#include "vtk_definitions.hpp"
+#include "vtk_array.hpp"
+#include "vtk_asciiformatter.hpp"
+#include "vtk_base64.hpp"
+#include "vtk_compression.hpp"
+#include "vtk_threadpool.hpp"
+#include "vtk_statistics.hpp"
+#include "vtk_sink.hpp"
+
+// Number of values formatted per ascii piece
+constexpr size_t VTK_ASCII_CHUNK_VALUES = 1 << 16;
+// Number of bytes gathered per raw piece
+constexpr size_t VTK_RAW_CHUNK_BYTES = 1 << 20;
+// Number of bytes encoded per base64 piece (multiple of 3, so the pieces encode independently)
+constexpr size_t VTK_BASE64_CHUNK_BYTES = 3 << 18;
+// Size of a task which is only known after encoding
+constexpr size_t VTK_UNKNOWN_SIZE = ~size_t(0);
+
+/*
+One piece of the output file, either
+literal -> bytes owned by the piece (xml structure, headers)
+view    -> memory which is written as it is (continuous arrays, compressed blocks)
+task    -> encode(...) fills the buffer of the piece (formatted ascii, gathered or base64 encoded ranges)
+array is the index of the DataArray the piece belongs to (-1 for the xml structure), only used for statistics.
+*/
+struct VTK_OutputPiece
+{
+    const char* data = nullptr;
+    size_t size = 0;
+    std::vector<char> buffer;
+    std::function<void(std::vector<char>&)> encode;
+    size_t encoded_size = 0;
+    bool known_size = true;
+    int array = -1;
+    double encode_seconds = 0.0;
+};
+
+/*
+VTK_PieceList
+The output file as an ordered list of pieces.
+write(...) runs the encoding tasks in windows on the thread pool and writes the pieces strictly in order,
+therefore the output is byte identical for any number of threads. At most a window of encoded pieces is held in memory,
+the memory of the views (e.g. compressed blocks) belongs to the caller.
+Example:
+    VTK_PieceList pieces;
+    pieces.text("<Points>\n");
+    VTK_AddAsciiArray(pieces, coordinates, true, 0);
+    pieces.text("</Points>\n");
+    pieces.write(outfile, &pool);
+*/
+class VTK_PieceList
+{
+    public:
+        // Appends literal text, consecutive literals are merged
+        void text(const std::string& str) { bytes(str.data(), str.size()); }
+        void bytes(const char* data, size_t size)
+        {
+            if (Pieces_.empty() || Pieces_.back().data != nullptr || Pieces_.back().encode || Pieces_.back().array != Array_) emplace();
+            Pieces_.back().buffer.insert(Pieces_.back().buffer.end(), data, data+size);
+        }
+        // Appends memory which has to stay alive until write(...) returns
+        void view(const char* data, size_t size)
+        {
+            if (size == 0) return;
+            emplace();
+            Pieces_.back().data = data;
+            Pieces_.back().size = size;
+        }
+        // Appends a piece which is encoded during write(...), size is the number of encoded bytes if known in advance
+        void task(std::function<void(std::vector<char>&)> encode, size_t size = VTK_UNKNOWN_SIZE)
+        {
+            emplace();
+            Pieces_.back().encode = std::move(encode);
+            Pieces_.back().encoded_size = size;
+            Pieces_.back().known_size = (size != VTK_UNKNOWN_SIZE);
+        }
+        // The following pieces belong to DataArray array (-1: xml structure), see write(..., statistics)
+        void setArray(int array) { Array_ = array; }
+        size_t NoPieces() const { return Pieces_.size(); }
+        // Size of the output, VTK_UNKNOWN_SIZE if a task does not know its size (ascii)
+        size_t ByteSize() const
+        {
+            size_t size = 0;
+            for (auto &piece : Pieces_)
+            {
+                if (!piece.known_size) return VTK_UNKNOWN_SIZE;
+                size += piece.encode ? piece.encoded_size : (piece.data != nullptr) ? piece.size : piece.buffer.size();
+            }
+            return size;
+        }
+
+        bool write(std::ostream& OUTFILE, VTK_ThreadPool* pool) { return write(OUTFILE, pool, nullptr); }
+        bool write(std::vector<char>& out, VTK_ThreadPool* pool) { return write(out, pool, nullptr); }
+
+        // statistics -> if not nullptr, the encoded bytes and the encode and write times of the pieces are added to
+        //               statistics->arrays[piece.array], the pieces of the xml structure only to the totals
+        bool write(std::ostream& OUTFILE, VTK_ThreadPool* pool, VTK_WriteStatistics* statistics)
+        {
+            return flush(pool, statistics, [&OUTFILE](const char* data, size_t size)
+            {
+                OUTFILE.write(data, size);
+                return OUTFILE.good();
+            });
+        }
+        // Writes to a sink, the size is reserved if it is known, failures of the sink throw
+        bool write(VTK_Sink& sink, VTK_ThreadPool* pool, VTK_WriteStatistics* statistics = nullptr)
+        {
+            const size_t size = ByteSize();
+            if (size != VTK_UNKNOWN_SIZE) sink.reserve(size);
+            return flush(pool, statistics, [&sink](const char* data, size_t size)
+            {
+                sink.write(data, size);
+                return true;
+            });
+        }
+        // Collects the output in memory
+        bool write(std::vector<char>& out, VTK_ThreadPool* pool, VTK_WriteStatistics* statistics)
+        {
+            return flush(pool, statistics, [&out](const char* data, size_t size)
+            {
+                out.insert(out.end(), data, data+size);
+                return true;
+            });
+        }
+    private:
+        void emplace()
+        {
+            Pieces_.emplace_back();
+            Pieces_.back().array = Array_;
+        }
+        template <typename Output>
+        bool flush(VTK_ThreadPool* pool, VTK_WriteStatistics* statistics, Output&& output)
+        {
+            // the timed variant is a separate instantiation, the plain write does not pay for the clock
+            if (statistics != nullptr) return flush<true>(pool, statistics, output);
+            return flush<false>(pool, statistics, output);
+        }
+        template <bool Timed, typename Output>
+        bool flush(VTK_ThreadPool* pool, VTK_WriteStatistics* statistics, Output& output)
+        {
+            using clock = std::chrono::steady_clock;
+            const size_t window = (pool != nullptr) ? 4*pool->NoThreads() : 1;
+            std::vector<size_t> tasks;
+            size_t first = 0;
+            while (first < Pieces_.size())
+            {
+                // collect the next window of encoding tasks
+                size_t last = first;
+                tasks.clear();
+                while (last < Pieces_.size() && tasks.size() < window)
+                {
+                    if (Pieces_[last].encode) tasks.push_back(last);
+                    last++;
+                }
+                VTK_ParallelFor(pool, tasks.size(), [&](size_t t)
+                {
+                    VTK_OutputPiece& piece = Pieces_[tasks[t]];
+                    if constexpr (Timed)
+                    {
+                        const auto start = clock::now();
+                        piece.encode(piece.buffer);
+                        piece.encode_seconds = std::chrono::duration<double>(clock::now()-start).count();
+                    }
+                    else piece.encode(piece.buffer);
+                });
+                for (size_t i=first; i<last; i++)
+                {
+                    VTK_OutputPiece& piece = Pieces_[i];
+                    const char* data = (piece.data != nullptr) ? piece.data : piece.buffer.data();
+                    const size_t size = (piece.data != nullptr) ? piece.size : piece.buffer.size();
+                    bool good;
+                    if constexpr (Timed)
+                    {
+                        const auto start = clock::now();
+                        good = output(data, size);
+                        const double seconds = std::chrono::duration<double>(clock::now()-start).count();
+                        statistics->file_bytes += size;
+                        statistics->encode_seconds += piece.encode_seconds;
+                        statistics->write_seconds += seconds;
+                        if (piece.array >= 0 && static_cast<size_t>(piece.array) < statistics->arrays.size())
+                        {
+                            VTK_ArrayStatistics& array = statistics->arrays[piece.array];
+                            array.encoded_bytes += size;
+                            array.encode_seconds += piece.encode_seconds;
+                            array.write_seconds += seconds;
+                        }
+                    }
+                    else good = output(data, size);
+                    std::vector<char>().swap(piece.buffer);
+                    if (!good) return false;
+                }
+                first = last;
+            }
+            return true;
+        }
+    private:
+        std::vector<VTK_OutputPiece> Pieces_;
+        int Array_ = -1;
+};
+
+// Opening tag of a DataArray, the format specific attributes and the closing of the tag are up to the caller
+inline std::string VTK_DataArrayTag(const VTK_Array& data, const std::string& format, bool with_components)
+{
+    std::string tag = "<DataArray Name=\""+data.Name()+"\" ";
+    if (with_components) tag += "NumberOfComponents=\""+std::to_string(data.NoComponents())+"\" ";
+    return tag+"format=\""+format+"\" type=\""+data.Type()+"\" "+data.Attributes();
+}
+
+// Byte count header of the uncompressed binary blocks
+inline std::string VTK_BlockHeader(size_t nbytes, bool uint64_header)
+{
+    if (!uint64_header && nbytes > UINT32_MAX) throw std::runtime_error("Error writing DataArray! Size exceeds the UInt32 header.");
+    const uint64_t header64 = nbytes;
+    const uint32_t header32 = static_cast<uint32_t>(nbytes);
+    return uint64_header ? std::string(reinterpret_cast<const char*>(&header64), sizeof(header64))
+                         : std::string(reinterpret_cast<const char*>(&header32), sizeof(header32));
+}
+
+// Adds an ascii DataArray, the values are formatted in ranges of VTK_ASCII_CHUNK_VALUES
+inline void VTK_AddAsciiArray(VTK_PieceList& pieces, const VTK_Array& data, bool with_components, int precision)
+{
+    pieces.text(VTK_DataArrayTag(data, "ascii", with_components)+">");
+    const size_t chunk = std::max<size_t>(1, VTK_ASCII_CHUNK_VALUES/std::max<size_t>(1, data.NoComponents()));
+    for (size_t first=0; first<data.NoEntities(); first+=chunk)
+    {
+        const size_t n = std::min(chunk, data.NoEntities()-first);
+        pieces.task([&data, first, n, precision](std::vector<char>& buffer)
+        {
+            VTK_AsciiFormatter formatter(precision, 24*n*data.NoComponents());
+            data.format(formatter, first, n);
+            formatter.release(buffer);
+        });
+    }
+    pieces.text("</DataArray>\n");
+}
+
+// Adds an inline base64 DataArray
+// uncompressed -> one base64 stream of byte count header and values, encoded in ranges of VTK_BASE64_CHUNK_BYTES
+// compressed   -> the compression header and the blocks are two separate base64 streams
+inline void VTK_AddBinaryArray(VTK_PieceList& pieces, const VTK_Array& data, bool with_components, bool uint64_header, const VTK_CompressedArray* compressed)
+{
+    pieces.text(VTK_DataArrayTag(data, "binary", with_components)+">");
+    if (compressed != nullptr)
+    {
+        std::string header(VTK_Base64Length(compressed->header.size()), ' ');
+        VTK_Base64Encode(compressed->header.data(), compressed->header.size(), &header[0]);
+        pieces.text(header);
+        pieces.task([compressed](std::vector<char>& buffer)
+        {
+            size_t size = 0;
+            for (auto &block : compressed->blocks) size += block.size();
+            std::vector<char> bytes;
+            bytes.reserve(size);
+            for (auto &block : compressed->blocks) bytes.insert(bytes.end(), block.begin(), block.end());
+            buffer.resize(VTK_Base64Length(size));
+            VTK_Base64Encode(bytes.data(), size, buffer.data());
+        }, VTK_Base64Length(compressed->ByteSize()-compressed->header.size()));
+    }
+    else
+    {
+        const std::string header = VTK_BlockHeader(data.ByteSize(), uint64_header);
+        const size_t total = header.size()+data.ByteSize();
+        for (size_t first=0; first<total; first+=VTK_BASE64_CHUNK_BYTES)
+        {
+            const size_t n = std::min(VTK_BASE64_CHUNK_BYTES, total-first);
+            pieces.task([&data, header, first, n](std::vector<char>& buffer)
+            {
+                // bytes [first, first+n) of the stream header+values
+                std::vector<char> bytes(n);
+                size_t from_header = 0;
+                if (first < header.size())
+                {
+                    from_header = std::min(n, header.size()-first);
+                    std::memcpy(bytes.data(), header.data()+first, from_header);
+                }
+                const size_t first_value = first+from_header-header.size();
+                data.gatherBytes(first_value, n-from_header, bytes.data()+from_header);
+                buffer.resize(VTK_Base64Length(n));
+                VTK_Base64Encode(bytes.data(), n, buffer.data());
+            }, VTK_Base64Length(n));
+        }
+    }
+    pieces.text("</DataArray>\n");
+}
+
+/*
+The uncompressed blocks of the <AppendedData> section are padded to multiples of VTK_APPENDED_ALIGNMENT bytes and the section starts
+such that the values behind the byte count header of the first block are aligned in the file. A reader can therefore view the values
+of any type in the mapped file (see VTK_Reader), the padding is skipped by the offsets of the DataArray tags.
+*/
+constexpr size_t VTK_APPENDED_ALIGNMENT = 8;
+
+// Number of bytes which pad size to a multiple of VTK_APPENDED_ALIGNMENT
+inline size_t VTK_AppendedPadding(size_t size) { return (VTK_APPENDED_ALIGNMENT-size%VTK_APPENDED_ALIGNMENT)%VTK_APPENDED_ALIGNMENT; }
+
+// Opening of the <AppendedData> section which follows the first position bytes of the file, the raw data starts right after the underscore
+inline std::string VTK_AppendedDataStart(size_t position, bool uint64_header)
+{
+    const std::string start = "<AppendedData encoding=\"raw\">\n";
+    const size_t header_bytes = uint64_header ? sizeof(uint64_t) : sizeof(uint32_t);
+    return start+std::string(VTK_AppendedPadding(position+start.size()+1+header_bytes), ' ')+"_";
+}
+
+// Size of the block of an array in the <AppendedData> section, see VTK_AddAppendedArray(...)
+inline size_t VTK_AppendedByteSize(const VTK_Array& data, bool uint64_header, const VTK_CompressedArray* compressed)
+{
+    if (compressed != nullptr) return compressed->ByteSize();
+    const size_t size = (uint64_header ? sizeof(uint64_t) : sizeof(uint32_t))+data.ByteSize();
+    return size+VTK_AppendedPadding(size);
+}
+
+// Adds the DataArray tag which points to offset inside of the <AppendedData> section
+inline void VTK_AddAppendedTag(VTK_PieceList& pieces, const VTK_Array& data, bool with_components, size_t offset)
+{
+    pieces.text(VTK_DataArrayTag(data, "appended", with_components)+"offset=\""+std::to_string(offset)+"\" />\n");
+}
+
+// Adds the block of an array to the <AppendedData> section, uncompressed blocks are padded to VTK_APPENDED_ALIGNMENT.
+// Continuous data and compressed blocks are written without copy, strided data is gathered in ranges of VTK_RAW_CHUNK_BYTES.
+inline void VTK_AddAppendedArray(VTK_PieceList& pieces, const VTK_Array& data, bool uint64_header, const VTK_CompressedArray* compressed)
+{
+    if (compressed != nullptr)
+    {
+        pieces.view(compressed->header.data(), compressed->header.size());
+        for (auto &block : compressed->blocks) pieces.view(block.data(), block.size());
+        return;
+    }
+    const std::string header = VTK_BlockHeader(data.ByteSize(), uint64_header);
+    pieces.text(header);
+    const size_t entity_bytes = data.NoComponents()*data.ValueSize();
+    if (const char* raw = data.ContiguousData()) pieces.view(raw, data.ByteSize());
+    else if (entity_bytes > 0)
+    {
+        const size_t chunk = std::max<size_t>(1, VTK_RAW_CHUNK_BYTES/entity_bytes);
+        for (size_t first=0; first<data.NoEntities(); first+=chunk)
+        {
+            const size_t n = std::min(chunk, data.NoEntities()-first);
+            pieces.task([&data, first, n, entity_bytes](std::vector<char>& buffer)
+            {
+                buffer.resize(n*entity_bytes);
+                data.gather(first, n, buffer.data());
+            }, n*entity_bytes);
+        }
+    }
+    const std::string padding(VTK_AppendedPadding(header.size()+data.ByteSize()), '\0');
+    if (!padding.empty()) pieces.text(padding);
+}
@@ -0,0 +1,89 @@
+#pragma once
+
+#include <memory>
+
+#include <vtk_array.hpp>
+#include <vtk_cells.hpp>
+#include <vtk_dataset.hpp>
+
+/*
+Polygonal surface written as .vtp: points and polygons, e.g. the boundary of a volume grid, see VTK_UnstructuredGrid::Surface() and writeSurface(...).
+As VTK_DataArray the points and polygons are viewed, the buffers have to stay alive until the surface is written.
+Fields are added as for VTK_UnstructuredGrid, the cell data holds one value per polygon.
+Example:
+    VTK_PolyData VTKOUT;
+    VTKOUT.setPoints(XI);
+    VTKOUT.setPolygons(connectivity, offsets);
+    VTKOUT.addCellData("Pressure", Pressure, 1);
+    VTKOUT.write("results/surface.vtp");
+*/
+class VTK_PolyData : public VTK_DataSet
+{
+    public:
+        VTK_PolyData() : NoPoints_(0), NoPolygons_(0) {}
+    private:
+        std::unique_ptr<VTK_Array> PointCoordinates_;
+        std::unique_ptr<VTK_DataArray<size_t>> Connectivity_;
+        std::unique_ptr<VTK_CellOffsetArray> Offsets_;
+    public:
+        // Set points via VTK_DataArray interface
+        bool setPoints(const double* data_start_, std::array<size_t, 2> shape_, std::array<size_t, 2> strides_)
+        {
+            if (shape_[1] != 3) throw std::runtime_error("Error reading Point data! Wrong dimensions. Check your components input, got: "+std::to_string(shape_[1]));
+            return setPoints(new VTK_DataArray("Coordinates", data_start_, shape_, strides_));
+        }
+
+        // convenience overload for n-nodal coordinates inside a vector XI = {x1, y1, z1, ...,xn, yn, zn}
+        bool setPoints(const std::vector<double> &XI) { return setPoints(XI.data(), {XI.size()/3, 3}, {sizeof(double)*3, sizeof(double)}); }
+
+        // Set points given by any 3 component VTK_Array, e.g. a VTK_IndexedArray of the points of a volume grid, the poly data takes the ownership
+        bool setPoints(VTK_Array* points);
+
+        // Set the polygons in CSR format: the nodes of polygon i are connectivity[offsets[i]..offsets[i+1]), offsets starts with 0
+        bool setPolygons(const std::vector<size_t> &connectivity, const std::vector<size_t> &offsets);
+
+        size_t NoPoints() const {return NoPoints_;}
+        size_t NoCells() const {return NoPolygons_;}
+    private:
+        bool writeSink(VTK_Sink& sink, VTK_WriteStatistics* statistics);
+        bool PointsSet() const {return PointCoordinates_ != nullptr;}
+        bool CellsSet() const {return Offsets_ != nullptr;}
+    private:
+        size_t NoPoints_, NoPolygons_;
+};
+
+inline bool VTK_PolyData::setPoints(VTK_Array* points)
+{
+    std::unique_ptr<VTK_Array> owned(points);
+    if (points->NoComponents() != 3) throw std::runtime_error("Error reading Point data! Wrong dimensions. Check your components input, got: "+std::to_string(points->NoComponents()));
+    PointCoordinates_ = std::move(owned);
+    NoPoints_ = points->NoEntities();
+    Connectivity_.reset();
+    Offsets_.reset();
+    NoPolygons_ = 0;
+    return true;
+}
+
+inline bool VTK_PolyData::setPolygons(const std::vector<size_t> &connectivity, const std::vector<size_t> &offsets)
+{
+    if (!PointsSet()) throw std::runtime_error("Error reading Polygons! Call setPoints(...) first");
+    if (offsets.empty() || offsets[0] != 0 || offsets.back() != connectivity.size()) throw std::runtime_error("Error reading Polygons! Expected offsets from 0 to the size of the connectivity.");
+    NoPolygons_ = offsets.size()-1;
+    Connectivity_.reset(new VTK_DataArray<size_t>("connectivity", connectivity.data(), {connectivity.size(), 1}, {sizeof(size_t), sizeof(size_t)}));
+    Offsets_.reset(new VTK_CellOffsetArray(offsets.data(), NoPolygons_));
+    return true;
+}
+
+inline bool VTK_PolyData::writeSink(VTK_Sink& sink, VTK_WriteStatistics* statistics)
+{
+    if (!CellsSet()) throw std::runtime_error("Error writing the surface! Call setPoints(...) and setPolygons(...) first");
+    // the connectivity is UInt32 if all point indices fit, Int64 otherwise
+    std::unique_ptr<VTK_Array> connectivity;
+    if (NoPoints_ <= size_t(UINT32_MAX)+1) connectivity.reset(new VTK_ConvertedArray<size_t, uint32_t>(*Connectivity_));
+    else connectivity.reset(new VTK_ConvertedArray<size_t, int64_t>(*Connectivity_));
+
+    const VTK_DataSetLayout layout = {"PolyData", "", "NumberOfPoints=\""+std::to_string(NoPoints_)+"\" NumberOfVerts=\"0\" NumberOfLines=\"0\" NumberOfStrips=\"0\" NumberOfPolys=\""+std::to_string(NoPolygons_)+"\"",
+                                      {{"Points", 1, true}, {"Polys", 2, false}}};
+    const std::vector<const VTK_Array*> node_data(NodeData_.begin(), NodeData_.end()), cell_data(CellData_.begin(), CellData_.end());
+    return VTK_WriteDataSet(sink, settings_, layout, {PointCoordinates_.get(), connectivity.get(), Offsets_.get()}, nullptr, node_data, cell_data, pool(), statistics);
+}
@@ -0,0 +1,338 @@
+#pragma once
+
+#include <cmath>
+#include <cstring>
+#include <cstdint>
+#include <limits>
+#include <vector>
+#include <memory>
+#include <sstream>
+#include <iomanip>
+#include <algorithm>
+#include <stdexcept>
+
+#include <vtk_array.hpp>
+#include <vtk_threadpool.hpp>
+
+/*
+Error bounded lossy output of Float64 and Float32 fields, see VTK_DataSet::setErrorBound(...).
+The kernels work on packed values in plain loops without calls, the selects are integer masks instead of branches
+or floating point comparisons, so the compiler vectorizes them with plain SSE2 (-O3, the Release default)
+and the encoding stays as fast as the copy of the values.
+*/
+
+// Unsigned integer of the same size and number of explicit mantissa bits of the IEEE formats
+template <typename T>
+struct VTK_FloatBits;
+template <>
+struct VTK_FloatBits<double> { typedef uint64_t type; static constexpr int mantissa = 52; };
+template <>
+struct VTK_FloatBits<float> { typedef uint32_t type; static constexpr int mantissa = 23; };
+
+// Smallest number of explicit mantissa bits whose rounding keeps the relative error within bound
+template <typename T>
+inline int VTK_MantissaBits(double bound)
+{
+    int bits = 0;
+    while (bits < VTK_FloatBits<T>::mantissa && std::ldexp(1.0, -(bits+1)) > bound) bits++;
+    return bits;
+}
+
+// Largest power of two step whose rounding keeps the absolute error within bound, 0 if it is below the normal numbers of T
+template <typename T>
+inline T VTK_QuantizationStep(double bound)
+{
+    const double step = std::ldexp(1.0, std::ilogb(2*bound));
+    return (step < double(std::numeric_limits<T>::min()) || step > double(std::numeric_limits<T>::max())) ? T(0) : static_cast<T>(step);
+}
+
+// Values per block of the kernels, the bit patterns of a block are processed on the stack
+constexpr size_t VTK_KERNEL_BLOCK = 256;
+
+// Rounds the values to bits explicit mantissa bits, ties away from zero, the relative error is at most 2^-(bits+1).
+// Zeros, subnormals, infinities and NaN are kept, as are the values which would round to infinity.
+template <typename T>
+inline void VTK_RoundMantissa(T* values, size_t n, int bits)
+{
+    typedef typename VTK_FloatBits<T>::type U;
+    constexpr int M = VTK_FloatBits<T>::mantissa, W = 8*sizeof(U)-1;
+    if (bits >= M) return;
+    const U exponent = ((U(1) << (W-M))-1) << M;
+    const U half = U(1) << (M-bits-1);
+    const U mask = ~((U(1) << (M-bits))-1);
+    U block[VTK_KERNEL_BLOCK];
+    for (size_t first=0; first<n; first+=VTK_KERNEL_BLOCK)
+    {
+        const size_t m = std::min(VTK_KERNEL_BLOCK, n-first);
+        std::memcpy(block, values+first, m*sizeof(T));
+        for (size_t i=0; i<m; i++)
+        {
+            // the top bit of x-1 is set for x == 0 only, keep is all ones for a zero or maximal exponent
+            const U value = block[i], rounded = (value+half) & mask;
+            const U keep = U(0)-((((value & exponent)-1) | (((value & exponent)^exponent)-1) | (((rounded & exponent)^exponent)-1)) >> W);
+            block[i] = (value & keep) | (rounded & ~keep);
+        }
+        std::memcpy(values+first, block, m*sizeof(T));
+    }
+}
+
+// Rounds the values to the nearest multiple of step, a power of two, the absolute error is at most step/2.
+// Values from 2^(mantissa-1) steps on are exact multiples already and kept, as are infinities and NaN.
+template <typename T>
+inline void VTK_RoundToStep(T* values, size_t n, T step)
+{
+    typedef typename VTK_FloatBits<T>::type U;
+    constexpr int M = VTK_FloatBits<T>::mantissa, W = 8*sizeof(U)-1;
+    // adding and subtracting 1.5*2^M rounds to the nearest integer in the default rounding mode
+    const T magic = std::ldexp(T(1.5), M), limit = std::ldexp(T(1), M-1), inverse = T(1)/step;
+    const U magnitude = ~(U(1) << W);
+    U limit_bits;
+    std::memcpy(&limit_bits, &limit, sizeof(T));
+    T rounded[VTK_KERNEL_BLOCK];
+    U steps_bits[VTK_KERNEL_BLOCK], rounded_bits[VTK_KERNEL_BLOCK], value_bits[VTK_KERNEL_BLOCK];
+    for (size_t first=0; first<n; first+=VTK_KERNEL_BLOCK)
+    {
+        const size_t m = std::min(VTK_KERNEL_BLOCK, n-first);
+        for (size_t i=0; i<m; i++) rounded[i] = values[first+i]*inverse;
+        std::memcpy(steps_bits, rounded, m*sizeof(T));
+        for (size_t i=0; i<m; i++) rounded[i] = ((rounded[i]+magic)-magic)*step;
+        std::memcpy(rounded_bits, rounded, m*sizeof(T));
+        std::memcpy(value_bits, values+first, m*sizeof(T));
+        for (size_t i=0; i<m; i++)
+        {
+            // the integer select instead of a floating point comparison, within is all ones if |steps| < limit
+            const U within = U(0)-(((steps_bits[i] & magnitude)-limit_bits) >> W);
+            value_bits[i] = (rounded_bits[i] & within) | (value_bits[i] & ~within);
+        }
+        std::memcpy(values+first, value_bits, m*sizeof(T));
+    }
+}
+
+// Steps k of the values with value = (first+k)*step within step/2, the values have to lie in the range checked by VTK_QuantizedArray
+template <typename T>
+inline void VTK_QuantizeToStep(const T* values, size_t n, double step, double first, uint32_t* steps)
+{
+    const double magic = std::ldexp(1.5, 52), inverse = 1.0/step;
+    for (size_t i=0; i<n; i++) steps[i] = static_cast<uint32_t>(((double(values[i])*inverse+magic)-magic)-first);
+}
+
+/*
+VTK_RoundedArray<T>(
+                    const VTK_Array& source_,      -> Float64 (T=double) or Float32 (T=float) array, has to outlive the view
+                    VTK_ERRORBOUND mode_,          -> VTK_ABSOLUTE_ERROR or VTK_RELATIVE_ERROR
+                    double bound_                  -> the error bound, > 0
+                    )
+View which rounds the values within the error bound while writing, the type is kept (VTK_ROUNDED_VALUES).
+relative -> the values keep VTK_MantissaBits(bound) explicit mantissa bits
+absolute -> the values are rounded to multiples of VTK_QuantizationStep(bound)
+The values are rounded in ranges of RoundingEntities.
+*/
+template <typename T>
+class VTK_RoundedArray : public VTK_Array
+{
+    private:
+        const VTK_Array& Source_;
+        VTK_ERRORBOUND Mode_;
+        int Bits_;
+        T Step_;
+        static constexpr size_t RoundingEntities = 1 << 12;
+    public:
+        VTK_RoundedArray(const VTK_Array& source_, VTK_ERRORBOUND mode_, double bound_)
+        : Source_(source_), Mode_(mode_), Bits_(VTK_MantissaBits<T>(bound_)), Step_(VTK_QuantizationStep<T>(bound_))
+        {
+            if (source_.Type() != VTKType(T()) || source_.ValueSize() != sizeof(T)) throw std::runtime_error("Error rounding DataArray "+source_.Name()+"! Expected type "+VTKType(T())+", got "+source_.Type());
+            if (mode_ == VTK_LOSSLESS || !(bound_ > 0)) throw std::runtime_error("Error rounding DataArray "+source_.Name()+"! The error bound has to be positive.");
+        }
+    public:
+        std::string Name() const {return Source_.Name();}
+        std::string Type() const {return Source_.Type();}
+        size_t NoComponents() const {return Source_.NoComponents();}
+        size_t NoEntities() const {return Source_.NoEntities();}
+        size_t ValueSize() const {return sizeof(T);}
+        void print() const
+        {
+            VTK_AsciiFormatter formatter;
+            formatter.attach(&std::cout);
+            format(formatter, 0, NoEntities());
+            formatter.text("\n");
+            formatter.flush();
+        }
+        void gather(size_t first_entity, size_t no_entities, char* buffer) const
+        {
+            // an aligned buffer is rounded in place, otherwise through a range buffer
+            if (reinterpret_cast<std::uintptr_t>(buffer) % alignof(T) == 0)
+            {
+                Source_.gather(first_entity, no_entities, buffer);
+                round(reinterpret_cast<T*>(buffer), no_entities*NoComponents());
+                return;
+            }
+            rounded(first_entity, no_entities, [&buffer](const T* values, size_t n)
+            {
+                std::memcpy(buffer, values, n*sizeof(T));
+                buffer += n*sizeof(T);
+            });
+        }
+        void format(VTK_AsciiFormatter& formatter, size_t first_entity, size_t no_entities) const
+        {
+            rounded(first_entity, no_entities, [&formatter](const T* values, size_t n){ for (size_t i=0; i<n; i++) formatter.value(values[i]); });
+        }
+    private:
+        void round(T* values, size_t n) const
+        {
+            if (Mode_ == VTK_RELATIVE_ERROR) VTK_RoundMantissa(values, n, Bits_);
+            else if (Step_ > 0) VTK_RoundToStep(values, n, Step_);
+        }
+        // calls f(values, n) for the rounded values of consecutive ranges of [first_entity, first_entity+no_entities)
+        template <typename F>
+        void rounded(size_t first_entity, size_t no_entities, F&& f) const
+        {
+            thread_local std::vector<T> values;
+            const size_t m = NoComponents();
+            for (size_t first=first_entity; first<first_entity+no_entities; first+=RoundingEntities)
+            {
+                const size_t n = std::min(RoundingEntities, first_entity+no_entities-first);
+                values.resize(n*m);
+                Source_.gather(first, n, reinterpret_cast<char*>(values.data()));
+                round(values.data(), n*m);
+                f(values.data(), n*m);
+            }
+        }
+};
+
+/*
+VTK_QuantizedArray<T>(
+                      const VTK_Array& source_,    -> Float64 (T=double) or Float32 (T=float) array, has to outlive the view
+                      double bound_,               -> absolute error bound, > 0
+                      VTK_ThreadPool* pool_        -> scans the range of the values in parallel if not nullptr
+                      )
+View which writes the values as UInt32 steps of VTK_QuantizationStep(bound) (VTK_QUANTIZED_INTEGERS),
+value = QuantizationOffset+k*QuantizationScale is within the bound and exact in double precision.
+The range of the values is scanned once on construction, it must be finite and span at most 2^32-1 steps.
+*/
+template <typename T>
+class VTK_QuantizedArray : public VTK_Array
+{
+    private:
+        const VTK_Array& Source_;
+        double Step_, First_ = 0;
+        static constexpr size_t QuantizationEntities = 1 << 12;
+    public:
+        VTK_QuantizedArray(const VTK_Array& source_, double bound_, VTK_ThreadPool* pool_ = nullptr)
+        : Source_(source_), Step_(VTK_QuantizationStep<double>(bound_))
+        {
+            if (source_.Type() != VTKType(T()) || source_.ValueSize() != sizeof(T)) throw std::runtime_error("Error quantizing DataArray "+source_.Name()+"! Expected type "+VTKType(T())+", got "+source_.Type());
+            if (!(bound_ > 0) || Step_ == 0) throw std::runtime_error("Error quantizing DataArray "+source_.Name()+"! The error bound has to be positive.");
+            scan(pool_);
+        }
+    public:
+        std::string Name() const {return Source_.Name();}
+        std::string Type() const {return VTKType(uint32_t());}
+        size_t NoComponents() const {return Source_.NoComponents();}
+        size_t NoEntities() const {return Source_.NoEntities();}
+        size_t ValueSize() const {return sizeof(uint32_t);}
+        std::string Attributes() const
+        {
+            std::ostringstream attributes;
+            attributes << std::setprecision(17) << "QuantizationScale=\"" << Step_ << "\" QuantizationOffset=\"" << First_*Step_ << "\" ";
+            return attributes.str();
+        }
+        void print() const
+        {
+            VTK_AsciiFormatter formatter;
+            formatter.attach(&std::cout);
+            format(formatter, 0, NoEntities());
+            formatter.text("\n");
+            formatter.flush();
+        }
+        void gather(size_t first_entity, size_t no_entities, char* buffer) const
+        {
+            quantized(first_entity, no_entities, [&buffer](const uint32_t* steps, size_t n)
+            {
+                std::memcpy(buffer, steps, n*sizeof(uint32_t));
+                buffer += n*sizeof(uint32_t);
+            });
+        }
+        void format(VTK_AsciiFormatter& formatter, size_t first_entity, size_t no_entities) const
+        {
+            quantized(first_entity, no_entities, [&formatter](const uint32_t* steps, size_t n){ for (size_t i=0; i<n; i++) formatter.value(steps[i]); });
+        }
+    public:
+        double Scale() const {return Step_;}
+        double Offset() const {return First_*Step_;}
+    private:
+        // calls f(values, n) for consecutive ranges of the values of [first_entity, first_entity+no_entities)
+        template <typename F>
+        void ranges(size_t first_entity, size_t no_entities, F&& f) const
+        {
+            thread_local std::vector<T> values;
+            const size_t m = NoComponents();
+            for (size_t first=first_entity; first<first_entity+no_entities; first+=QuantizationEntities)
+            {
+                const size_t n = std::min(QuantizationEntities, first_entity+no_entities-first);
+                values.resize(n*m);
+                Source_.gather(first, n, reinterpret_cast<char*>(values.data()));
+                f(values.data(), n*m);
+            }
+        }
+        template <typename F>
+        void quantized(size_t first_entity, size_t no_entities, F&& f) const
+        {
+            thread_local std::vector<uint32_t> steps;
+            ranges(first_entity, no_entities, [&](const T* values, size_t n)
+            {
+                steps.resize(n);
+                VTK_QuantizeToStep(values, n, Step_, First_, steps.data());
+                f(steps.data(), n);
+            });
+        }
+        // the lowest step of the values, the steps are exact integers below 2^51
+        void scan(VTK_ThreadPool* pool)
+        {
+            const size_t no_entities = NoEntities();
+            const size_t no_tasks = (pool != nullptr) ? 4*pool->NoThreads() : 1;
+            std::vector<double> lower(no_tasks, std::numeric_limits<double>::infinity()), upper(no_tasks, -std::numeric_limits<double>::infinity());
+            std::vector<char> finite(no_tasks, 1);
+            VTK_ParallelFor(pool, no_tasks, [&](size_t t)
+            {
+                const size_t first = t*no_entities/no_tasks, last = (t+1)*no_entities/no_tasks;
+                ranges(first, last-first, [&](const T* values, size_t n)
+                {
+                    double low = lower[t], high = upper[t];
+                    bool ok = true;
+                    for (size_t i=0; i<n; i++)
+                    {
+                        const double value = values[i];
+                        low = (value < low) ? value : low;
+                        high = (value > high) ? value : high;
+                        // infinities and NaN give NaN
+                        ok &= (value-value == 0);
+                    }
+                    lower[t] = low;
+                    upper[t] = high;
+                    finite[t] &= ok;
+                });
+            });
+            if (no_entities*NoComponents() == 0) return;
+            if (std::find(finite.begin(), finite.end(), 0) != finite.end()) throw std::runtime_error("Error quantizing DataArray "+Name()+"! The values are not finite.");
+            const double low = *std::min_element(lower.begin(), lower.end()), high = *std::max_element(upper.begin(), upper.end());
+            const double limit = std::ldexp(1.0, 51);
+            if (std::fabs(low/Step_) >= limit || std::fabs(high/Step_) >= limit) throw std::runtime_error("Error quantizing DataArray "+Name()+"! The error bound is too small for the magnitude of the values.");
+            First_ = std::nearbyint(low/Step_);
+            if (std::nearbyint(high/Step_)-First_ > double(UINT32_MAX)) throw std::runtime_error("Error quantizing DataArray "+Name()+"! The values span more than 2^32 steps of the error bound.");
+        }
+};
+
+// View which writes source within the error bound, the storage selects VTK_RoundedArray or VTK_QuantizedArray
+inline std::unique_ptr<VTK_Array> VTK_ErrorBoundedArray(const VTK_Array& source, const VTK_ErrorBound& bound, VTK_ThreadPool* pool = nullptr)
+{
+    if (source.Type() != "Float64" && source.Type() != "Float32") throw std::runtime_error("Error bounding DataArray "+source.Name()+"! Error bounds apply to Float64 and Float32 arrays, got "+source.Type());
+    const bool is_double = (source.Type() == "Float64");
+    if (bound.storage == VTK_QUANTIZED_INTEGERS)
+    {
+        if (bound.mode != VTK_ABSOLUTE_ERROR) throw std::runtime_error("Error quantizing DataArray "+source.Name()+"! Quantized integers need an absolute error bound.");
+        if (is_double) return std::unique_ptr<VTK_Array>(new VTK_QuantizedArray<double>(source, bound.bound, pool));
+        return std::unique_ptr<VTK_Array>(new VTK_QuantizedArray<float>(source, bound.bound, pool));
+    }
+    if (is_double) return std::unique_ptr<VTK_Array>(new VTK_RoundedArray<double>(source, bound.mode, bound.bound));
+    return std::unique_ptr<VTK_Array>(new VTK_RoundedArray<float>(source, bound.mode, bound.bound));
+}
@@ -0,0 +1,607 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <array>
+#include <memory>
+#include <sstream>
+#include <cstring>
+#include <cstdint>
+#include <charconv>
+#include <algorithm>
+#include <stdexcept>
+
+#include <vtk_array.hpp>
+#include <vtk_base64.hpp>
+#include <vtk_compression.hpp>
+#include <vtk_sink.hpp>
+#include <vtk_threadpool.hpp>
+
+// Calls task with a value of the C++ type of a VTK type name, e.g. double() for "Float64", unknown types throw
+template <typename F>
+inline void VTK_DispatchType(const std::string& type, F&& task)
+{
+    if (type == "Float64") task(double());
+    else if (type == "Float32") task(float());
+    else if (type == "Int64") task(int64_t());
+    else if (type == "UInt64") task(uint64_t());
+    else if (type == "Int32") task(int32_t());
+    else if (type == "UInt32") task(uint32_t());
+    else if (type == "Int16") task(int16_t());
+    else if (type == "UInt16") task(uint16_t());
+    else if (type == "Int8") task(int8_t());
+    else if (type == "UInt8") task(uint8_t());
+    else throw std::runtime_error("Error reading DataArray! Unknown type "+type);
+}
+
+/*
+VTK_MappedFile(
+               std::string path_to_file -> file to read
+               )
+Read-only view of a whole file: memory mapped on POSIX systems, read into memory otherwise.
+*/
+class VTK_MappedFile
+{
+    public:
+        VTK_MappedFile(std::string path_to_file) : Path_(path_to_file), Data_(nullptr), Size_(0), Mapped_(false)
+        {
+#ifdef VTK_WITH_POSIX_SINKS
+            const int fd = ::open(Path_.c_str(), O_RDONLY);
+            if (fd < 0) throw std::runtime_error("Error opening "+Path_+"! "+std::strerror(errno));
+            struct stat status;
+            if (::fstat(fd, &status) != 0 || status.st_size == 0)
+            {
+                ::close(fd);
+                throw std::runtime_error("Error reading "+Path_+"! The file is empty or not accessible.");
+            }
+            Size_ = static_cast<size_t>(status.st_size);
+            void* map = ::mmap(nullptr, Size_, PROT_READ, MAP_PRIVATE, fd, 0);
+            ::close(fd);
+            if (map == MAP_FAILED) throw std::runtime_error("Error mapping "+Path_+"! "+std::strerror(errno));
+            Data_ = static_cast<const char*>(map);
+            Mapped_ = true;
+#else
+            std::ifstream INFILE(Path_, std::ios::binary | std::ios::ate);
+            if (!INFILE.is_open()) throw std::runtime_error("Error opening "+Path_+"!");
+            Buffer_.resize(static_cast<size_t>(INFILE.tellg()));
+            INFILE.seekg(0);
+            INFILE.read(Buffer_.data(), Buffer_.size());
+            if (!INFILE || Buffer_.empty()) throw std::runtime_error("Error reading "+Path_+"! The file is empty or not accessible.");
+            Data_ = Buffer_.data();
+            Size_ = Buffer_.size();
+#endif
+        }
+        ~VTK_MappedFile()
+        {
+#ifdef VTK_WITH_POSIX_SINKS
+            if (Mapped_) ::munmap(const_cast<char*>(Data_), Size_);
+#endif
+        }
+        VTK_MappedFile(const VTK_MappedFile&) = delete;
+        VTK_MappedFile& operator=(const VTK_MappedFile&) = delete;
+    public:
+        const std::string& Path() const {return Path_;}
+        const char* Data() const {return Data_;}
+        size_t Size() const {return Size_;}
+        bool Mapped() const {return Mapped_;}
+    private:
+        std::string Path_;
+        const char* Data_;
+        size_t Size_;
+        bool Mapped_;
+        std::vector<char> Buffer_;
+};
+
+/*
+Data array read from a file, see VTK_Reader::read(...).
+Uncompressed appended raw values are viewed in the mapped file (zero-copy) if they are aligned to their type,
+all other values are decoded into memory owned by the array. As VTK_Array it can be written again.
+*/
+class VTK_ReadArray : public VTK_Array
+{
+    public:
+        // View of byte_size bytes of the mapped file, copied if data is not aligned to the type
+        VTK_ReadArray(std::string name, std::string type, size_t no_components, const char* data, size_t byte_size, std::shared_ptr<const VTK_MappedFile> file)
+        : Name_(name), Type_(type), NoComponents_(no_components), Data_(data), File_(file)
+        {
+            init(byte_size);
+            if (reinterpret_cast<uintptr_t>(data) % ValueSize_ == 0) return;
+            Values_.assign(data, data+byte_size);
+            Data_ = Values_.data();
+            File_.reset();
+        }
+        // Decoded values
+        VTK_ReadArray(std::string name, std::string type, size_t no_components, std::vector<char> values)
+        : Name_(name), Type_(type), NoComponents_(no_components), Values_(std::move(values))
+        {
+            Data_ = Values_.data();
+            init(Values_.size());
+        }
+    public:
+        std::string Name() const {return Name_;}
+        std::string Type() const {return Type_;}
+        size_t NoComponents() const {return NoComponents_;}
+        size_t NoEntities() const {return NoEntities_;}
+        size_t ValueSize() const {return ValueSize_;}
+        const char* ContiguousData() const {return Data_;}
+        void gather(size_t first_entity, size_t no_entities, char* buffer) const
+        {
+            const size_t entity_bytes = NoComponents_*ValueSize_;
+            std::memcpy(buffer, Data_+first_entity*entity_bytes, no_entities*entity_bytes);
+        }
+        void format(VTK_AsciiFormatter& formatter, size_t first_entity, size_t no_entities) const
+        {
+            VTK_DispatchType(Type_, [&](auto value)
+            {
+                const char* ptr = Data_+first_entity*NoComponents_*sizeof(value);
+                for (size_t i=0; i<no_entities*NoComponents_; i++, ptr+=sizeof(value))
+                {
+                    std::memcpy(&value, ptr, sizeof(value));
+                    formatter.value(value);
+                }
+            });
+        }
+        void print() const
+        {
+            VTK_AsciiFormatter formatter;
+            formatter.attach(&std::cout);
+            writeAscii(formatter);
+            formatter.flush();
+        }
+    public:
+        // True if the values are viewed in the mapped file
+        bool Mapped() const {return File_ != nullptr;}
+
+        // Typed pointer to the values, T has to match the type of the array
+        template <typename T>
+        const T* data() const
+        {
+            if (Type_ != VTKType(T()) || ValueSize_ != sizeof(T)) throw std::runtime_error("Error reading DataArray "+Name_+"! Expected type "+VTKType(T())+", got "+Type_);
+            return reinterpret_cast<const T*>(Data_);
+        }
+    private:
+        void init(size_t byte_size)
+        {
+            if (NoComponents_ == 0) throw std::runtime_error("Error reading DataArray "+Name_+"! It has no components.");
+            VTK_DispatchType(Type_, [this](auto value) { ValueSize_ = sizeof(value); });
+            if (byte_size % (NoComponents_*ValueSize_) != 0) throw std::runtime_error("Error reading DataArray "+Name_+"! "+std::to_string(byte_size)+" bytes are no multiple of the entity size.");
+            NoEntities_ = byte_size/(NoComponents_*ValueSize_);
+        }
+    private:
+        std::string Name_, Type_;
+        size_t NoComponents_, NoEntities_ = 0, ValueSize_ = 0;
+        const char* Data_;
+        std::vector<char> Values_;
+        std::shared_ptr<const VTK_MappedFile> File_;
+};
+
+/*
+Description of a DataArray of the file
+section -> enclosing element, e.g. Points, Cells, PointData, CellData, Coordinates or Polys
+format  -> ascii, binary or appended
+offset  -> appended: offset in the appended data
+first, last -> ascii and binary: range of the inline values in the file
+quantized, scale, quantization_offset -> UInt32 steps of VTK_QuantizedArray, value = quantization_offset+k*scale
+*/
+struct VTK_ArrayInfo
+{
+    std::string section, name, type, format;
+    size_t no_components, offset, first, last;
+    bool quantized = false;
+    double scale = 1, quantization_offset = 0;
+};
+
+/*
+VTK_Reader(
+           std::string path_to_file -> .vtu, .vtp, .vti or .vtr file with a single piece
+           )
+Reads the XML files written by this library: ascii, base64 binary and appended raw data, optionally zlib or lz4 compressed.
+The file is mapped and the XML header is scanned once for the DataArray tags, no DOM is built and the appended data is not touched.
+The arrays are decoded on request: uncompressed appended arrays are viewed in the mapping, compressed blocks are
+decompressed and base64 and ascii values are decoded in parallel on setNumberOfThreads(...) threads.
+Example:
+    VTK_Reader reader("results/restart.vtu");
+    reader.setNumberOfThreads(8);
+    std::vector<double> XI = reader.values<double>("Points", "Coordinates");
+    std::vector<size_t> Elmt = reader.values<size_t>("Cells", "connectivity");
+    std::shared_ptr<const VTK_ReadArray> temperature = reader.read("PointData", "Temperature");
+    const double* T = temperature->data<double>();
+*/
+class VTK_Reader
+{
+    public:
+        VTK_Reader(std::string path_to_file) : File_(std::make_shared<VTK_MappedFile>(path_to_file)), NoThreads_(1) { scan(); }
+        VTK_Reader(const VTK_Reader&) = delete;
+        VTK_Reader& operator=(const VTK_Reader&) = delete;
+    public:
+        // Number of threads decoding an array (1 by default)
+        void setNumberOfThreads(unsigned int no_threads) { NoThreads_ = no_threads > 0 ? no_threads : 1; }
+
+        // Dataset type of the file, e.g. UnstructuredGrid
+        const std::string& Type() const {return Type_;}
+
+        // Attribute of the Piece or the dataset element, e.g. NumberOfCells or WholeExtent, empty if it does not exist
+        std::string Attribute(const std::string& name) const;
+
+        size_t NoPoints() const;
+        size_t NoCells() const;
+
+        // All DataArrays in the order of the file
+        const std::vector<VTK_ArrayInfo>& Arrays() const {return Arrays_;}
+        bool hasArray(const std::string& section, const std::string& name) const { return find(section, name) != nullptr; }
+
+        // Decodes the array name of section, failures throw a std::runtime_error
+        std::shared_ptr<const VTK_ReadArray> read(const std::string& section, const std::string& name);
+
+        // Values of the array name of section converted to T, e.g. the UInt32 connectivity to size_t,
+        // quantized arrays are converted back to offset+k*scale (read(...) views the steps k)
+        template <typename T>
+        std::vector<T> values(const std::string& section, const std::string& name);
+    private:
+        typedef std::vector<std::pair<std::string, std::string>> Attributes;
+        static std::string attribute(const Attributes& attributes, const std::string& name)
+        {
+            for (auto &entry : attributes) if (entry.first == name) return entry.second;
+            return std::string();
+        }
+        void scan();
+        const VTK_ArrayInfo* find(const std::string& section, const std::string& name) const
+        {
+            for (auto &info : Arrays_) if (info.section == section && info.name == name) return &info;
+            return nullptr;
+        }
+        // reads an entry of a byte count header
+        uint64_t headerValue(const char* bytes, size_t i) const
+        {
+            if (UInt64Header_)
+            {
+                uint64_t value;
+                std::memcpy(&value, bytes+i*sizeof(uint64_t), sizeof(uint64_t));
+                return value;
+            }
+            uint32_t value;
+            std::memcpy(&value, bytes+i*sizeof(uint32_t), sizeof(uint32_t));
+            return value;
+        }
+        std::vector<char> decompress(const VTK_ArrayInfo& info, const char* header, const char* blocks, size_t available);
+        std::vector<char> decodeBase64(const char* chars, size_t n);
+        std::vector<char> parseAscii(const VTK_ArrayInfo& info);
+        size_t noTasks() const {return (NoThreads_ > 1) ? 4*NoThreads_ : 1;}
+        VTK_ThreadPool* pool()
+        {
+            if (NoThreads_ <= 1) return nullptr;
+            if (!pool_ || pool_->NoThreads() != NoThreads_) pool_.reset(new VTK_ThreadPool(NoThreads_));
+            return pool_.get();
+        }
+    private:
+        std::shared_ptr<const VTK_MappedFile> File_;
+        unsigned int NoThreads_;
+        std::unique_ptr<VTK_ThreadPool> pool_;
+        std::string Type_;
+        Attributes DataSetAttributes_, PieceAttributes_;
+        bool UInt64Header_ = false;
+        VTK_COMPRESSOR Compressor_ = VTK_NO_COMPRESSION;
+        std::vector<VTK_ArrayInfo> Arrays_;
+        size_t AppendedStart_ = 0;
+        bool Appended_ = false;
+};
+
+inline void VTK_Reader::scan()
+{
+    const char* data = File_->Data();
+    const size_t size = File_->Size();
+    const std::string& path = File_->Path();
+    auto fail = [&path](const std::string& message) { return std::runtime_error("Error reading "+path+"! "+message); };
+    auto is_space = [](char c) { return c == ' ' || c == '\n' || c == '\r' || c == '\t'; };
+
+    std::string section;
+    bool in_file = false;
+    size_t no_pieces = 0;
+    for (size_t position = 0; ; )
+    {
+        const char* open = static_cast<const char*>(std::memchr(data+position, '<', size-position));
+        if (open == nullptr) break;
+        position = open-data+1;
+        if (position < size && (data[position] == '?' || data[position] == '!'))
+        {
+            // declarations and comments
+            const char* close = static_cast<const char*>(std::memchr(data+position, '>', size-position));
+            if (close == nullptr) throw fail("Unterminated declaration.");
+            position = close-data+1;
+            continue;
+        }
+        const bool closing = (position < size && data[position] == '/');
+        if (closing) position++;
+        const size_t name_first = position;
+        while (position < size && !is_space(data[position]) && data[position] != '>' && data[position] != '/') position++;
+        const std::string name(data+name_first, position-name_first);
+
+        // attributes up to the end of the tag
+        Attributes attributes;
+        bool self_closing = false;
+        while (true)
+        {
+            while (position < size && is_space(data[position])) position++;
+            if (position >= size) throw fail("Unterminated tag "+name);
+            if (data[position] == '>') { position++; break; }
+            if (data[position] == '/') { self_closing = true; position++; continue; }
+            const size_t key_first = position;
+            while (position < size && data[position] != '=' && !is_space(data[position]) && data[position] != '>') position++;
+            const std::string key(data+key_first, position-key_first);
+            while (position < size && (is_space(data[position]) || data[position] == '=')) position++;
+            if (position >= size || (data[position] != '"' && data[position] != '\'')) throw fail("Attribute "+key+" of tag "+name+" has no value.");
+            const char quote = data[position++];
+            const char* end = static_cast<const char*>(std::memchr(data+position, quote, size-position));
+            if (end == nullptr) throw fail("Unterminated attribute "+key+" of tag "+name);
+            attributes.push_back({key, std::string(data+position, end)});
+            position = end-data+1;
+        }
+
+        if (closing)
+        {
+            if (name == section) section.clear();
+            continue;
+        }
+        if (name == "VTKFile")
+        {
+            in_file = true;
+            Type_ = attribute(attributes, "type");
+            if (attribute(attributes, "byte_order") == "BigEndian") throw fail("BigEndian files are not supported.");
+            UInt64Header_ = (attribute(attributes, "header_type") == "UInt64");
+            const std::string compressor = attribute(attributes, "compressor");
+            if (compressor == VTKCompressorName(VTK_ZLIB)) Compressor_ = VTK_ZLIB;
+            else if (compressor == VTKCompressorName(VTK_LZ4)) Compressor_ = VTK_LZ4;
+            else if (!compressor.empty()) throw fail("Unknown compressor "+compressor);
+        }
+        else if (!in_file) throw fail("Expected a VTKFile element, got "+name);
+        else if (name == Type_) DataSetAttributes_ = attributes;
+        else if (name == "Piece")
+        {
+            if (++no_pieces > 1) throw fail("Only files with a single piece are supported.");
+            PieceAttributes_ = attributes;
+        }
+        else if (name == "DataArray")
+        {
+            VTK_ArrayInfo info = {section, attribute(attributes, "Name"), attribute(attributes, "type"), attribute(attributes, "format"), 1, 0, 0, 0};
+            const std::string components = attribute(attributes, "NumberOfComponents");
+            if (!components.empty()) info.no_components = std::stoul(components);
+            const std::string scale = attribute(attributes, "QuantizationScale");
+            if (!scale.empty())
+            {
+                info.quantized = true;
+                info.scale = std::stod(scale);
+                info.quantization_offset = std::stod(attribute(attributes, "QuantizationOffset"));
+            }
+            if (info.format == "appended") info.offset = std::stoull(attribute(attributes, "offset"));
+            else if (info.format == "ascii" || info.format == "binary")
+            {
+                // the inline values end with the closing tag
+                if (self_closing) throw fail("DataArray "+info.name+" has no values.");
+                const char* end = data+position;
+                const std::string close = "</DataArray";
+                while (end != nullptr && (size-(end-data) < close.size() || std::memcmp(end, close.data(), close.size()) != 0))
+                    end = static_cast<const char*>(std::memchr(end+1, '<', size-(end-data)-1));
+                if (end == nullptr) throw fail("Unterminated DataArray "+info.name);
+                info.first = position;
+                info.last = end-data;
+                while (info.first < info.last && is_space(data[info.first])) info.first++;
+                while (info.last > info.first && is_space(data[info.last-1])) info.last--;
+                position = end-data;
+            }
+            else throw fail("DataArray "+info.name+" has the unknown format "+info.format);
+            Arrays_.push_back(info);
+        }
+        else if (name == "AppendedData")
+        {
+            if (attribute(attributes, "encoding") != "raw") throw fail("Only raw encoded appended data is supported.");
+            // the raw data starts right after the underscore and is not scanned
+            const char* underscore = static_cast<const char*>(std::memchr(data+position, '_', size-position));
+            if (underscore == nullptr) throw fail("The appended data does not start with an underscore.");
+            AppendedStart_ = underscore-data+1;
+            Appended_ = true;
+            break;
+        }
+        else if (!self_closing) section = name;
+    }
+    if (!in_file) throw fail("No VTKFile element found.");
+    for (auto &info : Arrays_)
+        if (info.format == "appended" && !Appended_) throw fail("DataArray "+info.name+" is appended, but the file has no appended data.");
+}
+
+inline std::string VTK_Reader::Attribute(const std::string& name) const
+{
+    const std::string value = attribute(PieceAttributes_, name);
+    return value.empty() ? attribute(DataSetAttributes_, name) : value;
+}
+
+inline size_t VTK_Reader::NoPoints() const
+{
+    const std::string points = attribute(PieceAttributes_, "NumberOfPoints");
+    if (!points.empty()) return std::stoull(points);
+    // structured datasets: the points of the extent
+    std::istringstream extent(Attribute("Extent"));
+    size_t no_points = 1;
+    for (size_t d=0; d<3; d++)
+    {
+        long long first = 0, last = -1;
+        if (!(extent >> first >> last)) throw std::runtime_error("Error reading "+File_->Path()+"! The piece has neither NumberOfPoints nor an Extent.");
+        no_points *= static_cast<size_t>(last-first+1);
+    }
+    return no_points;
+}
+
+inline size_t VTK_Reader::NoCells() const
+{
+    for (auto &name : {"NumberOfCells", "NumberOfPolys"})
+    {
+        const std::string cells = attribute(PieceAttributes_, name);
+        if (!cells.empty()) return std::stoull(cells);
+    }
+    // structured datasets: directions with a single point do not count
+    std::istringstream extent(Attribute("Extent"));
+    size_t no_cells = 1;
+    for (size_t d=0; d<3; d++)
+    {
+        long long first = 0, last = -1;
+        if (!(extent >> first >> last)) throw std::runtime_error("Error reading "+File_->Path()+"! The piece has neither NumberOfCells nor an Extent.");
+        no_cells *= std::max<size_t>(static_cast<size_t>(last-first+1), 2)-1;
+    }
+    return no_cells;
+}
+
+inline std::shared_ptr<const VTK_ReadArray> VTK_Reader::read(const std::string& section, const std::string& name)
+{
+    const VTK_ArrayInfo* found = find(section, name);
+    if (found == nullptr) throw std::runtime_error("Error reading "+File_->Path()+"! No DataArray "+name+" in section "+section);
+    const VTK_ArrayInfo& info = *found;
+    const char* data = File_->Data();
+    const size_t header_bytes = UInt64Header_ ? sizeof(uint64_t) : sizeof(uint32_t);
+    auto fail = [&](const std::string& message) { return std::runtime_error("Error reading DataArray "+info.name+" of "+File_->Path()+"! "+message); };
+
+    if (info.format == "ascii") return std::make_shared<VTK_ReadArray>(info.name, info.type, info.no_components, parseAscii(info));
+    if (info.format == "binary")
+    {
+        const char* chars = data+info.first;
+        const size_t n = info.last-info.first;
+        if (Compressor_ == VTK_NO_COMPRESSION)
+        {
+            // one base64 stream of the byte count and the values
+            std::vector<char> bytes = decodeBase64(chars, n);
+            if (bytes.size() < header_bytes || headerValue(bytes.data(), 0) != bytes.size()-header_bytes) throw fail("The byte count does not match the values.");
+            bytes.erase(bytes.begin(), bytes.begin()+header_bytes);
+            return std::make_shared<VTK_ReadArray>(info.name, info.type, info.no_components, std::move(bytes));
+        }
+        // the header and the blocks are separate base64 streams, the number of blocks gives the length of the header
+        const size_t first_group = VTK_Base64Length(header_bytes);
+        if (n < first_group) throw fail("The compression header is truncated.");
+        const std::vector<char> first = decodeBase64(chars, first_group);
+        const size_t header_chars = VTK_Base64Length((3+headerValue(first.data(), 0))*header_bytes);
+        if (n < header_chars) throw fail("The compression header is truncated.");
+        const std::vector<char> header = decodeBase64(chars, header_chars);
+        const std::vector<char> blocks = decodeBase64(chars+header_chars, n-header_chars);
+        return std::make_shared<VTK_ReadArray>(info.name, info.type, info.no_components, decompress(info, header.data(), blocks.data(), blocks.size()));
+    }
+
+    // appended raw
+    const size_t position = AppendedStart_+info.offset;
+    if (position+header_bytes > File_->Size()) throw fail("The offset lies behind the end of the file.");
+    if (Compressor_ == VTK_NO_COMPRESSION)
+    {
+        const uint64_t nbytes = headerValue(data+position, 0);
+        if (position+header_bytes+nbytes > File_->Size()) throw fail("The values exceed the end of the file.");
+        return std::make_shared<VTK_ReadArray>(info.name, info.type, info.no_components, data+position+header_bytes, nbytes, File_);
+    }
+    const size_t no_blocks = headerValue(data+position, 0);
+    if (position+(3+no_blocks)*header_bytes > File_->Size()) throw fail("The compression header exceeds the end of the file.");
+    const size_t blocks = position+(3+no_blocks)*header_bytes;
+    return std::make_shared<VTK_ReadArray>(info.name, info.type, info.no_components, decompress(info, data+position, data+blocks, File_->Size()-blocks));
+}
+
+inline std::vector<char> VTK_Reader::decompress(const VTK_ArrayInfo& info, const char* header, const char* blocks, size_t available)
+{
+    // [number of blocks, block size, size of the last block, compressed sizes...], VTK writes 0 for a full last block
+    const size_t no_blocks = headerValue(header, 0), block_size = headerValue(header, 1);
+    const size_t last_size = (headerValue(header, 2) == 0) ? block_size : headerValue(header, 2);
+    std::vector<size_t> first_byte(no_blocks+1, 0);
+    for (size_t b=0; b<no_blocks; b++) first_byte[b+1] = first_byte[b]+headerValue(header, 3+b);
+    if (first_byte[no_blocks] > available) throw std::runtime_error("Error reading DataArray "+info.name+" of "+File_->Path()+"! The compressed blocks exceed the data.");
+    std::vector<char> values(no_blocks > 0 ? (no_blocks-1)*block_size+last_size : 0);
+    VTK_ParallelFor(pool(), no_blocks, [&](size_t b)
+    {
+        const size_t raw_size = (b+1 == no_blocks) ? last_size : block_size;
+        VTK_DecompressBlock(Compressor_, blocks+first_byte[b], first_byte[b+1]-first_byte[b], values.data()+b*block_size, raw_size);
+    });
+    return values;
+}
+
+inline std::vector<char> VTK_Reader::decodeBase64(const char* chars, size_t n)
+{
+    if (n % 4 != 0) throw std::runtime_error("Error reading "+File_->Path()+"! The base64 data is no multiple of 4 characters.");
+    std::vector<char> bytes(VTK_Base64DecodedLength(chars, n));
+    // ranges of whole groups, only the last one can be padded
+    const size_t no_groups = n/4, no_tasks = std::min(noTasks(), std::max<size_t>(no_groups, 1));
+    std::vector<char> valid(no_tasks, 1);
+    VTK_ParallelFor(pool(), no_tasks, [&](size_t t)
+    {
+        const size_t first = t*no_groups/no_tasks, last = (t+1)*no_groups/no_tasks;
+        valid[t] = VTK_Base64Decode(chars+4*first, 4*(last-first), bytes.data()+3*first);
+    });
+    for (auto &ok : valid) if (!ok) throw std::runtime_error("Error reading "+File_->Path()+"! Invalid base64 characters.");
+    return bytes;
+}
+
+inline std::vector<char> VTK_Reader::parseAscii(const VTK_ArrayInfo& info)
+{
+    const char* data = File_->Data();
+    auto is_space = [](char c) { return c == ' ' || c == '\n' || c == '\r' || c == '\t'; };
+    // ranges of whole values, every range starts behind a separator
+    const size_t no_tasks = noTasks();
+    std::vector<size_t> first(no_tasks+1, info.last);
+    first[0] = info.first;
+    for (size_t t=1; t<no_tasks; t++)
+    {
+        size_t position = std::max(first[t-1], info.first+t*(info.last-info.first)/no_tasks);
+        while (position < info.last && !is_space(data[position])) position++;
+        first[t] = position;
+    }
+    std::vector<std::vector<char>> parts(no_tasks);
+    std::vector<char> failed(no_tasks, 0);
+    VTK_DispatchType(info.type, [&](auto zero)
+    {
+        typedef decltype(zero) T;
+        VTK_ParallelFor(pool(), no_tasks, [&](size_t t)
+        {
+            std::vector<T> values;
+            const char* position = data+first[t];
+            const char* last = data+first[t+1];
+            while (true)
+            {
+                while (position < last && is_space(*position)) position++;
+                if (position >= last) break;
+                T value;
+                const std::from_chars_result result = std::from_chars(position, last, value);
+                if (result.ec != std::errc() || (result.ptr < last && !is_space(*result.ptr)))
+                {
+                    failed[t] = 1;
+                    return;
+                }
+                values.push_back(value);
+                position = result.ptr;
+            }
+            parts[t].resize(values.size()*sizeof(T));
+            std::memcpy(parts[t].data(), values.data(), parts[t].size());
+        });
+    });
+    if (std::find(failed.begin(), failed.end(), 1) != failed.end()) throw std::runtime_error("Error reading DataArray "+info.name+" of "+File_->Path()+"! Invalid ascii value of type "+info.type);
+    size_t size = 0;
+    for (auto &part : parts) size += part.size();
+    std::vector<char> bytes;
+    bytes.reserve(size);
+    for (auto &part : parts) bytes.insert(bytes.end(), part.begin(), part.end());
+    return bytes;
+}
+
+template <typename T>
+inline std::vector<T> VTK_Reader::values(const std::string& section, const std::string& name)
+{
+    std::shared_ptr<const VTK_ReadArray> data = read(section, name);
+    const VTK_ArrayInfo& info = *find(section, name);
+    std::vector<T> values(data->NoEntities()*data->NoComponents());
+    const char* raw = data->ContiguousData();
+    const size_t no_tasks = noTasks();
+    VTK_DispatchType(data->Type(), [&](auto zero)
+    {
+        typedef decltype(zero) From;
+        VTK_ParallelFor(pool(), no_tasks, [&](size_t t)
+        {
+            const size_t first = t*values.size()/no_tasks, last = (t+1)*values.size()/no_tasks;
+            for (size_t i=first; i<last; i++)
+            {
+                From value;
+                std::memcpy(&value, raw+i*sizeof(From), sizeof(From));
+                values[i] = info.quantized ? static_cast<T>(info.quantization_offset+value*info.scale) : static_cast<T>(value);
+            }
+        });
+    });
+    return values;
+}
@@ -0,0 +1,236 @@
+#pragma once
+
+#include <array>
+#include <vector>
+#include <memory>
+#include <cstdint>
+#include <algorithm>
+#include <stdexcept>
+
+#include <vtk_array.hpp>
+#include <vtk_cells.hpp>
+#include <vtk_threadpool.hpp>
+
+/*
+Order of the points and cells of an unstructured grid in the output, see VTK_ComputeReordering(...).
+node_ids     -> point i of the output is point node_ids[i] of the grid
+cell_ids     -> cell i of the output is cell cell_ids[i] of the grid
+connectivity -> the cells in the output order, numbered by the output points
+offsets      -> CSR offsets of connectivity, no_cells+1 entries starting with 0
+types        -> the VTK_CELLTYPE of the cells in the output order
+*/
+struct VTK_Reordering
+{
+    std::shared_ptr<std::vector<size_t>> node_ids, cell_ids;
+    std::vector<size_t> connectivity, offsets;
+    std::vector<VTK_CELLTYPE> types;
+};
+
+// Bits per direction of the keys of the space filling curves
+constexpr unsigned int VTK_CURVE_BITS = 21;
+
+// Interleaves the bits of x, y and z from the highest to the lowest, x first
+inline uint64_t VTK_InterleaveBits(const std::array<uint32_t, 3>& X, unsigned int bits = VTK_CURVE_BITS)
+{
+    auto spread = [](uint64_t v)
+    {
+        // every bit of the lower 21 bits moves to every third position
+        v &= 0x1fffff;
+        v = (v | (v << 32)) & 0x1f00000000ffffull;
+        v = (v | (v << 16)) & 0x1f0000ff0000ffull;
+        v = (v | (v << 8)) & 0x100f00f00f00f00full;
+        v = (v | (v << 4)) & 0x10c30c30c30c30c3ull;
+        v = (v | (v << 2)) & 0x1249249249249249ull;
+        return v;
+    };
+    const uint32_t mask = (bits >= 32) ? ~0u : ((1u << bits)-1);
+    return (spread(X[0] & mask) << 2) | (spread(X[1] & mask) << 1) | spread(X[2] & mask);
+}
+
+// Position on the Z-order curve
+inline uint64_t VTK_MortonKey(const std::array<uint32_t, 3>& X, unsigned int bits = VTK_CURVE_BITS)
+{
+    return VTK_InterleaveBits(X, bits);
+}
+
+// Position on the Hilbert curve: the transposed index of Skilling, "Programming the Hilbert curve" (2004), interleaved
+inline uint64_t VTK_HilbertKey(std::array<uint32_t, 3> X, unsigned int bits = VTK_CURVE_BITS)
+{
+    const uint32_t M = 1u << (bits-1);
+    // inverse undo
+    for (uint32_t Q = M; Q > 1; Q >>= 1)
+    {
+        const uint32_t P = Q-1;
+        for (size_t i=0; i<3; i++)
+        {
+            if (X[i] & Q) X[0] ^= P;
+            else
+            {
+                const uint32_t t = (X[0] ^ X[i]) & P;
+                X[0] ^= t;
+                X[i] ^= t;
+            }
+        }
+    }
+    // Gray encode
+    X[1] ^= X[0];
+    X[2] ^= X[1];
+    uint32_t t = 0;
+    for (uint32_t Q = M; Q > 1; Q >>= 1)
+        if (X[2] & Q) t ^= Q-1;
+    for (auto &x : X) x ^= t;
+    return VTK_InterleaveBits(X, bits);
+}
+
+/*
+Computes the order of the points and cells of a grid and the cells renumbered in this order, in parallel on the pool.
+VTK_MORTON, VTK_HILBERT -> the points are sorted by the key of their coordinates on the curve, the cells by the key of their centroid,
+                           the keys quantize the bounding box with VTK_CURVE_BITS per direction
+VTK_RCM                 -> reverse Cuthill-McKee numbering of the points, neighbours share a cell and are visited by ascending number of cells,
+                           every component starts at a point with the fewest cells; the cells are sorted by their lowest point
+Equal keys keep the order of the grid, the result does not depend on the number of threads.
+*/
+inline std::shared_ptr<const VTK_Reordering> VTK_ComputeReordering(VTK_REORDERING method, const VTK_Array& points, const VTK_Array& connectivity,
+                                                                  const VTK_CellOffsetArray& offsets, const VTK_CellTypeArray& types, VTK_ThreadPool* pool)
+{
+    if (method == VTK_NO_REORDERING) throw std::runtime_error("Error reordering the grid! No reordering selected.");
+    const size_t no_points = points.NoEntities(), no_cells = offsets.NoEntities();
+    const size_t no_tasks = (pool != nullptr) ? 4*pool->NoThreads() : 1;
+    // the connectivity as size_t values, viewed if it is contiguous
+    std::vector<size_t> gathered;
+    const size_t* nodes = reinterpret_cast<const size_t*>(connectivity.ContiguousData());
+    if (nodes == nullptr)
+    {
+        gathered.resize(connectivity.NoEntities()*connectivity.NoComponents());
+        connectivity.gatherBytes(0, gathered.size()*sizeof(size_t), reinterpret_cast<char*>(gathered.data()));
+        nodes = gathered.data();
+    }
+    auto first_node = [&](size_t cell) { return (cell == 0) ? 0 : offsets.offset(cell-1); };
+    // sorts the indices of keys by key, equal keys by index
+    auto sorted = [](const std::vector<uint64_t>& keys)
+    {
+        auto ids = std::make_shared<std::vector<size_t>>(keys.size());
+        for (size_t i=0; i<keys.size(); i++) (*ids)[i] = i;
+        std::sort(ids->begin(), ids->end(), [&keys](size_t a, size_t b) { return keys[a] < keys[b] || (keys[a] == keys[b] && a < b); });
+        return ids;
+    };
+
+    auto order = std::make_shared<VTK_Reordering>();
+    std::vector<size_t> node_map(no_points);
+    if (method == VTK_MORTON || method == VTK_HILBERT)
+    {
+        std::vector<double> XI(3*no_points);
+        points.gather(0, no_points, reinterpret_cast<char*>(XI.data()));
+        std::array<double, 3> lower = {0, 0, 0}, upper = {0, 0, 0};
+        if (no_points > 0)
+            for (size_t d=0; d<3; d++)
+            {
+                lower[d] = upper[d] = XI[d];
+                for (size_t p=0; p<no_points; p++)
+                {
+                    lower[d] = std::min(lower[d], XI[3*p+d]);
+                    upper[d] = std::max(upper[d], XI[3*p+d]);
+                }
+            }
+        const double cells_per_direction = double((1u << VTK_CURVE_BITS)-1);
+        auto key = [&](const std::array<double, 3>& x)
+        {
+            std::array<uint32_t, 3> X;
+            for (size_t d=0; d<3; d++)
+                X[d] = (upper[d] > lower[d]) ? static_cast<uint32_t>((x[d]-lower[d])/(upper[d]-lower[d])*cells_per_direction+0.5) : 0;
+            return (method == VTK_HILBERT) ? VTK_HilbertKey(X) : VTK_MortonKey(X);
+        };
+        std::vector<uint64_t> point_keys(no_points), cell_keys(no_cells);
+        VTK_ParallelFor(pool, no_tasks, [&](size_t t)
+        {
+            for (size_t p=t*no_points/no_tasks; p<(t+1)*no_points/no_tasks; p++) point_keys[p] = key({XI[3*p], XI[3*p+1], XI[3*p+2]});
+            for (size_t c=t*no_cells/no_tasks; c<(t+1)*no_cells/no_tasks; c++)
+            {
+                std::array<double, 3> centroid = {0, 0, 0};
+                const size_t first = first_node(c), last = offsets.offset(c);
+                for (size_t i=first; i<last; i++)
+                    for (size_t d=0; d<3; d++) centroid[d] += XI[3*nodes[i]+d];
+                for (auto &x : centroid) x /= std::max<size_t>(last-first, 1);
+                cell_keys[c] = key(centroid);
+            }
+        });
+        order->node_ids = sorted(point_keys);
+        order->cell_ids = sorted(cell_keys);
+        for (size_t p=0; p<no_points; p++) node_map[(*order->node_ids)[p]] = p;
+    }
+    else
+    {
+        // the cells of every point in CSR format
+        std::vector<size_t> point_cells_offsets(no_points+1, 0), point_cells(offsets.NoEntities() > 0 ? offsets.offset(no_cells-1) : 0);
+        for (size_t i=0; i<point_cells.size(); i++) point_cells_offsets[nodes[i]+1]++;
+        for (size_t p=0; p<no_points; p++) point_cells_offsets[p+1] += point_cells_offsets[p];
+        {
+            std::vector<size_t> position(point_cells_offsets.begin(), point_cells_offsets.end()-1);
+            for (size_t c=0; c<no_cells; c++)
+                for (size_t i=first_node(c); i<offsets.offset(c); i++) point_cells[position[nodes[i]]++] = c;
+        }
+        auto degree = [&](size_t p) { return point_cells_offsets[p+1]-point_cells_offsets[p]; };
+        // candidates for the start of every component by ascending degree
+        std::vector<size_t> starts(no_points);
+        for (size_t p=0; p<no_points; p++) starts[p] = p;
+        std::stable_sort(starts.begin(), starts.end(), [&](size_t a, size_t b) { return degree(a) < degree(b); });
+
+        std::vector<size_t> visit;
+        visit.reserve(no_points);
+        std::vector<char> visited(no_points, 0);
+        std::vector<size_t> neighbours;
+        for (auto &start : starts)
+        {
+            if (visited[start]) continue;
+            visited[start] = 1;
+            visit.push_back(start);
+            for (size_t head=visit.size()-1; head<visit.size(); head++)
+            {
+                const size_t p = visit[head];
+                neighbours.clear();
+                for (size_t j=point_cells_offsets[p]; j<point_cells_offsets[p+1]; j++)
+                {
+                    const size_t c = point_cells[j];
+                    for (size_t i=first_node(c); i<offsets.offset(c); i++)
+                        if (!visited[nodes[i]])
+                        {
+                            visited[nodes[i]] = 1;
+                            neighbours.push_back(nodes[i]);
+                        }
+                }
+                std::stable_sort(neighbours.begin(), neighbours.end(), [&](size_t a, size_t b) { return degree(a) < degree(b); });
+                visit.insert(visit.end(), neighbours.begin(), neighbours.end());
+            }
+        }
+        order->node_ids = std::make_shared<std::vector<size_t>>(visit.rbegin(), visit.rend());
+        for (size_t p=0; p<no_points; p++) node_map[(*order->node_ids)[p]] = p;
+        std::vector<uint64_t> cell_keys(no_cells);
+        VTK_ParallelFor(pool, no_tasks, [&](size_t t)
+        {
+            for (size_t c=t*no_cells/no_tasks; c<(t+1)*no_cells/no_tasks; c++)
+            {
+                size_t lowest = SIZE_MAX;
+                for (size_t i=first_node(c); i<offsets.offset(c); i++) lowest = std::min(lowest, node_map[nodes[i]]);
+                cell_keys[c] = lowest;
+            }
+        });
+        order->cell_ids = sorted(cell_keys);
+    }
+
+    // the cells in the new order, numbered by the new points
+    const std::vector<size_t>& cell_ids = *order->cell_ids;
+    order->offsets.resize(no_cells+1, 0);
+    order->types.resize(no_cells);
+    for (size_t c=0; c<no_cells; c++) order->offsets[c+1] = order->offsets[c]+offsets.offset(cell_ids[c])-first_node(cell_ids[c]);
+    order->connectivity.resize(order->offsets[no_cells]);
+    VTK_ParallelFor(pool, no_tasks, [&](size_t t)
+    {
+        for (size_t c=t*no_cells/no_tasks; c<(t+1)*no_cells/no_tasks; c++)
+        {
+            size_t entry = order->offsets[c];
+            for (size_t i=first_node(cell_ids[c]); i<offsets.offset(cell_ids[c]); i++) order->connectivity[entry++] = node_map[nodes[i]];
+            order->types[c] = types.type(cell_ids[c]);
+        }
+    });
+    return order;
+}
@@ -0,0 +1,351 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <fstream>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <exception>
+#include <stdexcept>
+#include <algorithm>
+#include <cstring>
+#include <cerrno>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#define VTK_WITH_POSIX_SINKS
+#endif
+
+/*
+Target of the writers. The bytes of a file arrive strictly in order through write(...),
+reserve(...) announces the total size if it is known before the first byte (binary formats).
+Every failure throws a std::runtime_error, close() has to be called to complete the output.
+*/
+class VTK_Sink
+{
+    public:
+        virtual ~VTK_Sink() {}
+    public:
+        // Name of the output for messages and statistics
+        virtual std::string Name() const = 0;
+        // Total number of bytes which will be written, called at most once before the first write(...)
+        virtual void reserve(size_t) {}
+        virtual void write(const char* data, size_t size) = 0;
+        // Completes the output, e.g. waits for pending writes
+        virtual void close() = 0;
+};
+
+// Selects the sink of the file based writers, see VTK_OpenFileSink(...)
+enum VTK_FILEBACKEND {VTK_STREAM_FILE=0, VTK_MAPPED_FILE=1, VTK_ASYNC_FILE=2};
+
+inline std::string VTK_ErrnoMessage() { return std::strerror(errno); }
+
+#ifdef VTK_WITH_POSIX_SINKS
+// Allocates the disk blocks of the file up to offset+length, so that stores into a shared mapping cannot fail with SIGBUS,
+// returns 0 or the error number, e.g. ENOSPC if the disk is full or EDQUOT if the quota is exceeded
+inline int VTK_Preallocate(int fd, off_t offset, off_t length)
+{
+#ifdef __APPLE__
+    fstore_t store = {F_ALLOCATEALL, F_PEOFPOSMODE, 0, length, 0};
+    if (::fcntl(fd, F_PREALLOCATE, &store) == -1) return errno;
+    return (::ftruncate(fd, offset+length) == 0) ? 0 : errno;
+#else
+    return ::posix_fallocate(fd, offset, length);
+#endif
+}
+#endif
+
+/*
+VTK_MemorySink(
+               std::string name_   -> name used in messages and statistics
+               )
+Collects the output in a growable buffer, e.g. for in-situ consumers or tests.
+*/
+class VTK_MemorySink : public VTK_Sink
+{
+    public:
+        VTK_MemorySink(std::string name_ = "memory") : Name_(name_) {}
+    public:
+        std::string Name() const { return Name_; }
+        void reserve(size_t size) { Buffer_.reserve(Buffer_.size()+size); }
+        void write(const char* data, size_t size) { Buffer_.insert(Buffer_.end(), data, data+size); }
+        void close() {}
+
+        const char* data() const { return Buffer_.data(); }
+        size_t size() const { return Buffer_.size(); }
+        // Moves the collected bytes into out, the sink continues empty
+        void release(std::vector<char>& out) { out.swap(Buffer_); Buffer_.clear(); }
+    private:
+        std::string Name_;
+        std::vector<char> Buffer_;
+};
+
+/*
+VTK_StreamFileSink(
+                   std::string path_   -> file to write
+                   )
+Writes through a std::ofstream, available everywhere. Open and write failures throw.
+*/
+class VTK_StreamFileSink : public VTK_Sink
+{
+    public:
+        VTK_StreamFileSink(std::string path_) : Path_(path_)
+        {
+            OUTFILE.open(Path_, std::ios::out | std::ios::binary);
+            if (!OUTFILE.is_open()) throw std::runtime_error("Error opening "+Path_+"! "+VTK_ErrnoMessage());
+        }
+    public:
+        std::string Name() const { return Path_; }
+        void write(const char* data, size_t size)
+        {
+            OUTFILE.write(data, size);
+            if (!OUTFILE.good()) throw std::runtime_error("Error writing "+Path_+"! "+VTK_ErrnoMessage());
+        }
+        void close()
+        {
+            OUTFILE.close();
+            if (OUTFILE.fail()) throw std::runtime_error("Error closing "+Path_+"! "+VTK_ErrnoMessage());
+        }
+    private:
+        std::string Path_;
+        std::ofstream OUTFILE;
+};
+
+#ifdef VTK_WITH_POSIX_SINKS
+
+// Writes all size bytes at offset, repeats partial writes
+inline void VTK_PWrite(int fd, const char* data, size_t size, size_t offset, const std::string& path)
+{
+    while (size > 0)
+    {
+        const ssize_t written = ::pwrite(fd, data, size, static_cast<off_t>(offset));
+        if (written < 0 && errno == EINTR) continue;
+        if (written <= 0) throw std::runtime_error("Error writing "+path+"! "+VTK_ErrnoMessage());
+        data += written;
+        size -= written;
+        offset += written;
+    }
+}
+
+/*
+VTK_MappedFileSink(
+                   std::string path_   -> file to write
+                   )
+Writes into a memory mapping of the file. If the size is reserved (binary formats), the file is preallocated
+once with its exact size, otherwise the mapping grows by doubling and the file is cut to its size on close().
+The blocks are allocated before they are mapped (VTK_Preallocate), a full disk throws instead of a SIGBUS in write(...).
+*/
+class VTK_MappedFileSink : public VTK_Sink
+{
+    public:
+        VTK_MappedFileSink(std::string path_) : Path_(path_), FD_(-1), Map_(nullptr), Capacity_(0), Size_(0)
+        {
+            FD_ = ::open(Path_.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+            if (FD_ < 0) throw std::runtime_error("Error opening "+Path_+"! "+VTK_ErrnoMessage());
+        }
+        ~VTK_MappedFileSink()
+        {
+            if (Map_ != nullptr) ::munmap(Map_, Capacity_);
+            if (FD_ >= 0) ::close(FD_);
+        }
+        VTK_MappedFileSink(const VTK_MappedFileSink&) = delete;
+        VTK_MappedFileSink& operator=(const VTK_MappedFileSink&) = delete;
+    public:
+        std::string Name() const { return Path_; }
+        void reserve(size_t size) { resize(Size_+size); }
+        void write(const char* data, size_t size)
+        {
+            if (Size_+size > Capacity_) resize(std::max(Size_+size, std::max<size_t>(2*Capacity_, 1 << 20)));
+            std::memcpy(Map_+Size_, data, size);
+            Size_ += size;
+        }
+        void close()
+        {
+            if (FD_ < 0) return;
+            if (Map_ != nullptr && ::munmap(Map_, Capacity_) != 0) throw std::runtime_error("Error unmapping "+Path_+"! "+VTK_ErrnoMessage());
+            Map_ = nullptr;
+            Capacity_ = 0;
+            const bool good = (::ftruncate(FD_, static_cast<off_t>(Size_)) == 0);
+            const int error = errno;
+            ::close(FD_);
+            FD_ = -1;
+            errno = error;
+            if (!good) throw std::runtime_error("Error resizing "+Path_+"! "+VTK_ErrnoMessage());
+        }
+    private:
+        void resize(size_t capacity)
+        {
+            if (capacity <= Capacity_) return;
+            if (Map_ != nullptr && ::munmap(Map_, Capacity_) != 0) throw std::runtime_error("Error unmapping "+Path_+"! "+VTK_ErrnoMessage());
+            const size_t allocated = Capacity_;
+            Map_ = nullptr;
+            Capacity_ = 0;
+            const int error = VTK_Preallocate(FD_, static_cast<off_t>(allocated), static_cast<off_t>(capacity-allocated));
+            if (error != 0) throw std::runtime_error("Error allocating "+std::to_string(capacity)+" bytes for "+Path_+"! "+std::strerror(error));
+            void* map = ::mmap(nullptr, capacity, PROT_READ | PROT_WRITE, MAP_SHARED, FD_, 0);
+            if (map == MAP_FAILED) throw std::runtime_error("Error mapping "+Path_+"! "+VTK_ErrnoMessage());
+            Map_ = static_cast<char*>(map);
+            Capacity_ = capacity;
+        }
+    private:
+        std::string Path_;
+        int FD_;
+        char* Map_;
+        size_t Capacity_, Size_;
+};
+
+/*
+VTK_AsyncFileSink(
+                  std::string path_,          -> file to write
+                  size_t request_bytes_,      -> size of one write request (8MB by default)
+                  unsigned int in_flight_     -> number of requests written at the same time (4 by default)
+                  )
+Collects the output into large requests which are written with pwrite(...) at their offset by in_flight_ threads,
+so several large writes overlap (parallel filesystems only reach their bandwidth this way).
+At most in_flight_+2 requests are held in memory, write(...) blocks while all writers are busy and one request is queued.
+The first failed request is rethrown by the next write(...) or close().
+*/
+class VTK_AsyncFileSink : public VTK_Sink
+{
+    public:
+        VTK_AsyncFileSink(std::string path_, size_t request_bytes_ = 8 << 20, unsigned int in_flight_ = 4)
+        : Path_(path_), FD_(-1), RequestBytes_(std::max<size_t>(request_bytes_, 1)), Offset_(0), Stop_(false)
+        {
+            FD_ = ::open(Path_.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+            if (FD_ < 0) throw std::runtime_error("Error opening "+Path_+"! "+VTK_ErrnoMessage());
+            const unsigned int no_writers = std::max(1u, in_flight_);
+            for (unsigned int i=0; i<no_writers; i++) Writers_.emplace_back([this]{ work(); });
+            Current_.reserve(RequestBytes_);
+        }
+        ~VTK_AsyncFileSink()
+        {
+            stop();
+            if (FD_ >= 0) ::close(FD_);
+        }
+        VTK_AsyncFileSink(const VTK_AsyncFileSink&) = delete;
+        VTK_AsyncFileSink& operator=(const VTK_AsyncFileSink&) = delete;
+    public:
+        std::string Name() const { return Path_; }
+        void write(const char* data, size_t size)
+        {
+            while (size > 0)
+            {
+                const size_t n = std::min(size, RequestBytes_-Current_.size());
+                Current_.insert(Current_.end(), data, data+n);
+                data += n;
+                size -= n;
+                if (Current_.size() == RequestBytes_) submit();
+            }
+        }
+        void close()
+        {
+            if (FD_ < 0) return;
+            if (!Current_.empty()) submit();
+            stop();
+            const bool good = (::close(FD_) == 0);
+            FD_ = -1;
+            if (Error_) std::rethrow_exception(Error_);
+            if (!good) throw std::runtime_error("Error closing "+Path_+"! "+VTK_ErrnoMessage());
+        }
+    private:
+        struct Request
+        {
+            std::vector<char> bytes;
+            size_t offset;
+        };
+        // hands the current request to the writers, waits while all of them are busy
+        void submit()
+        {
+            std::unique_lock<std::mutex> lock(Mutex_);
+            Done_.wait(lock, [this]{ return Queue_.empty() || Error_; });
+            if (Error_) std::rethrow_exception(Error_);
+            Queue_.push_back({std::move(Current_), Offset_});
+            Offset_ += Queue_.back().bytes.size();
+            Current_ = std::vector<char>();
+            if (!Free_.empty())
+            {
+                Current_ = std::move(Free_.back());
+                Free_.pop_back();
+            }
+            Current_.clear();
+            Current_.reserve(RequestBytes_);
+            lock.unlock();
+            Wakeup_.notify_one();
+        }
+        void work()
+        {
+            while (true)
+            {
+                Request request;
+                {
+                    std::unique_lock<std::mutex> lock(Mutex_);
+                    Wakeup_.wait(lock, [this]{ return Stop_ || !Queue_.empty(); });
+                    if (Queue_.empty()) return;
+                    request = std::move(Queue_.front());
+                    Queue_.erase(Queue_.begin());
+                }
+                Done_.notify_all();
+                std::exception_ptr error;
+                try
+                {
+                    VTK_PWrite(FD_, request.bytes.data(), request.bytes.size(), request.offset, Path_);
+                }
+                catch (...)
+                {
+                    error = std::current_exception();
+                }
+                {
+                    std::lock_guard<std::mutex> lock(Mutex_);
+                    if (error && !Error_) Error_ = error;
+                    Free_.push_back(std::move(request.bytes));
+                }
+                Done_.notify_all();
+            }
+        }
+        // waits for all requests and joins the writers
+        void stop()
+        {
+            {
+                std::lock_guard<std::mutex> lock(Mutex_);
+                if (Writers_.empty()) return;
+                Stop_ = true;
+            }
+            Wakeup_.notify_all();
+            for (auto &writer : Writers_) writer.join();
+            Writers_.clear();
+        }
+    private:
+        std::string Path_;
+        int FD_;
+        size_t RequestBytes_, Offset_;
+        std::vector<char> Current_;
+        std::vector<Request> Queue_;
+        std::vector<std::vector<char>> Free_;
+        bool Stop_;
+        std::exception_ptr Error_;
+        std::mutex Mutex_;
+        std::condition_variable Wakeup_, Done_;
+        std::vector<std::thread> Writers_;
+};
+
+#endif // VTK_WITH_POSIX_SINKS
+
+// Opens the sink of the given backend for path, the mapped and async backends need a POSIX system
+inline std::unique_ptr<VTK_Sink> VTK_OpenFileSink(const std::string& path, VTK_FILEBACKEND backend)
+{
+    switch (backend)
+    {
+#ifdef VTK_WITH_POSIX_SINKS
+    case VTK_MAPPED_FILE: return std::unique_ptr<VTK_Sink>(new VTK_MappedFileSink(path));
+    case VTK_ASYNC_FILE: return std::unique_ptr<VTK_Sink>(new VTK_AsyncFileSink(path));
+#endif
+    case VTK_STREAM_FILE: return std::unique_ptr<VTK_Sink>(new VTK_StreamFileSink(path));
+    default:
+        throw std::runtime_error("Error opening "+path+"! The file backend is not available on this system.");
+    }
+}
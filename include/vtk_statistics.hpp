@@ -0,0 +1,91 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <fstream>
+#include <charconv>
+#include <stdexcept>
+
+#include "vtk_definitions.hpp"
+
+/*
+Statistics of one DataArray of a written file.
+raw_bytes      -> size of the values in the written type
+encoded_bytes  -> bytes of the array in the file including its tag (ascii text, base64, raw or compressed blocks incl. headers)
+encode_seconds -> time spent formatting, gathering, converting, base64 encoding and compressing, summed over all threads
+write_seconds  -> time spent handing the encoded bytes to the stream
+*/
+struct VTK_ArrayStatistics
+{
+    std::string name, type;
+    size_t entities = 0, components = 0;
+    size_t raw_bytes = 0, encoded_bytes = 0;
+    double encode_seconds = 0.0, write_seconds = 0.0;
+};
+
+/*
+Statistics of one written file, collected only if requested (see VTK_UnstructuredGrid::setStatisticsCallback(...)).
+arrays lists the DataArrays in the order of the file, the totals include the xml structure.
+*/
+struct VTK_WriteStatistics
+{
+    std::string file;
+    VTK_WriteSettings settings;
+    unsigned int threads = 1;
+    std::vector<VTK_ArrayStatistics> arrays;
+    size_t raw_bytes = 0, file_bytes = 0;
+    double encode_seconds = 0.0, write_seconds = 0.0, seconds = 0.0;
+
+    // The statistics as a JSON object
+    std::string json() const
+    {
+        std::string out = "{\n";
+        out += "  \"file\": "+quote(file)+",\n";
+        out += "  \"format\": "+quote(settings.format == VTK_ASCII ? "ascii" : settings.format == VTK_BINARY ? "binary" : "appended")+",\n";
+        out += "  \"compressor\": "+quote(settings.compressor == VTK_NO_COMPRESSION ? "" : VTKCompressorName(settings.compressor))+",\n";
+        out += "  \"threads\": "+std::to_string(threads)+",\n";
+        out += "  \"seconds\": "+number(seconds)+",\n";
+        out += "  \"raw_bytes\": "+std::to_string(raw_bytes)+",\n";
+        out += "  \"file_bytes\": "+std::to_string(file_bytes)+",\n";
+        out += "  \"encode_seconds\": "+number(encode_seconds)+",\n";
+        out += "  \"write_seconds\": "+number(write_seconds)+",\n";
+        out += "  \"arrays\": [";
+        for (size_t i=0; i<arrays.size(); i++)
+        {
+            const VTK_ArrayStatistics& a = arrays[i];
+            out += (i == 0) ? "\n" : ",\n";
+            out += "    {\"name\": "+quote(a.name)+", \"type\": "+quote(a.type)+", \"entities\": "+std::to_string(a.entities)
+                  +", \"components\": "+std::to_string(a.components)+", \"raw_bytes\": "+std::to_string(a.raw_bytes)
+                  +", \"encoded_bytes\": "+std::to_string(a.encoded_bytes)+", \"encode_seconds\": "+number(a.encode_seconds)
+                  +", \"write_seconds\": "+number(a.write_seconds)+"}";
+        }
+        out += "\n  ]\n}\n";
+        return out;
+    }
+
+    // Writes json() to path_to_file, e.g. the sidecar "file.vtu.json"
+    bool writeJSON(const std::string& path_to_file) const
+    {
+        std::ofstream outfile(path_to_file, std::ios::out | std::ios::binary);
+        outfile << json();
+        return outfile.good();
+    }
+private:
+    static std::string quote(const std::string& str)
+    {
+        std::string out = "\"";
+        for (char c : str)
+        {
+            if (c == '"' || c == '\\') out += '\\';
+            if (static_cast<unsigned char>(c) < 0x20) out += ' ';
+            else out += c;
+        }
+        return out+"\"";
+    }
+    static std::string number(double value)
+    {
+        char buffer[32];
+        const auto result = std::to_chars(buffer, buffer+sizeof(buffer), value);
+        return std::string(buffer, result.ptr);
+    }
+};
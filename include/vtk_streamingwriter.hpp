@@ -0,0 +1,370 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <fstream>
+#include <memory>
+#include <cstring>
+#include <cstdint>
+#include <algorithm>
+#include <stdexcept>
+
+#include <vtk_array.hpp>
+#include <vtk_cells.hpp>
+#include <vtk_compression.hpp>
+#include <vtk_pieces.hpp>
+#include <vtk_threadpool.hpp>
+
+/*
+VTK_StreamingWriter(
+                    std::string path_to_file, -> the .vtu file
+                    size_t no_points,         -> number of points
+                    size_t no_cells,          -> number of cells
+                    size_t no_connectivity    -> number of entries of the connectivity, e.g. 8*no_cells for hexahedra
+                    )
+Writes an unstructured grid in the appended raw format while the data is produced, e.g. by a distributed gather or an out-of-core store.
+The fields are declared before begin(), then every array is appended in blocks of rows, one array after another in the order of the file:
+    Coordinates  -> double, 3 components per point
+    connectivity -> size_t
+    offsets      -> size_t, end of every cell in the connectivity
+    types        -> VTK_CELLTYPE or uint8_t
+    node data, cell data in the order of their declaration
+The XML header is written first with placeholders for the offsets, which are patched by finish(); the data of a block is written
+right away (compressed: once a batch of compression blocks is full). The memory is bounded by the block of the caller and
+one batch of compression blocks, the mesh is never held. The file is identical to VTK_UnstructuredGrid::write(...) in the
+appended format up to the zero padded offsets and the spaces which align the appended data.
+Example:
+    VTK_StreamingWriter writer("results/big.vtu", no_points, no_cells, 8*no_cells);
+    writer.setCompressor(VTK_ZLIB);
+    writer.addNodeData<double>("Temperature", 1);
+    writer.begin();
+    for (auto &block : point_blocks) writer.append(block.XI.data(), block.no_points);
+    ... connectivity, offsets, types and Temperature likewise ...
+    writer.finish();
+*/
+class VTK_StreamingWriter
+{
+    public:
+        VTK_StreamingWriter(std::string path_to_file, size_t no_points, size_t no_cells, size_t no_connectivity)
+        : Path_(path_to_file), NoPoints_(no_points), NoCells_(no_cells), NoConnectivity_(no_connectivity), NoThreads_(1), Current_(0), Position_(0), DataStart_(0), Begun_(false)
+        {}
+        VTK_StreamingWriter(const VTK_StreamingWriter&) = delete;
+        VTK_StreamingWriter& operator=(const VTK_StreamingWriter&) = delete;
+    public:
+        // Select the block compression (none by default), level -1 is the default level of the compressor, see VTK_DataSet::setCompressor(...)
+        void setCompressor(VTK_COMPRESSOR compressor, int level = -1) { Compressor_ = compressor; Level_ = level; }
+
+        // Number of threads compressing a batch of blocks (1 by default), the file is identical for any number of threads
+        void setNumberOfThreads(unsigned int no_threads) { NoThreads_ = no_threads > 0 ? no_threads : 1; }
+
+        // Declare the node and cell data before begin(), the values are appended later
+        template <typename T>
+        void addNodeData(const std::string name, const size_t no_components) { declare(name, VTKType(T()), sizeof(T), no_components, NoPoints_, true, true); }
+        template <typename T>
+        void addCellData(const std::string name, const size_t no_components) { declare(name, VTKType(T()), sizeof(T), no_components, NoCells_, true, false); }
+
+        // Opens the file and writes the XML header, failures throw a std::runtime_error
+        void begin();
+
+        // Appends the next no_entities packed rows of the current array
+        template <typename T>
+        void append(const T* values, size_t no_entities)
+        {
+            const size_t no_components = (Current_ < Arrays_.size()) ? Arrays_[Current_].no_components : 1;
+            append(VTK_DataArray<T>("", values, {no_entities, no_components}, {no_components*sizeof(T), sizeof(T)}));
+        }
+        void append(const VTK_CELLTYPE* types, size_t no_cells) { append(VTK_CellTypeArray(types, no_cells)); }
+
+        // Appends the rows of any VTK_Array to the current array, e.g. a strided VTK_DataArray view
+        void append(const VTK_Array& rows);
+
+        // Name of the array which is appended next, empty if all arrays are complete
+        std::string Current() const { return Current_ < Arrays_.size() ? Arrays_[Current_].name : std::string(); }
+
+        // Completes the file and patches the offsets, all arrays have to be complete
+        bool finish();
+    private:
+        struct StreamedArray
+        {
+            std::string name, type;
+            size_t value_size, no_components, no_entities;
+            bool with_components, node_data;
+            size_t tag_position;                // position of the offset placeholder in the file
+            size_t offset;                      // position of the block in the appended data
+            size_t header_position;             // compressed: position of the block header in the file
+            size_t block_entities;              // compressed: entities per compression block
+            std::vector<uint64_t> block_sizes;  // compressed: sizes of the written blocks
+            size_t written;                     // appended entities
+            size_t ByteSize() const { return no_entities*no_components*value_size; }
+        };
+        void declare(const std::string& name, const std::string& type, size_t value_size, size_t no_components, size_t no_entities, bool with_components, bool node_data);
+        void write(const char* data, size_t size, size_t position);
+        // uncompressed: pads the appended data before the next block to VTK_APPENDED_ALIGNMENT
+        void align();
+        // starts the block of the current array, completes arrays without entities
+        void startArray();
+        // compresses and writes the full blocks of the staging buffer, or all of them at the end of an array
+        void flushBlocks(bool last);
+        std::string headerBytes(const std::vector<uint64_t>& values) const;
+        VTK_ThreadPool* pool()
+        {
+            if (NoThreads_ <= 1) return nullptr;
+            if (!pool_ || pool_->NoThreads() != NoThreads_) pool_.reset(new VTK_ThreadPool(NoThreads_));
+            return pool_.get();
+        }
+    private:
+        std::string Path_;
+        size_t NoPoints_, NoCells_, NoConnectivity_;
+        VTK_COMPRESSOR Compressor_ = VTK_NO_COMPRESSION;
+        int Level_ = -1;
+        unsigned int NoThreads_;
+        std::unique_ptr<VTK_ThreadPool> pool_;
+        std::vector<StreamedArray> Arrays_;
+        size_t Current_, Position_, DataStart_;
+        bool Begun_, UInt64Header_ = false;
+        std::ofstream OUTFILE;
+        std::vector<char> Staging_;  // compressed: the entities of the current array which are not compressed yet
+        std::vector<char> Buffer_;   // gathered rows of strided arrays
+        // zero padded width of the patched offsets
+        static constexpr size_t OffsetDigits = 20;
+};
+
+inline void VTK_StreamingWriter::declare(const std::string& name, const std::string& type, size_t value_size, size_t no_components, size_t no_entities, bool with_components, bool node_data)
+{
+    if (Begun_) throw std::runtime_error("Error declaring DataArray "+name+"! The file "+Path_+" has already begun.");
+    if (no_components == 0) throw std::runtime_error("Error declaring DataArray "+name+"! It has no components.");
+    StreamedArray data = {};
+    data.name = name;
+    data.type = type;
+    data.value_size = value_size;
+    data.no_components = no_components;
+    data.no_entities = no_entities;
+    data.with_components = with_components;
+    data.node_data = node_data;
+    Arrays_.push_back(data);
+}
+
+inline void VTK_StreamingWriter::begin()
+{
+    if (Begun_) throw std::runtime_error("Error writing "+Path_+"! begin() is called twice.");
+    // the geometry arrays come first, written in the types of VTK_UnstructuredGrid
+    std::vector<StreamedArray> fields;
+    fields.swap(Arrays_);
+    declare("Coordinates", "Float64", sizeof(double), 3, NoPoints_, true, true);
+    if (NoPoints_ <= size_t(UINT32_MAX)+1) declare("connectivity", "UInt32", sizeof(uint32_t), 1, NoConnectivity_, false, false);
+    else declare("connectivity", "Int64", sizeof(int64_t), 1, NoConnectivity_, false, false);
+    if (NoConnectivity_ <= INT32_MAX) declare("offsets", "Int32", sizeof(int32_t), 1, NoCells_, false, false);
+    else declare("offsets", "Int64", sizeof(int64_t), 1, NoCells_, false, false);
+    declare("types", "UInt8", sizeof(uint8_t), 1, NoCells_, false, false);
+    for (auto &data : fields) if (data.node_data) Arrays_.push_back(data);
+    for (auto &data : fields) if (!data.node_data) Arrays_.push_back(data);
+    Begun_ = true;
+
+    const bool compressed = (Compressor_ != VTK_NO_COMPRESSION);
+    for (auto &data : Arrays_)
+    {
+        UInt64Header_ |= data.ByteSize() > UINT32_MAX;
+        data.block_entities = std::max<size_t>(1, VTK_COMPRESSION_BLOCK_BYTES/(data.no_components*data.value_size));
+    }
+    // test the compressor before anything is written
+    if (compressed)
+    {
+        std::vector<char> test;
+        VTK_CompressBlock(Compressor_, Level_, "", 0, test);
+    }
+
+    OUTFILE.open(Path_, std::ios::binary | std::ios::trunc);
+    if (!OUTFILE.is_open()) throw std::runtime_error("Error opening "+Path_+"!");
+    std::string header = "<?xml version=\"1.0\" ?>\n";
+    header += std::string("<VTKFile byte_order=\"LittleEndian\" header_type=\"")+(UInt64Header_ ? "UInt64" : "UInt32")+"\" ";
+    if (compressed) header += "compressor=\""+VTKCompressorName(Compressor_)+"\" ";
+    header += "type=\"UnstructuredGrid\" version=\"1.0\">\n";
+    header += "<UnstructuredGrid>\n";
+    header += "<Piece NumberOfCells=\""+std::to_string(NoCells_)+"\" NumberOfPoints=\""+std::to_string(NoPoints_)+"\">\n";
+    auto tag = [&](StreamedArray& data)
+    {
+        header += "<DataArray Name=\""+data.name+"\" ";
+        if (data.with_components) header += "NumberOfComponents=\""+std::to_string(data.no_components)+"\" ";
+        header += "format=\"appended\" type=\""+data.type+"\" offset=\"";
+        data.tag_position = header.size();
+        header += std::string(OffsetDigits, '0')+"\" />\n";
+    };
+    header += "<Points>\n";
+    tag(Arrays_[0]);
+    header += "</Points>\n<Cells>\n";
+    for (size_t a=1; a<4; a++) tag(Arrays_[a]);
+    header += "</Cells>\n<PointData>\n";
+    for (size_t a=4; a<Arrays_.size(); a++) if (Arrays_[a].node_data) tag(Arrays_[a]);
+    header += "</PointData>\n<CellData>\n";
+    for (size_t a=4; a<Arrays_.size(); a++) if (!Arrays_[a].node_data) tag(Arrays_[a]);
+    header += "</CellData>\n</Piece>\n</UnstructuredGrid>\n";
+    header += VTK_AppendedDataStart(header.size(), UInt64Header_);
+    write(header.data(), header.size(), 0);
+    DataStart_ = Position_;
+    Current_ = 0;
+    startArray();
+}
+
+inline void VTK_StreamingWriter::write(const char* data, size_t size, size_t position)
+{
+    if (position != Position_) OUTFILE.seekp(static_cast<std::streamoff>(position));
+    OUTFILE.write(data, size);
+    if (!OUTFILE) throw std::runtime_error("Error writing "+Path_+"!");
+    if (position != Position_) OUTFILE.seekp(static_cast<std::streamoff>(Position_));
+    else Position_ += size;
+}
+
+inline void VTK_StreamingWriter::align()
+{
+    if (Compressor_ != VTK_NO_COMPRESSION) return;
+    const std::string padding(VTK_AppendedPadding(Position_-DataStart_), '\0');
+    write(padding.data(), padding.size(), Position_);
+}
+
+inline std::string VTK_StreamingWriter::headerBytes(const std::vector<uint64_t>& values) const
+{
+    std::string bytes;
+    for (auto &value : values)
+    {
+        const uint32_t value32 = static_cast<uint32_t>(value);
+        if (UInt64Header_) bytes.append(reinterpret_cast<const char*>(&value), sizeof(uint64_t));
+        else bytes.append(reinterpret_cast<const char*>(&value32), sizeof(uint32_t));
+    }
+    return bytes;
+}
+
+inline void VTK_StreamingWriter::startArray()
+{
+    for (; Current_ < Arrays_.size(); Current_++)
+    {
+        StreamedArray& data = Arrays_[Current_];
+        align();
+        data.offset = Position_-DataStart_;
+        if (Compressor_ == VTK_NO_COMPRESSION)
+        {
+            const std::string header = VTK_BlockHeader(data.ByteSize(), UInt64Header_);
+            write(header.data(), header.size(), Position_);
+        }
+        else
+        {
+            // the header is reserved and patched once the sizes of the blocks are known
+            const size_t no_blocks = (data.no_entities+data.block_entities-1)/data.block_entities;
+            data.header_position = Position_;
+            const std::string header = headerBytes(std::vector<uint64_t>(3+no_blocks, 0));
+            write(header.data(), header.size(), Position_);
+            if (no_blocks == 0)
+            {
+                const std::string empty = headerBytes({0, data.block_entities*data.no_components*data.value_size, 0});
+                write(empty.data(), empty.size(), data.header_position);
+            }
+        }
+        if (data.no_entities > 0) return;
+    }
+}
+
+inline void VTK_StreamingWriter::append(const VTK_Array& rows)
+{
+    if (!Begun_) throw std::runtime_error("Error writing "+Path_+"! Call begin() first.");
+    if (Current_ >= Arrays_.size()) throw std::runtime_error("Error writing "+Path_+"! All arrays are complete.");
+    StreamedArray& data = Arrays_[Current_];
+    if (rows.NoComponents() != data.no_components) throw std::runtime_error("Error writing DataArray "+data.name+"! Expected "+std::to_string(data.no_components)+" components, got "+std::to_string(rows.NoComponents()));
+    if (data.written+rows.NoEntities() > data.no_entities) throw std::runtime_error("Error writing DataArray "+data.name+"! Expected "+std::to_string(data.no_entities)+" entities, got "+std::to_string(data.written+rows.NoEntities()));
+
+    // the size_t connectivity and offsets are converted to the written types
+    std::unique_ptr<VTK_Array> converted;
+    if (rows.Type() != data.type && rows.Type() == "UInt64" && rows.ValueSize() == sizeof(size_t))
+    {
+        if (data.type == "UInt32") converted.reset(new VTK_ConvertedArray<size_t, uint32_t>(rows));
+        else if (data.type == "Int32") converted.reset(new VTK_ConvertedArray<size_t, int32_t>(rows));
+        else if (data.type == "Int64") converted.reset(new VTK_ConvertedArray<size_t, int64_t>(rows));
+    }
+    const VTK_Array& values = converted ? *converted : rows;
+    if (values.Type() != data.type || values.ValueSize() != data.value_size) throw std::runtime_error("Error writing DataArray "+data.name+"! Expected type "+data.type+", got "+rows.Type());
+
+    const size_t entity_bytes = data.no_components*data.value_size;
+    if (Compressor_ != VTK_NO_COMPRESSION)
+    {
+        // staged until a batch of blocks is full
+        const size_t batch_bytes = 4*NoThreads_*data.block_entities*entity_bytes;
+        for (size_t first=0; first<values.NoEntities(); )
+        {
+            const size_t n = std::min(values.NoEntities()-first, (batch_bytes-Staging_.size())/entity_bytes);
+            const size_t size = Staging_.size();
+            Staging_.resize(size+n*entity_bytes);
+            values.gather(first, n, Staging_.data()+size);
+            first += n;
+            data.written += n;
+            if (Staging_.size() == batch_bytes) flushBlocks(false);
+        }
+    }
+    else if (const char* raw = values.ContiguousData())
+    {
+        write(raw, values.ByteSize(), Position_);
+        data.written += values.NoEntities();
+    }
+    else
+    {
+        const size_t chunk = std::max<size_t>(1, VTK_RAW_CHUNK_BYTES/entity_bytes);
+        for (size_t first=0; first<values.NoEntities(); first+=chunk)
+        {
+            const size_t n = std::min(chunk, values.NoEntities()-first);
+            Buffer_.resize(n*entity_bytes);
+            values.gather(first, n, Buffer_.data());
+            write(Buffer_.data(), Buffer_.size(), Position_);
+        }
+        data.written += values.NoEntities();
+    }
+
+    if (data.written < data.no_entities) return;
+    if (Compressor_ != VTK_NO_COMPRESSION) flushBlocks(true);
+    Current_++;
+    startArray();
+}
+
+inline void VTK_StreamingWriter::flushBlocks(bool last)
+{
+    StreamedArray& data = Arrays_[Current_];
+    const size_t block_bytes = data.block_entities*data.no_components*data.value_size;
+    const size_t no_blocks = last ? (Staging_.size()+block_bytes-1)/block_bytes : Staging_.size()/block_bytes;
+    std::vector<std::vector<char>> blocks(no_blocks);
+    VTK_ParallelFor(pool(), no_blocks, [&](size_t b)
+    {
+        const size_t size = std::min(block_bytes, Staging_.size()-b*block_bytes);
+        VTK_CompressBlock(Compressor_, Level_, Staging_.data()+b*block_bytes, size, blocks[b]);
+    });
+    for (auto &block : blocks)
+    {
+        write(block.data(), block.size(), Position_);
+        data.block_sizes.push_back(block.size());
+    }
+    Staging_.erase(Staging_.begin(), Staging_.begin()+std::min(Staging_.size(), no_blocks*block_bytes));
+    if (!last) return;
+
+    // all blocks are written, the header takes their sizes
+    const size_t total = data.ByteSize();
+    std::vector<uint64_t> values = {data.block_sizes.size(), block_bytes, total-(data.block_sizes.size()-1)*block_bytes};
+    values.insert(values.end(), data.block_sizes.begin(), data.block_sizes.end());
+    const std::string header = headerBytes(values);
+    write(header.data(), header.size(), data.header_position);
+    data.block_sizes = std::vector<uint64_t>();
+}
+
+inline bool VTK_StreamingWriter::finish()
+{
+    if (!Begun_) throw std::runtime_error("Error writing "+Path_+"! Call begin() first.");
+    if (Current_ < Arrays_.size()) throw std::runtime_error("Error writing "+Path_+"! DataArray "+Arrays_[Current_].name+" has "+std::to_string(Arrays_[Current_].written)+" of "+std::to_string(Arrays_[Current_].no_entities)+" entities.");
+    align();
+    const std::string end = "\n</AppendedData>\n</VTKFile>\n";
+    write(end.data(), end.size(), Position_);
+    for (auto &data : Arrays_)
+    {
+        std::string offset = std::to_string(data.offset);
+        offset.insert(0, OffsetDigits-offset.size(), '0');
+        write(offset.data(), offset.size(), data.tag_position);
+    }
+    OUTFILE.close();
+    if (OUTFILE.fail()) throw std::runtime_error("Error writing "+Path_+"!");
+    Staging_ = std::vector<char>();
+    Buffer_ = std::vector<char>();
+    return true;
+}
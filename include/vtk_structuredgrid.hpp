@@ -0,0 +1,122 @@
+#pragma once
+
+#include <array>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <stdexcept>
+
+#include <vtk_array.hpp>
+#include <vtk_asciiformatter.hpp>
+#include <vtk_dataset.hpp>
+
+// Values of an attribute separated by spaces, e.g. Origin="0 0.5 1", floating point values in their shortest representation
+template <typename T, size_t N>
+inline std::string VTK_AttributeValues(const std::array<T, N>& values)
+{
+    VTK_AsciiFormatter formatter(0, 256);
+    for (auto &value : values) formatter.value(value);
+    return std::string(formatter.data(), formatter.size()-1);
+}
+
+// Extent "0 nx-1 0 ny-1 0 nz-1" of a structured dataset with no_points points per direction
+inline std::string VTK_Extent(const std::array<size_t, 3>& no_points)
+{
+    return VTK_AttributeValues(std::array<size_t, 6>{0, no_points[0]-1, 0, no_points[1]-1, 0, no_points[2]-1});
+}
+
+// Cells of a structured dataset, directions with a single point do not count (e.g. nz=1 for 2D data)
+inline size_t VTK_StructuredCells(const std::array<size_t, 3>& no_points)
+{
+    size_t no_cells = 1;
+    for (auto &n : no_points) no_cells *= std::max<size_t>(n, 2)-1;
+    return no_cells;
+}
+
+/*
+VTK_ImageData(
+              std::array<size_t, 3> no_points, -> points in x, y and z direction, 1 for the unused directions of 2D and 1D data
+              std::array<double, 3> origin,    -> coordinates of the first point
+              std::array<double, 3> spacing    -> distance of the points in x, y and z direction
+              )
+Uniform grid written as .vti: only origin, spacing and extent describe the geometry, no points or cells are stored.
+Fields are added as for VTK_UnstructuredGrid, the points are numbered x fastest, then y, then z (cells likewise).
+Example:
+    VTK_ImageData VTKOUT({101, 101, 51}, {0.0, 0.0, 0.0}, {0.01, 0.01, 0.02});
+    VTKOUT.addNodeData("Temperature", Temperature, 1);
+    VTKOUT.addCellData("Velocity", Velocity, 3);
+    VTKOUT.write("results/grid.vti");
+*/
+class VTK_ImageData : public VTK_DataSet
+{
+    public:
+        VTK_ImageData(std::array<size_t, 3> no_points, std::array<double, 3> origin = {0.0, 0.0, 0.0}, std::array<double, 3> spacing = {1.0, 1.0, 1.0})
+        : NoPoints_(no_points), Origin_(origin), Spacing_(spacing)
+        {
+            if (std::find(no_points.begin(), no_points.end(), 0) != no_points.end()) throw std::runtime_error("Error reading ImageData! Every direction needs at least one point, got "+VTK_AttributeValues(no_points));
+        }
+    public:
+        size_t NoPoints() const {return NoPoints_[0]*NoPoints_[1]*NoPoints_[2];}
+        size_t NoCells() const {return VTK_StructuredCells(NoPoints_);}
+        const std::array<size_t, 3>& Dimensions() const {return NoPoints_;}
+        const std::array<double, 3>& Origin() const {return Origin_;}
+        const std::array<double, 3>& Spacing() const {return Spacing_;}
+    private:
+        bool writeSink(VTK_Sink& sink, VTK_WriteStatistics* statistics)
+        {
+            const std::string extent = VTK_Extent(NoPoints_);
+            const VTK_DataSetLayout layout = {"ImageData", "WholeExtent=\""+extent+"\" Origin=\""+VTK_AttributeValues(Origin_)+"\" Spacing=\""+VTK_AttributeValues(Spacing_)+"\"",
+                                              "Extent=\""+extent+"\"", {}};
+            const std::vector<const VTK_Array*> node_data(NodeData_.begin(), NodeData_.end()), cell_data(CellData_.begin(), CellData_.end());
+            return VTK_WriteDataSet(sink, settings_, layout, {}, nullptr, node_data, cell_data, pool(), statistics);
+        }
+    private:
+        std::array<size_t, 3> NoPoints_;
+        std::array<double, 3> Origin_, Spacing_;
+};
+
+/*
+VTK_RectilinearGrid(
+                    const double* x, size_t nx,  -> coordinates of the grid lines in x direction
+                    const double* y, size_t ny,  -> ... in y direction
+                    const double* z, size_t nz   -> ... in z direction, a single coordinate for 2D data
+                    )
+Grid of axis aligned lines with arbitrary spacing written as .vtr: only the three axis coordinate arrays are stored.
+As VTK_DataArray the coordinates are viewed, the buffers have to stay alive until the grid is written.
+Fields are added as for VTK_UnstructuredGrid, the points are numbered x fastest, then y, then z (cells likewise).
+Example:
+    VTK_RectilinearGrid VTKOUT(x, y, z);
+    VTKOUT.addCellData("Pressure", Pressure, 1);
+    VTKOUT.write("results/grid.vtr");
+*/
+class VTK_RectilinearGrid : public VTK_DataSet
+{
+    public:
+        VTK_RectilinearGrid(const double* x, size_t nx, const double* y, size_t ny, const double* z, size_t nz)
+        : NoPoints_{nx, ny, nz},
+          X_("x_coordinates", x, {nx, 1}, {sizeof(double), sizeof(double)}),
+          Y_("y_coordinates", y, {ny, 1}, {sizeof(double), sizeof(double)}),
+          Z_("z_coordinates", z, {nz, 1}, {sizeof(double), sizeof(double)})
+        {
+            if (nx == 0 || ny == 0 || nz == 0) throw std::runtime_error("Error reading RectilinearGrid! Every direction needs at least one coordinate, got "+VTK_AttributeValues(NoPoints_));
+        }
+
+        // convenience overload for the coordinates in vectors
+        VTK_RectilinearGrid(const std::vector<double> &x, const std::vector<double> &y, const std::vector<double> &z)
+        : VTK_RectilinearGrid(x.data(), x.size(), y.data(), y.size(), z.data(), z.size()) {}
+    public:
+        size_t NoPoints() const {return NoPoints_[0]*NoPoints_[1]*NoPoints_[2];}
+        size_t NoCells() const {return VTK_StructuredCells(NoPoints_);}
+        const std::array<size_t, 3>& Dimensions() const {return NoPoints_;}
+    private:
+        bool writeSink(VTK_Sink& sink, VTK_WriteStatistics* statistics)
+        {
+            const std::string extent = VTK_Extent(NoPoints_);
+            const VTK_DataSetLayout layout = {"RectilinearGrid", "WholeExtent=\""+extent+"\"", "Extent=\""+extent+"\"", {{"Coordinates", 3, false}}};
+            const std::vector<const VTK_Array*> node_data(NodeData_.begin(), NodeData_.end()), cell_data(CellData_.begin(), CellData_.end());
+            return VTK_WriteDataSet(sink, settings_, layout, {&X_, &Y_, &Z_}, nullptr, node_data, cell_data, pool(), statistics);
+        }
+    private:
+        std::array<size_t, 3> NoPoints_;
+        VTK_DataArray<double> X_, Y_, Z_;
+};
@@ -0,0 +1,172 @@
+#pragma once
+
+#include <array>
+#include <vector>
+#include <memory>
+#include <cstdint>
+#include <algorithm>
+
+#include <vtk_array.hpp>
+#include <vtk_cells.hpp>
+#include <vtk_threadpool.hpp>
+
+/*
+Boundary of a volume grid: the faces of the 3D cells which belong to exactly one cell, see VTK_ExtractSurface(...).
+connectivity, offsets -> the faces as polygons in CSR format, numbered by the used points
+node_ids              -> the used points of the grid in ascending order, point i of the surface is point node_ids[i] of the grid
+cell_ids              -> the cell of every face
+*/
+struct VTK_Surface
+{
+    std::vector<size_t> connectivity, offsets;
+    std::shared_ptr<std::vector<size_t>> node_ids, cell_ids;
+};
+
+// Key of a face: its sorted corner nodes, unused entries are SIZE_MAX
+typedef std::array<size_t, 4> VTK_FaceKey;
+
+struct VTK_FaceKeyHash
+{
+    size_t operator()(const VTK_FaceKey& key) const
+    {
+        uint64_t hash = 0;
+        for (auto &node : key) hash = (hash ^ node)*0x9E3779B97F4A7C15ull;
+        return static_cast<size_t>(hash ^ (hash >> 29));
+    }
+};
+
+/*
+Finds the boundary faces of the 3D cell types with faces in VTK_CELL_FACES(...), all other cells are skipped.
+The faces are hashed by their corner nodes: every range of cells sorts its faces into partitions by the hash,
+every partition counts its faces in a hash table, faces counted once are on the boundary. Ranges and partitions
+are processed in parallel on the pool, the faces are ordered by cell and face, the result does not depend on the number of threads.
+*/
+inline std::shared_ptr<const VTK_Surface> VTK_ExtractSurface(const VTK_Array& connectivity, const VTK_CellOffsetArray& offsets, const VTK_CellTypeArray& types, VTK_ThreadPool* pool)
+{
+    const size_t no_cells = offsets.NoEntities();
+    const size_t no_tasks = (pool != nullptr) ? 4*pool->NoThreads() : 1;
+    auto first_cell = [&](size_t t) { return t*no_cells/no_tasks; };
+    // nodes of the cells [first, last) one after another, returns the position of the first node in the connectivity
+    auto cellNodes = [&](size_t first, size_t last, std::vector<size_t>& nodes)
+    {
+        const size_t first_node = (first == 0) ? 0 : offsets.offset(first-1);
+        const size_t last_node = (last == 0) ? 0 : offsets.offset(last-1);
+        nodes.resize(last_node-first_node);
+        connectivity.gatherBytes(first_node*sizeof(size_t), nodes.size()*sizeof(size_t), reinterpret_cast<char*>(nodes.data()));
+        return first_node;
+    };
+    auto corner_step = [](VTK_CELLTYPE type) { return (type == VTK_QUADRATIC_TETRA || type == VTK_QUADRATIC_HEXAHEDRON) ? 2 : 1; };
+
+    // the faces of every range sorted into the partitions of their keys
+    struct Face
+    {
+        VTK_FaceKey key;
+        size_t cell;
+        unsigned int face;
+    };
+    std::vector<std::vector<Face>> partitions(no_tasks*no_tasks);
+    VTK_ParallelFor(pool, no_tasks, [&](size_t t)
+    {
+        std::vector<size_t> nodes;
+        const size_t first_node = cellNodes(first_cell(t), first_cell(t+1), nodes);
+        // at most 6 faces per cell, evenly spread over the partitions
+        for (size_t p=0; p<no_tasks; p++) partitions[t*no_tasks+p].reserve(6*(first_cell(t+1)-first_cell(t))/no_tasks*9/8+16);
+        size_t begin = 0;
+        for (size_t cell=first_cell(t); cell<first_cell(t+1); cell++)
+        {
+            const VTK_CELLTYPE type = types.type(cell);
+            const auto &faces = VTK_CELL_FACES(type);
+            const size_t step = corner_step(type);
+            for (unsigned int f=0; f<faces.size(); f++)
+            {
+                Face face = {{SIZE_MAX, SIZE_MAX, SIZE_MAX, SIZE_MAX}, cell, f};
+                for (size_t i=0; i<faces[f].size(); i+=step) face.key[i/step] = nodes[begin+faces[f][i]];
+                std::sort(face.key.begin(), face.key.end());
+                partitions[t*no_tasks+(VTK_FaceKeyHash()(face.key) >> 40)%no_tasks].push_back(face);
+            }
+            begin = offsets.offset(cell)-first_node;
+        }
+    });
+
+    // faces which are found once, per partition in a hash table with linear probing which is at most half full
+    std::vector<std::vector<std::pair<size_t, unsigned int>>> boundary(no_tasks);
+    VTK_ParallelFor(pool, no_tasks, [&](size_t p)
+    {
+        size_t no_faces = 0;
+        for (size_t t=0; t<no_tasks; t++) no_faces += partitions[t*no_tasks+p].size();
+        size_t capacity = 16;
+        while (capacity < 2*no_faces) capacity *= 2;
+        std::vector<std::pair<const Face*, size_t>> count(capacity, std::make_pair(nullptr, 0));
+        for (size_t t=0; t<no_tasks; t++)
+            for (auto &face : partitions[t*no_tasks+p])
+            {
+                size_t slot = VTK_FaceKeyHash()(face.key) & (capacity-1);
+                while (count[slot].first != nullptr && count[slot].first->key != face.key) slot = (slot+1) & (capacity-1);
+                if (count[slot].first == nullptr) count[slot].first = &face;
+                count[slot].second++;
+            }
+        for (auto &entry : count)
+            if (entry.second == 1) boundary[p].push_back({entry.first->cell, entry.first->face});
+    });
+    partitions.clear();
+    partitions.shrink_to_fit();
+    std::vector<uint8_t> mask(no_cells, 0);
+    for (auto &faces : boundary)
+        for (auto &face : faces) mask[face.first] |= uint8_t(1) << face.second;
+    boundary.clear();
+
+    // the boundary faces in the order of the cells, counted per range before they are filled in
+    std::vector<size_t> first_face(no_tasks+1, 0), first_entry(no_tasks+1, 0);
+    VTK_ParallelFor(pool, no_tasks, [&](size_t t)
+    {
+        for (size_t cell=first_cell(t); cell<first_cell(t+1); cell++)
+        {
+            const auto &faces = VTK_CELL_FACES(types.type(cell));
+            for (unsigned int f=0; f<faces.size(); f++)
+                if (mask[cell] & (uint8_t(1) << f))
+                {
+                    first_face[t+1]++;
+                    first_entry[t+1] += faces[f].size();
+                }
+        }
+    });
+    for (size_t t=0; t<no_tasks; t++)
+    {
+        first_face[t+1] += first_face[t];
+        first_entry[t+1] += first_entry[t];
+    }
+    auto surface = std::make_shared<VTK_Surface>();
+    surface->connectivity.resize(first_entry[no_tasks]);
+    surface->offsets.resize(first_face[no_tasks]+1, 0);
+    surface->cell_ids = std::make_shared<std::vector<size_t>>(first_face[no_tasks]);
+    VTK_ParallelFor(pool, no_tasks, [&](size_t t)
+    {
+        std::vector<size_t> nodes;
+        const size_t first_node = cellNodes(first_cell(t), first_cell(t+1), nodes);
+        size_t face_index = first_face[t], entry = first_entry[t], begin = 0;
+        for (size_t cell=first_cell(t); cell<first_cell(t+1); cell++)
+        {
+            const auto &faces = VTK_CELL_FACES(types.type(cell));
+            for (unsigned int f=0; f<faces.size(); f++)
+            {
+                if (!(mask[cell] & (uint8_t(1) << f))) continue;
+                for (auto &node : faces[f]) surface->connectivity[entry++] = nodes[begin+node];
+                surface->offsets[face_index+1] = entry;
+                (*surface->cell_ids)[face_index++] = cell;
+            }
+            begin = offsets.offset(cell)-first_node;
+        }
+    });
+
+    // the used points, sorted to keep the order of the grid
+    surface->node_ids = std::make_shared<std::vector<size_t>>(surface->connectivity);
+    std::vector<size_t>& node_ids = *surface->node_ids;
+    std::sort(node_ids.begin(), node_ids.end());
+    node_ids.erase(std::unique(node_ids.begin(), node_ids.end()), node_ids.end());
+    VTK_ParallelFor(pool, no_tasks, [&](size_t t)
+    {
+        const size_t first = t*surface->connectivity.size()/no_tasks, last = (t+1)*surface->connectivity.size()/no_tasks;
+        for (size_t i=first; i<last; i++) surface->connectivity[i] = std::lower_bound(node_ids.begin(), node_ids.end(), surface->connectivity[i])-node_ids.begin();
+    });
+    return surface;
+}
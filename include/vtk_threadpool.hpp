@@ -0,0 +1,122 @@
+#pragma once
+
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <functional>
+#include <exception>
+
+/*
+VTK_ThreadPool(
+               unsigned int no_threads_   -> number of threads working on a job, including the calling thread
+               )
+Small pool of persistent worker threads used to encode the data arrays in parallel.
+A job is a set of independent tasks [0, no_tasks) which are pulled by the workers and the calling thread.
+parallel_for(...) returns when all tasks are done, the first exception thrown by a task is rethrown.
+Example:
+    VTK_ThreadPool pool(4);
+    pool.parallel_for(blocks.size(), [&](size_t i){ compress(blocks[i]); });
+*/
+class VTK_ThreadPool
+{
+    public:
+        VTK_ThreadPool(unsigned int no_threads_)
+        : NoThreads_(no_threads_ > 0 ? no_threads_ : 1), Generation_(0), Running_(0), Stop_(false)
+        {
+            for (unsigned int i=1; i<NoThreads_; i++) Workers_.emplace_back([this]{ work(); });
+        }
+        ~VTK_ThreadPool()
+        {
+            {
+                std::lock_guard<std::mutex> lock(Mutex_);
+                Stop_ = true;
+            }
+            Wakeup_.notify_all();
+            for (auto &worker : Workers_) worker.join();
+        }
+        VTK_ThreadPool(const VTK_ThreadPool&) = delete;
+        VTK_ThreadPool& operator=(const VTK_ThreadPool&) = delete;
+    public:
+        unsigned int NoThreads() const {return NoThreads_;}
+
+        // Calls task(i) for every i in [0, no_tasks) and waits for all of them
+        void parallel_for(size_t no_tasks, const std::function<void(size_t)>& task)
+        {
+            if (no_tasks == 0) return;
+            if (NoThreads_ == 1 || no_tasks == 1)
+            {
+                for (size_t i=0; i<no_tasks; i++) task(i);
+                return;
+            }
+            {
+                std::lock_guard<std::mutex> lock(Mutex_);
+                Task_ = &task;
+                NoTasks_ = no_tasks;
+                NextTask_ = 0;
+                Error_ = nullptr;
+                Running_ = NoThreads_ - 1;
+                Generation_++;
+            }
+            Wakeup_.notify_all();
+            run();
+            std::unique_lock<std::mutex> lock(Mutex_);
+            Done_.wait(lock, [this]{ return Running_ == 0; });
+            Task_ = nullptr;
+            if (Error_) std::rethrow_exception(Error_);
+        }
+    private:
+        // pulls tasks of the current job until none is left
+        void run()
+        {
+            for (size_t i=NextTask_++; i<NoTasks_; i=NextTask_++)
+            {
+                try { (*Task_)(i); }
+                catch (...)
+                {
+                    std::lock_guard<std::mutex> lock(Mutex_);
+                    if (!Error_) Error_ = std::current_exception();
+                    NextTask_ = NoTasks_;
+                }
+            }
+        }
+        void work()
+        {
+            size_t generation = 0;
+            while (true)
+            {
+                {
+                    std::unique_lock<std::mutex> lock(Mutex_);
+                    Wakeup_.wait(lock, [&]{ return Stop_ || Generation_ != generation; });
+                    if (Stop_) return;
+                    generation = Generation_;
+                }
+                run();
+                {
+                    std::lock_guard<std::mutex> lock(Mutex_);
+                    Running_--;
+                }
+                Done_.notify_one();
+            }
+        }
+    private:
+        unsigned int NoThreads_;
+        std::vector<std::thread> Workers_;
+        std::mutex Mutex_;
+        std::condition_variable Wakeup_, Done_;
+        const std::function<void(size_t)>* Task_ = nullptr;
+        size_t NoTasks_ = 0;
+        std::atomic<size_t> NextTask_{0};
+        std::exception_ptr Error_;
+        size_t Generation_;
+        unsigned int Running_;
+        bool Stop_;
+};
+
+// Runs task(i) for i in [0, no_tasks) on the pool, or sequentially if there is no pool
+inline void VTK_ParallelFor(VTK_ThreadPool* pool, size_t no_tasks, const std::function<void(size_t)>& task)
+{
+    if (pool != nullptr) pool->parallel_for(no_tasks, task);
+    else for (size_t i=0; i<no_tasks; i++) task(i);
+}
@@ -0,0 +1,285 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <exception>
+#include <fstream>
+#include <charconv>
+#include <functional>
+
+#include <vtk_unstructuredgrid.hpp>
+
+/*
+VTK_TimeSeries(
+               std::string basename_   -> e.g. "results/run" writes "results/run.pvd" and "results/run_000000.vtu", ...
+               )
+Writes a series of unstructured grids and the .pvd collection which lists them with their time.
+The mesh is set once, Points and Cells are encoded a single time and the bytes are reused for every step
+until setPoints(...) or setElements(...) is called again.
+addNodeData(...)/addCellData(...) copy the field into a snapshot, write(time) hands the snapshot to a background thread
+which encodes and writes the file. The series is double buffered: while one step is written, the next one can be
+copied, write(time) blocks only if the previous step is still being written.
+Example:
+    VTK_TimeSeries series("results/run");
+    series.setFormat(VTK_APPENDED_RAW);
+    series.setPoints(XI);
+    series.setElements(Elmt, VTK_HEXAHEDRON);
+    for (...)
+    {
+        series.addNodeData("Temperature", T, 1);
+        series.write(time);
+    }
+    series.finish();
+*/
+class VTK_TimeSeries
+{
+    public:
+        VTK_TimeSeries(std::string basename_)
+        : BaseName_(basename_), NoSteps_(0), Busy_(false), Stop_(false)
+        {
+            const size_t slash = BaseName_.find_last_of("/\\");
+            FileName_ = (slash == std::string::npos) ? BaseName_ : BaseName_.substr(slash+1);
+            Writer_ = std::thread([this]{ work(); });
+        }
+        ~VTK_TimeSeries()
+        {
+            {
+                std::lock_guard<std::mutex> lock(Mutex_);
+                Stop_ = true;
+            }
+            Wakeup_.notify_all();
+            Writer_.join();
+        }
+        VTK_TimeSeries(const VTK_TimeSeries&) = delete;
+        VTK_TimeSeries& operator=(const VTK_TimeSeries&) = delete;
+    public:
+        // Settings of all steps, see VTK_UnstructuredGrid
+        void setFormat(VTK_OUTPUTFORMAT format) { Mesh_.setFormat(format); Geometry_.reset(); }
+        void setCompressor(VTK_COMPRESSOR compressor, int level = -1) { Mesh_.setCompressor(compressor, level); Geometry_.reset(); }
+        void setPrecision(int digits) { Mesh_.setPrecision(digits); Geometry_.reset(); }
+        void setFloat32Fields(bool float32) { Mesh_.setFloat32Fields(float32); Geometry_.reset(); }
+        void setWriteSettings(const VTK_WriteSettings& settings) { Mesh_.setWriteSettings(settings); Geometry_.reset(); }
+        // Number of threads encoding one step next to the writer thread (1 by default)
+        void setNumberOfThreads(unsigned int no_threads)
+        {
+            finish();
+            Mesh_.setNumberOfThreads(no_threads);
+            Pool_.reset(no_threads > 1 ? new VTK_ThreadPool(no_threads) : nullptr);
+        }
+
+        // Statistics of every step, see VTK_UnstructuredGrid::setStatisticsCallback(...),
+        // the callback is called on the writer thread
+        void setStatisticsCallback(std::function<void(const VTK_WriteStatistics&)> callback) { finish(); StatisticsCallback_ = std::move(callback); }
+        void setStatisticsSidecar(bool sidecar) { finish(); StatisticsSidecar_ = sidecar; }
+
+        // Sink of the step files, see VTK_UnstructuredGrid::setFileBackend(...)
+        void setFileBackend(VTK_FILEBACKEND backend) { finish(); FileBackend_ = backend; }
+
+        // Mesh of the following steps, the buffers are only read until the next write(time)
+        bool setPoints(const double* data_start_, std::array<size_t, 2> shape_, std::array<size_t, 2> strides_) { Geometry_.reset(); return Mesh_.setPoints(data_start_, shape_, strides_); }
+        bool setPoints(const std::vector<double> &XI) { Geometry_.reset(); return Mesh_.setPoints(XI); }
+        bool setElements(const size_t* data_start_, std::array<size_t, 2> shape_, std::array<size_t, 2> strides_, VTK_CELLTYPE vtkcelltype) { Geometry_.reset(); return Mesh_.setElements(data_start_, shape_, strides_, vtkcelltype); }
+        bool setElements(const std::vector<size_t> &Elmt, VTK_CELLTYPE vtkcelltype) { Geometry_.reset(); return Mesh_.setElements(Elmt, vtkcelltype); }
+        bool setElements(const std::vector<size_t> &Elmt, const std::vector<VTK_CellBlock> &blocks) { Geometry_.reset(); return Mesh_.setElements(Elmt, blocks); }
+        bool setElements(const std::vector<size_t> &Elmt, const std::vector<size_t> &offsets, const std::vector<VTK_CELLTYPE> &types) { Geometry_.reset(); return Mesh_.setElements(Elmt, offsets, types); }
+        bool setFaces(const std::vector<size_t> &faces, const std::vector<size_t> &faceoffsets) { Geometry_.reset(); return Mesh_.setFaces(faces, faceoffsets); }
+
+        // Fields of the current step, copied immediately
+        template <typename T>
+        bool addCellData(const std::string name, const T* data_start_, std::array<size_t, 2> shape_, std::array<size_t, 2> strides_)
+        {
+            if (shape_[0] != Mesh_.NoCells()) throw std::runtime_error("Error adding CellData! Number of CellData does not match number of present elements");
+            CellData_.emplace_back(new VTK_OwnedDataArray<T>(VTK_DataArray<T>(name, data_start_, shape_, strides_), recycle()));
+            return true;
+        }
+        template <typename T>
+        bool addCellData(const std::string name, const std::vector<T> &data_vector, const size_t no_components) { return addCellData(name, data_vector.data(), {Mesh_.NoCells(), no_components}, {sizeof(T)*no_components, sizeof(T)}); }
+
+        template <typename T>
+        bool addNodeData(const std::string name, const T* data_start_, std::array<size_t, 2> shape_, std::array<size_t, 2> strides_)
+        {
+            if (shape_[0] != Mesh_.NoPoints()) throw std::runtime_error("Error adding NodeData! Number of NodeData does not match number of present nodes");
+            NodeData_.emplace_back(new VTK_OwnedDataArray<T>(VTK_DataArray<T>(name, data_start_, shape_, strides_), recycle()));
+            return true;
+        }
+        template <typename T>
+        bool addNodeData(const std::string name, const std::vector<T> &data_vector, const size_t no_components) { return addNodeData(name, data_vector.data(), {Mesh_.NoPoints(), no_components}, {sizeof(T)*no_components, sizeof(T)}); }
+
+        // Generated fields, see VTK_UnstructuredGrid; evaluated immediately into the recycled snapshot memory
+        template <typename T = void, typename F>
+        bool addCellData(const std::string name, const size_t no_components, F generator)
+        {
+            using V = VTK_GeneratedType<T, F>;
+            CellData_.emplace_back(new VTK_OwnedDataArray<V>(VTK_GeneratedArray<V, F>(name, Mesh_.NoCells(), no_components, std::move(generator)), recycle()));
+            return true;
+        }
+        template <typename T = void, typename F>
+        bool addNodeData(const std::string name, const size_t no_components, F generator)
+        {
+            using V = VTK_GeneratedType<T, F>;
+            NodeData_.emplace_back(new VTK_OwnedDataArray<V>(VTK_GeneratedArray<V, F>(name, Mesh_.NoPoints(), no_components, std::move(generator)), recycle()));
+            return true;
+        }
+
+    public:
+        // Hands the current step to the writer thread, blocks while the previous step is still being written
+        bool write(double time);
+        // Waits until all steps are written, rethrows an error of the writer thread
+        void finish();
+        size_t NoSteps() const { return NoSteps_; }
+    private:
+        // snapshot of one step
+        struct Step
+        {
+            double time;
+            std::string file;
+            std::shared_ptr<const VTK_EncodedGeometry> geometry;
+            std::vector<std::unique_ptr<VTK_Array>> node_data, cell_data;
+        };
+        void work();
+        void writePVD();
+        // memory of a finished snapshot, reused for the next copy
+        std::vector<char> recycle()
+        {
+            std::lock_guard<std::mutex> lock(Mutex_);
+            if (FreeStorage_.empty()) return std::vector<char>();
+            std::vector<char> storage = std::move(FreeStorage_.back());
+            FreeStorage_.pop_back();
+            return storage;
+        }
+    private:
+        std::string BaseName_, FileName_;
+        VTK_UnstructuredGrid Mesh_;
+        std::unique_ptr<VTK_ThreadPool> Pool_;
+        std::shared_ptr<const VTK_EncodedGeometry> Geometry_;
+        std::vector<std::unique_ptr<VTK_Array>> NodeData_, CellData_;
+        size_t NoSteps_;
+        std::vector<std::pair<double, std::string>> Collection_;
+        std::vector<std::vector<char>> FreeStorage_;
+        std::unique_ptr<Step> Pending_;
+        bool Busy_, Stop_;
+        std::exception_ptr Error_;
+        std::function<void(const VTK_WriteStatistics&)> StatisticsCallback_;
+        bool StatisticsSidecar_ = false;
+        VTK_FILEBACKEND FileBackend_ = VTK_STREAM_FILE;
+        std::mutex Mutex_;
+        std::condition_variable Wakeup_, Done_;
+        std::thread Writer_;
+};
+
+inline bool VTK_TimeSeries::write(double time)
+{
+    // the geometry is encoded once on this thread, as the mesh buffers belong to the caller
+    bool uint64_header = false;
+    for (auto &data : NodeData_) uint64_header |= data->ByteSize() > UINT32_MAX;
+    for (auto &data : CellData_) uint64_header |= data->ByteSize() > UINT32_MAX;
+    if (!Geometry_ || (uint64_header && !Geometry_->uint64_header)) Geometry_ = Mesh_.encodeGeometry(uint64_header);
+
+    std::string index = std::to_string(NoSteps_);
+    if (index.size() < 6) index = std::string(6-index.size(), '0')+index;
+    std::unique_ptr<Step> step(new Step);
+    step->time = time;
+    step->file = FileName_+"_"+index+".vtu";
+    step->geometry = Geometry_;
+    step->node_data = std::move(NodeData_);
+    step->cell_data = std::move(CellData_);
+    NodeData_.clear();
+    CellData_.clear();
+
+    // double buffering: wait for the previous step, then hand this one over
+    {
+        std::unique_lock<std::mutex> lock(Mutex_);
+        Done_.wait(lock, [this]{ return !Pending_ && !Busy_; });
+        if (Error_)
+        {
+            std::exception_ptr error = Error_;
+            Error_ = nullptr;
+            std::rethrow_exception(error);
+        }
+        Pending_ = std::move(step);
+    }
+    Wakeup_.notify_all();
+    NoSteps_++;
+    return true;
+}
+
+inline void VTK_TimeSeries::finish()
+{
+    std::unique_lock<std::mutex> lock(Mutex_);
+    Done_.wait(lock, [this]{ return !Pending_ && !Busy_; });
+    if (Error_)
+    {
+        std::exception_ptr error = Error_;
+        Error_ = nullptr;
+        std::rethrow_exception(error);
+    }
+}
+
+inline void VTK_TimeSeries::work()
+{
+    while (true)
+    {
+        std::unique_ptr<Step> step;
+        {
+            std::unique_lock<std::mutex> lock(Mutex_);
+            Wakeup_.wait(lock, [this]{ return Stop_ || Pending_; });
+            if (!Pending_) return;
+            step = std::move(Pending_);
+            Busy_ = true;
+        }
+        std::exception_ptr error;
+        try
+        {
+            std::vector<const VTK_Array*> node_data, cell_data;
+            for (auto &data : step->node_data) node_data.push_back(data.get());
+            for (auto &data : step->cell_data) cell_data.push_back(data.get());
+            const std::string directory = BaseName_.substr(0, BaseName_.size()-FileName_.size());
+            const bool statistics_enabled = StatisticsCallback_ || StatisticsSidecar_;
+            VTK_WriteStatistics statistics;
+            if (!VTK_WriteUnstructuredGridFile(directory+step->file, step->geometry->settings, step->geometry->NoPoints, step->geometry->NoCells,
+                                               {}, step->geometry.get(), node_data, cell_data, Pool_.get(),
+                                               statistics_enabled ? &statistics : nullptr, FileBackend_))
+                throw std::runtime_error("Error writing "+directory+step->file+"!");
+            if (StatisticsSidecar_ && !statistics.writeJSON(directory+step->file+".json")) throw std::runtime_error("Error writing "+directory+step->file+".json!");
+            if (StatisticsCallback_) StatisticsCallback_(statistics);
+            Collection_.push_back({step->time, step->file});
+            writePVD();
+        }
+        catch (...)
+        {
+            error = std::current_exception();
+        }
+        {
+            std::lock_guard<std::mutex> lock(Mutex_);
+            // hand the snapshot memory back for the next copies
+            for (auto* fields : {&step->node_data, &step->cell_data})
+                for (auto &data : *fields)
+                    if (auto* storage = dynamic_cast<VTK_ArrayStorage*>(data.get())) FreeStorage_.push_back(storage->releaseStorage());
+            if (error && !Error_) Error_ = error;
+            Busy_ = false;
+        }
+        Done_.notify_all();
+    }
+}
+
+// Rewrites the collection after every step, so it is complete even if the run stops
+inline void VTK_TimeSeries::writePVD()
+{
+    std::ofstream pvd(BaseName_+".pvd", std::ios::out | std::ios::binary);
+    pvd << "<?xml version=\"1.0\" ?>" << std::endl;
+    pvd << "<VTKFile type=\"Collection\" version=\"0.1\" byte_order=\"LittleEndian\">" << std::endl;
+    pvd << "<Collection>" << std::endl;
+    for (auto &entry : Collection_)
+    {
+        char time[32];
+        const auto result = std::to_chars(time, time+sizeof(time), entry.first);
+        pvd << "<DataSet timestep=\"" << std::string(time, result.ptr) << "\" group=\"\" part=\"0\" file=\"" << entry.second << "\"/>" << std::endl;
+    }
+    pvd << "</Collection>" << std::endl;
+    pvd << "</VTKFile>" << std::endl;
+    if (!pvd.good()) throw std::runtime_error("Error writing "+BaseName_+".pvd!");
+}
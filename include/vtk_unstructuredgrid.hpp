@@ -1,26 +1,34 @@
 #pragma once
 
+#include <memory>
+#include <functional>
+
 #include <vtk_array.hpp>
+#include <vtk_cells.hpp>
+#include <vtk_dataset.hpp>
+#include <vtk_polydata.hpp>
+#include <vtk_reordering.hpp>
+#include <vtk_surface.hpp>
 
-class VTK_UnstructuredGrid
+class VTK_UnstructuredGrid : public VTK_DataSet
 {
     public: 
         VTK_UnstructuredGrid() 
-        : dimensions_(3), points_set_(false), cells_set_(false), NoPoints_(0), NoCells_(0),
-        PointCoordinates_(nullptr), ElementConnectivity_(nullptr), CellData_(0), NodeData_(0)
+        : PointCoordinates_(nullptr), ElementConnectivity_(nullptr),
+        dimensions_(3), points_set_(false), cells_set_(false), NoPoints_(0), NoCells_(0), vtk_cell_type_(VTK_EMPTY_CELL)
         {}
         ~VTK_UnstructuredGrid()
         {
             delete PointCoordinates_;
             delete ElementConnectivity_;
-            for (auto &data : CellData_) delete data;
-            for (auto &data : NodeData_) delete data;
         }
     private:
         VTK_DataArray<double>* PointCoordinates_;
         VTK_DataArray<size_t>* ElementConnectivity_;
-        std::vector<VTK_Array*> CellData_;
-        std::vector<VTK_Array*> NodeData_;
+        std::unique_ptr<VTK_CellOffsetArray> CellOffsets_;
+        std::unique_ptr<VTK_CellTypeArray> CellTypes_;
+        std::unique_ptr<VTK_DataArray<size_t>> Faces_;
+        std::unique_ptr<VTK_FaceOffsetArray> FaceOffsets_;
     public:
         // Set points via VTK_DataArray interface
         bool setPoints(const double* data_start_, std::array<size_t, 2> shape_, std::array<size_t, 2> strides_);
@@ -33,71 +41,246 @@ class VTK_UnstructuredGrid
 
         // convinience overload for elements in flattened format
         bool setElements(const std::vector<size_t> &Elmt, VTK_CELLTYPE vtkcelltype) { return setElements(Elmt.data(), {Elmt.size()/VTK_CELL_NODES(vtkcelltype), VTK_CELL_NODES(vtkcelltype)}, {sizeof(size_t)*VTK_CELL_NODES(vtkcelltype), sizeof(size_t)}, vtkcelltype); }
-        
-        // Set cell data
-        template <typename T>
-        bool addCellData(const std::string name, const T* data_start_, std::array<size_t, 2> shape_, std::array<size_t, 2> strides_);
 
-        // convenience overload for m-component element data in a flattened format data_vector = {d11, d12, ..., d1m, d21, ..., dem} (e=number of elements)
-        template <typename T>
-        bool addCellData(const std::string name, const std::vector<T> &data_vector, const size_t no_components) { return addCellData(name, data_vector.data(), {NoCells_, no_components}, {sizeof(T)*no_components, sizeof(T)}); }
+        // Set mixed cells in homogeneous blocks, e.g. {{VTK_TETRA, 1000}, {VTK_PYRAMID, 200}, {VTK_HEXAHEDRON, 5000}},
+        // Elmt lists the nodes of all cells one after another, offsets and types are generated from the blocks
+        bool setElements(const std::vector<size_t> &Elmt, const std::vector<VTK_CellBlock> &blocks);
+
+        // Set mixed cells in CSR format: the nodes of cell i are Elmt[offsets[i]..offsets[i+1]), offsets has NoCells+1 entries starting with 0.
+        // Runs of equal types and node counts are detected and written like blocks, otherwise offsets and types are converted while writing.
+        bool setElements(const std::vector<size_t> &Elmt, const std::vector<size_t> &offsets, const std::vector<VTK_CELLTYPE> &types);
 
-        // Set node data
-        template <typename T>
-        bool addNodeData(const std::string name, const T* data_start_, std::array<size_t, 2> shape_, std::array<size_t, 2> strides_);
+        // Set the faces of the VTK_POLYHEDRON cells after setElements(...): the faces of cell i are faces[faceoffsets[i]..faceoffsets[i+1])
+        // as {number of faces, number of nodes of face 1, nodes of face 1, number of nodes of face 2, ...}, the range is empty for other cells
+        bool setFaces(const std::vector<size_t> &faces, const std::vector<size_t> &faceoffsets);
         
-        // convenience overload for m-component noda data in a flattened format data_vector = {d11, d12, ..., d1m, d21, ..., dnm} (n=number of nodes)
-        template <typename T>
-        bool addNodeData(const std::string name, const std::vector<T> &data_vector, const size_t no_components) { return addNodeData(name, data_vector.data(), {NoPoints_, no_components}, {sizeof(T)*no_components, sizeof(T)}); }
+        size_t NoPoints() const {return NoPoints_;}
+        size_t NoCells() const {return NoCells_;}
+        // The VTK_CELLTYPE of all cells, VTK_EMPTY_CELL if the types are mixed
+        VTK_CELLTYPE CellType() const {return vtk_cell_type_;}
+
+        // Read access to the arrays of the grid
+        const VTK_Array* Points() const {return PointCoordinates_;}
+        const VTK_Array* Connectivity() const {return ElementConnectivity_;}
+        const VTK_CellOffsetArray* Offsets() const {return CellOffsets_.get();}
+        const VTK_CellTypeArray* Types() const {return CellTypes_.get();}
+        const VTK_Array* Faces() const {return Faces_.get();}
+        // Changes with every setPoints(...), setElements(...) and setFaces(...), e.g. to detect a new geometry
+        size_t GeometryVersion() const {return GeometryVersion_;}
 
     public: 
-        bool write(std::string path_to_file);
+        // Encodes Points and Cells with the current settings into memory, see VTK_EncodedGeometry.
+        // UInt64 headers are used if requested or if one of the geometry arrays exceeds 4GB.
+        std::shared_ptr<const VTK_EncodedGeometry> encodeGeometry(bool uint64_header);
+
+        // The boundary of the 3D cells, i.e. the faces which belong to a single cell, see VTK_ExtractSurface(...).
+        // Found on the threads of the grid once per geometry (see GeometryVersion()), polyhedra are not supported.
+        std::shared_ptr<const VTK_Surface> Surface();
+
+        // Writes only the boundary surface as .vtp PolyData with the settings of the grid:
+        // the used points with their node data, one polygon per boundary face with the cell data of its cell
+        bool writeSurface(std::string path_to_file);
+        bool writeSurface(VTK_Sink& sink);
+
+        // Writes the points and cells in the given order, the buffers of the caller and the other outputs of the grid
+        // (surface, time series, partitions) keep the order of the grid, polyhedra are not supported
+        void setReordering(VTK_REORDERING reordering) { Reordering_ = reordering; }
+        VTK_REORDERING Reordering() const {return Reordering_;}
+
+        // The order of the points and cells in the output, computed on the threads of the grid once per geometry and reordering
+        std::shared_ptr<const VTK_Reordering> Reordered();
+    private:
+        bool writeSink(VTK_Sink& sink, VTK_WriteStatistics* statistics);
+        // Writes the reordered grid, the points and fields are viewed in the output order
+        bool writeReordered(VTK_Sink& sink, VTK_WriteStatistics* statistics);
+        // Replaces the cells, the connectivity is viewed as given
+        void resetCells(const size_t* data_start_, std::array<size_t, 2> shape_, std::array<size_t, 2> strides_, size_t no_cells);
+        // The arrays of <Points> and <Cells> as they are written, the converted views are kept alive by converted:
+        // the connectivity is UInt32 if all point indices fit, Int64 otherwise
+        std::vector<const VTK_Array*> geometryArrays(std::vector<std::unique_ptr<VTK_Array>>& converted) const;
+        // Fills surface with the boundary, the fields and the settings of the grid, the arrays are viewed
+        void surfaceData(VTK_PolyData& surface, const VTK_Surface& boundary) const;
+        bool PointsSet() const {return points_set_;}
+        bool CellsSet() const {return cells_set_;}
     private:
         unsigned int dimensions_;
         bool points_set_, cells_set_;
         size_t NoPoints_, NoCells_;
         VTK_CELLTYPE vtk_cell_type_;
+        bool polyhedra_ = false;
+        size_t GeometryVersion_ = 0;
+        std::shared_ptr<const VTK_Surface> Surface_;
+        size_t SurfaceVersion_ = 0;
+        VTK_REORDERING Reordering_ = VTK_NO_REORDERING;
+        std::shared_ptr<const VTK_Reordering> Reordered_;
+        size_t ReorderedVersion_ = 0;
+        VTK_REORDERING ReorderedMethod_ = VTK_NO_REORDERING;
 };
 
-bool VTK_UnstructuredGrid::write(std::string path_to_file)
-{
-    size_t nodim   = 3;
-    size_t elmtnodes = VTK_CELL_NODES(vtk_cell_type_);
-    std::string byte_order = "LittleEndian";
-    std::ofstream outfile;
-    outfile.open(path_to_file, std::ios::out);
-    outfile << "<?xml version=\"1.0\" ?>" << std::endl;
-    outfile << "<VTKFile byte_order=\""<< byte_order <<"\" type=\"UnstructuredGrid\" version=\"0.1\">" << std::endl;
-    outfile << "<UnstructuredGrid>" << std::endl;
-    outfile << "<Piece NumberOfCells=\"" << NoCells_ << "\" NumberOfPoints=\"" << NoPoints_ << "\">" << std::endl;
-    outfile << "<Points>" << std::endl;
-    PointCoordinates_ -> write(outfile);
-    outfile << "</Points>" << std::endl;
-    outfile << "<Cells>" <<std::endl;
-    ElementConnectivity_ -> ewrite(outfile);
-    outfile << "<DataArray Name=\"offsets\" format=\"ascii\" type=\"Int32\">";
-    for (size_t i=0; i<NoCells_; i++) outfile << (i+1)*elmtnodes << "  ";
-    outfile << "</DataArray>" << std::endl;
-    outfile << "<DataArray Name=\"types\" format=\"ascii\" type=\"UInt8\">";
-    for (size_t i=0; i<NoCells_; i++) outfile << vtk_cell_type_ << "  ";
-    outfile << "</DataArray>" << std::endl;
-    outfile << "</Cells>" <<std::endl;
-    outfile << "<PointData>" <<std::endl;
-    for (auto &data : NodeData_) data -> write(outfile);
-    outfile << "</PointData>" <<std::endl;
-    outfile << "<CellData>" <<std::endl;
-    for (auto &data : CellData_) data -> write(outfile);
-    outfile << "</CellData>" <<std::endl;
-    outfile << "</Piece>" <<std::endl;
-    outfile << "</UnstructuredGrid>" <<std::endl;
-    outfile << "</VTKFile>" <<std::endl;
-    return true;
+// Layout of a .vtu file: Coordinates in <Points>, the remaining geometry arrays in <Cells>
+inline VTK_DataSetLayout VTK_UnstructuredGridLayout(size_t no_points, size_t no_cells, size_t no_geometry)
+{
+    return {"UnstructuredGrid", "", "NumberOfCells=\""+std::to_string(no_cells)+"\" NumberOfPoints=\""+std::to_string(no_points)+"\"",
+            {{"Points", 1, true}, {"Cells", no_geometry-1, false}}};
+}
+
+/*
+Writes an unstructured grid to sink, failures of the sink throw, see VTK_WriteDataSet(...).
+geometry_arrays -> Coordinates, connectivity, offsets, types (and faces, faceoffsets for polyhedra), encoded during the write
+geometry        -> the same arrays encoded before, used instead of geometry_arrays if not nullptr
+node_data       -> arrays of the <PointData> section
+cell_data       -> arrays of the <CellData> section
+statistics      -> filled with the statistics of the file if not nullptr
+*/
+inline bool VTK_WriteUnstructuredGrid(VTK_Sink& sink, const VTK_WriteSettings& settings, size_t no_points, size_t no_cells,
+                                      const std::vector<const VTK_Array*>& geometry_arrays, const VTK_EncodedGeometry* geometry,
+                                      const std::vector<const VTK_Array*>& node_data, const std::vector<const VTK_Array*>& cell_data,
+                                      VTK_ThreadPool* pool, VTK_WriteStatistics* statistics = nullptr)
+{
+    const size_t no_geometry = (geometry != nullptr) ? geometry->bytes.size() : geometry_arrays.size();
+    return VTK_WriteDataSet(sink, settings, VTK_UnstructuredGridLayout(no_points, no_cells, no_geometry), geometry_arrays, geometry, node_data, cell_data, pool, statistics);
+}
+
+// Writes an unstructured grid file through the sink of the given backend, see VTK_WriteUnstructuredGrid(...)
+inline bool VTK_WriteUnstructuredGridFile(const std::string& path_to_file, const VTK_WriteSettings& settings, size_t no_points, size_t no_cells,
+                                          const std::vector<const VTK_Array*>& geometry_arrays, const VTK_EncodedGeometry* geometry,
+                                          const std::vector<const VTK_Array*>& node_data, const std::vector<const VTK_Array*>& cell_data,
+                                          VTK_ThreadPool* pool, VTK_WriteStatistics* statistics = nullptr, VTK_FILEBACKEND backend = VTK_STREAM_FILE)
+{
+    std::unique_ptr<VTK_Sink> sink = VTK_OpenFileSink(path_to_file, backend);
+    return VTK_WriteUnstructuredGrid(*sink, settings, no_points, no_cells, geometry_arrays, geometry, node_data, cell_data, pool, statistics);
+}
+
+inline bool VTK_UnstructuredGrid::writeSink(VTK_Sink& sink, VTK_WriteStatistics* statistics)
+{
+    if (Reordering_ != VTK_NO_REORDERING) return writeReordered(sink, statistics);
+    std::vector<std::unique_ptr<VTK_Array>> converted;
+    const std::vector<const VTK_Array*> geometry = geometryArrays(converted);
+    const std::vector<const VTK_Array*> node_data(NodeData_.begin(), NodeData_.end()), cell_data(CellData_.begin(), CellData_.end());
+    return VTK_WriteUnstructuredGrid(sink, settings_, NoPoints_, NoCells_, geometry, nullptr, node_data, cell_data, pool(), statistics);
 }
 
-bool VTK_UnstructuredGrid::setPoints(const double* data_start_, std::array<size_t, 2> shape_, std::array<size_t, 2> strides_)
+inline std::vector<const VTK_Array*> VTK_UnstructuredGrid::geometryArrays(std::vector<std::unique_ptr<VTK_Array>>& converted) const
+{
+    if (cells_set_ != true) throw std::runtime_error("Error writing the grid! Call setPoints(...) and setElements(...) first");
+    if (polyhedra_ && !Faces_) throw std::runtime_error("Error writing the grid! The grid holds polyhedra, call setFaces(...)");
+    if (NoPoints_ <= size_t(UINT32_MAX)+1) converted.emplace_back(new VTK_ConvertedArray<size_t, uint32_t>(*ElementConnectivity_));
+    else converted.emplace_back(new VTK_ConvertedArray<size_t, int64_t>(*ElementConnectivity_));
+    std::vector<const VTK_Array*> arrays = {PointCoordinates_, converted.back().get(), CellOffsets_.get(), CellTypes_.get()};
+    if (Faces_)
+    {
+        converted.emplace_back(new VTK_ConvertedArray<size_t, int64_t>(*Faces_));
+        arrays.push_back(converted.back().get());
+        arrays.push_back(FaceOffsets_.get());
+    }
+    return arrays;
+}
+
+inline std::shared_ptr<const VTK_EncodedGeometry> VTK_UnstructuredGrid::encodeGeometry(bool uint64_header)
+{
+    std::vector<std::unique_ptr<VTK_Array>> converted;
+    const std::vector<const VTK_Array*> arrays = geometryArrays(converted);
+
+    for (auto &data : arrays) uint64_header |= data->ByteSize() > UINT32_MAX;
+    auto geometry = std::make_shared<VTK_EncodedGeometry>();
+    geometry->settings = settings_;
+    geometry->uint64_header = uint64_header;
+    geometry->NoPoints = NoPoints_;
+    geometry->NoCells = NoCells_;
+    geometry->tags.resize(arrays.size());
+    geometry->bytes.resize(arrays.size());
+    geometry->arrays.resize(arrays.size());
+    std::vector<VTK_CompressedArray> compressed_arrays;
+    const bool compressed = (settings_.format != VTK_ASCII) && (settings_.compressor != VTK_NO_COMPRESSION);
+    if (compressed) compressed_arrays = VTK_CompressArrays(arrays, settings_.compressor, settings_.compression_level, uint64_header, pool());
+    for (size_t g=0; g<arrays.size(); g++)
+    {
+        geometry->arrays[g] = VTK_DescribeArray(*arrays[g]);
+        const VTK_CompressedArray* compressed_data = compressed ? &compressed_arrays[g] : nullptr;
+        VTK_PieceList pieces;
+        if (settings_.format == VTK_ASCII) VTK_AddAsciiArray(pieces, *arrays[g], g == 0, settings_.precision);
+        else if (settings_.format == VTK_BINARY) VTK_AddBinaryArray(pieces, *arrays[g], g == 0, uint64_header, compressed_data);
+        else
+        {
+            geometry->tags[g] = VTK_DataArrayTag(*arrays[g], "appended", g == 0);
+            VTK_AddAppendedArray(pieces, *arrays[g], uint64_header, compressed_data);
+        }
+        pieces.write(geometry->bytes[g], pool());
+    }
+    return geometry;
+}
+
+inline std::shared_ptr<const VTK_Surface> VTK_UnstructuredGrid::Surface()
+{
+    if (cells_set_ != true) throw std::runtime_error("Error extracting the surface! Call setPoints(...) and setElements(...) first");
+    if (polyhedra_) throw std::runtime_error("Error extracting the surface! Polyhedra are not supported.");
+    if (!Surface_ || SurfaceVersion_ != GeometryVersion_) Surface_ = VTK_ExtractSurface(*ElementConnectivity_, *CellOffsets_, *CellTypes_, pool());
+    SurfaceVersion_ = GeometryVersion_;
+    return Surface_;
+}
+
+inline std::shared_ptr<const VTK_Reordering> VTK_UnstructuredGrid::Reordered()
+{
+    if (cells_set_ != true) throw std::runtime_error("Error reordering the grid! Call setPoints(...) and setElements(...) first");
+    if (polyhedra_) throw std::runtime_error("Error reordering the grid! Polyhedra are not supported.");
+    if (!Reordered_ || ReorderedVersion_ != GeometryVersion_ || ReorderedMethod_ != Reordering_)
+        Reordered_ = VTK_ComputeReordering(Reordering_, *PointCoordinates_, *ElementConnectivity_, *CellOffsets_, *CellTypes_, pool());
+    ReorderedVersion_ = GeometryVersion_;
+    ReorderedMethod_ = Reordering_;
+    return Reordered_;
+}
+
+inline bool VTK_UnstructuredGrid::writeReordered(VTK_Sink& sink, VTK_WriteStatistics* statistics)
+{
+    const std::shared_ptr<const VTK_Reordering> order = Reordered();
+    std::vector<std::unique_ptr<VTK_Array>> views;
+    auto view = [&views](VTK_Array* data) { views.emplace_back(data); return data; };
+    const VTK_DataArray<size_t> connectivity("connectivity", order->connectivity.data(), {order->connectivity.size(), 1}, {sizeof(size_t), sizeof(size_t)});
+    const VTK_CellOffsetArray offsets(order->offsets.data(), NoCells_);
+    const VTK_CellTypeArray types(order->types.data(), NoCells_);
+    std::vector<const VTK_Array*> geometry = {view(new VTK_IndexedArray(*PointCoordinates_, order->node_ids)), nullptr, &offsets, &types};
+    if (NoPoints_ <= size_t(UINT32_MAX)+1) geometry[1] = view(new VTK_ConvertedArray<size_t, uint32_t>(connectivity));
+    else geometry[1] = view(new VTK_ConvertedArray<size_t, int64_t>(connectivity));
+    std::vector<const VTK_Array*> node_data, cell_data;
+    for (auto &data : NodeData_) node_data.push_back(view(new VTK_IndexedArray(*data, order->node_ids)));
+    for (auto &data : CellData_) cell_data.push_back(view(new VTK_IndexedArray(*data, order->cell_ids)));
+    return VTK_WriteUnstructuredGrid(sink, settings_, NoPoints_, NoCells_, geometry, nullptr, node_data, cell_data, pool(), statistics);
+}
+
+inline void VTK_UnstructuredGrid::surfaceData(VTK_PolyData& surface, const VTK_Surface& boundary) const
+{
+    surface.setWriteSettings(settings_);
+    surface.setNumberOfThreads(NoThreads_);
+    surface.setFileBackend(FileBackend_);
+    surface.setStatisticsCallback(StatisticsCallback_);
+    surface.setStatisticsSidecar(StatisticsSidecar_);
+    surface.setPoints(new VTK_IndexedArray(*PointCoordinates_, boundary.node_ids));
+    surface.setPolygons(boundary.connectivity, boundary.offsets);
+    for (auto &data : NodeData_) surface.addNodeData(new VTK_IndexedArray(*data, boundary.node_ids));
+    for (auto &data : CellData_) surface.addCellData(new VTK_IndexedArray(*data, boundary.cell_ids));
+}
+
+inline bool VTK_UnstructuredGrid::writeSurface(std::string path_to_file)
+{
+    const std::shared_ptr<const VTK_Surface> boundary = Surface();
+    VTK_PolyData surface;
+    surfaceData(surface, *boundary);
+    return surface.write(path_to_file);
+}
+
+inline bool VTK_UnstructuredGrid::writeSurface(VTK_Sink& sink)
+{
+    const std::shared_ptr<const VTK_Surface> boundary = Surface();
+    VTK_PolyData surface;
+    surfaceData(surface, *boundary);
+    return surface.write(sink);
+}
+
+inline bool VTK_UnstructuredGrid::setPoints(const double* data_start_, std::array<size_t, 2> shape_, std::array<size_t, 2> strides_)
 {
     // setting points is always the first call:
     points_set_ = false;
+    GeometryVersion_++;
     delete PointCoordinates_;
     cells_set_ = false;
 
@@ -117,59 +300,97 @@ bool VTK_UnstructuredGrid::setPoints(const double* data_start_, std::array<size_
     return false;
 }
 
-bool VTK_UnstructuredGrid::setElements(const size_t* data_start_, std::array<size_t, 2> shape_, std::array<size_t, 2> strides_, VTK_CELLTYPE vtkcelltype)
+inline bool VTK_UnstructuredGrid::setElements(const size_t* data_start_, std::array<size_t, 2> shape_, std::array<size_t, 2> strides_, VTK_CELLTYPE vtkcelltype)
 {
     // check if points have already been set
     if (points_set_ != true) throw std::runtime_error("Error reading Cells! Call setPoints(...) first");
 
-    // check if number of components (which are nodes per element) equals the VTK_CELLTYPE
-    if (shape_[1] != VTK_CELL_NODES(vtkcelltype)) throw std::runtime_error("Error reading Cells! Your cell type demands "+std::to_string(VTK_CELL_NODES(vtkcelltype))+" nodes, your input has "+std::to_string(shape_[1])+" nodes per element.");
+    // check if number of components (which are nodes per element) equals the VTK_CELLTYPE, polygons and polyhedra take any number
+    if (VTK_CELL_NODES(vtkcelltype) == 0 && shape_[1] == 0) throw std::runtime_error("Error reading Cells! Your input has no nodes per element.");
+    if (VTK_CELL_NODES(vtkcelltype) != 0 && shape_[1] != VTK_CELL_NODES(vtkcelltype)) throw std::runtime_error("Error reading Cells! Your cell type demands "+std::to_string(VTK_CELL_NODES(vtkcelltype))+" nodes, your input has "+std::to_string(shape_[1])+" nodes per element.");
 
-    delete ElementConnectivity_;
-    cells_set_ = false;
+    resetCells(data_start_, shape_, strides_, shape_[0]);
     vtk_cell_type_ = vtkcelltype;
+    polyhedra_ = (vtkcelltype == VTK_POLYHEDRON);
+    const std::vector<VTK_CellBlock> blocks = {{vtkcelltype, shape_[0], shape_[1]}};
+    CellOffsets_.reset(new VTK_CellOffsetArray(blocks));
+    CellTypes_.reset(new VTK_CellTypeArray(blocks));
 
-    ElementConnectivity_ = new VTK_DataArray("connectivity", data_start_, shape_, strides_);
-    NoCells_ = shape_[0];
+    cells_set_ = true;
+    return true;
+}
 
-    if (ElementConnectivity_!=nullptr)
+inline bool VTK_UnstructuredGrid::setElements(const std::vector<size_t> &Elmt, const std::vector<VTK_CellBlock> &blocks)
+{
+    if (points_set_ != true) throw std::runtime_error("Error reading Cells! Call setPoints(...) first");
+    for (auto &block : blocks)
+        if (VTK_BlockNodes(block) == 0) throw std::runtime_error("Error reading Cells! The block of cell type "+std::to_string(block.type)+" needs the number of nodes per element.");
+    const VTK_CellBlocks cells(blocks);
+    if (cells.NoNodes() != Elmt.size()) throw std::runtime_error("Error reading Cells! The blocks demand "+std::to_string(cells.NoNodes())+" nodes, your input has "+std::to_string(Elmt.size())+" nodes.");
+    // a single block is an ordinary grid of one cell type
+    if (cells.Blocks().size() == 1)
     {
-        cells_set_ = true;
-        return true;
+        const size_t no_nodes = VTK_BlockNodes(cells.Blocks()[0]);
+        return setElements(Elmt.data(), {cells.NoCells(), no_nodes}, {sizeof(size_t)*no_nodes, sizeof(size_t)}, cells.Blocks()[0].type);
     }
-    return false;
+
+    resetCells(Elmt.data(), {Elmt.size(), 1}, {sizeof(size_t), sizeof(size_t)}, cells.NoCells());
+    vtk_cell_type_ = cells.Blocks().empty() ? VTK_EMPTY_CELL : cells.Blocks()[0].type;
+    for (auto &block : cells.Blocks())
+    {
+        if (block.type != vtk_cell_type_) vtk_cell_type_ = VTK_EMPTY_CELL;
+        polyhedra_ |= (block.type == VTK_POLYHEDRON);
+    }
+    CellOffsets_.reset(new VTK_CellOffsetArray(blocks));
+    CellTypes_.reset(new VTK_CellTypeArray(blocks));
+    cells_set_ = true;
+    return true;
 }
 
-template <typename T>
-bool VTK_UnstructuredGrid::addNodeData(const std::string name, const T* data_start_, std::array<size_t, 2> shape_, std::array<size_t, 2> strides_)
+inline bool VTK_UnstructuredGrid::setElements(const std::vector<size_t> &Elmt, const std::vector<size_t> &offsets, const std::vector<VTK_CELLTYPE> &types)
 {
-    // check if points have already been set
     if (points_set_ != true) throw std::runtime_error("Error reading Cells! Call setPoints(...) first");
+    if (offsets.size() != types.size()+1 || offsets[0] != 0) throw std::runtime_error("Error reading Cells! Expected "+std::to_string(types.size()+1)+" offsets starting with 0, got "+std::to_string(offsets.size()));
+    if (offsets.back() != Elmt.size()) throw std::runtime_error("Error reading Cells! The offsets demand "+std::to_string(offsets.back())+" nodes, your input has "+std::to_string(Elmt.size())+" nodes.");
+    const size_t no_cells = types.size();
+    for (size_t i=0; i<no_cells; i++)
+    {
+        if (offsets[i+1] <= offsets[i]) throw std::runtime_error("Error reading Cells! Cell "+std::to_string(i)+" has no nodes.");
+        if (VTK_CELL_NODES(types[i]) != 0 && offsets[i+1]-offsets[i] != VTK_CELL_NODES(types[i])) throw std::runtime_error("Error reading Cells! The cell type of cell "+std::to_string(i)+" demands "+std::to_string(VTK_CELL_NODES(types[i]))+" nodes, your input has "+std::to_string(offsets[i+1]-offsets[i])+" nodes.");
+    }
 
-    // check if node data meets number of nodes
-    if (shape_[0] != NoPoints_)throw std::runtime_error("Error adding NodeData! Number of NodeData does not match number of present nodes");
-
-    // create a vtk data array
-    auto NewNodeData_ = new VTK_DataArray(name, data_start_, shape_, strides_);
-    NodeData_.push_back(NewNodeData_);
+    // blocks of at least 16 cells on average are written without reading offsets and types
+    const std::vector<VTK_CellBlock> blocks = VTK_DetectCellBlocks(offsets.data(), types.data(), no_cells, no_cells/16+1);
+    if (!blocks.empty()) return setElements(Elmt, blocks);
 
-    if (NewNodeData_!=nullptr) return true;
-    return false;
+    resetCells(Elmt.data(), {Elmt.size(), 1}, {sizeof(size_t), sizeof(size_t)}, no_cells);
+    vtk_cell_type_ = VTK_EMPTY_CELL;
+    polyhedra_ = std::find(types.begin(), types.end(), VTK_POLYHEDRON) != types.end();
+    CellOffsets_.reset(new VTK_CellOffsetArray(offsets.data(), no_cells));
+    CellTypes_.reset(new VTK_CellTypeArray(types.data(), no_cells));
+    cells_set_ = true;
+    return true;
 }
 
-template <typename T>
-bool VTK_UnstructuredGrid::addCellData(const std::string name, const T* data_start_, std::array<size_t, 2> shape_, std::array<size_t, 2> strides_)
+inline bool VTK_UnstructuredGrid::setFaces(const std::vector<size_t> &faces, const std::vector<size_t> &faceoffsets)
 {
-    // check if elements have already been set
-    if (cells_set_ != true) throw std::runtime_error("Error adding CellData! Call setElements(...) first");
-
-    // check if cell data meets number of elements
-    if (shape_[0] != NoCells_)throw std::runtime_error("Error adding CellData! Number of CellData does not match number of present elements");
-
-    // create a vtk data array
-    auto NewCellData_ = new VTK_DataArray(name, data_start_, shape_, strides_);
-    CellData_.push_back(NewCellData_);
+    if (cells_set_ != true) throw std::runtime_error("Error reading Faces! Call setElements(...) first");
+    if (faceoffsets.size() != NoCells_+1 || faceoffsets[0] != 0 || faceoffsets.back() != faces.size()) throw std::runtime_error("Error reading Faces! Expected "+std::to_string(NoCells_+1)+" face offsets from 0 to the number of faces.");
+    for (size_t i=0; i<NoCells_; i++)
+        if ((CellTypes_->type(i) == VTK_POLYHEDRON) != (faceoffsets[i+1] > faceoffsets[i])) throw std::runtime_error("Error reading Faces! Cell "+std::to_string(i)+" is "+(CellTypes_->type(i) == VTK_POLYHEDRON ? "a polyhedron without faces." : "no polyhedron but has faces."));
+    Faces_.reset(new VTK_DataArray<size_t>("faces", faces.data(), {faces.size(), 1}, {sizeof(size_t), sizeof(size_t)}));
+    FaceOffsets_.reset(new VTK_FaceOffsetArray(faceoffsets.data(), NoCells_));
+    GeometryVersion_++;
+    return true;
+}
 
-    if (NewCellData_!=nullptr) return true;
-    return false;
-}
\ No newline at end of file
+inline void VTK_UnstructuredGrid::resetCells(const size_t* data_start_, std::array<size_t, 2> shape_, std::array<size_t, 2> strides_, size_t no_cells)
+{
+    delete ElementConnectivity_;
+    ElementConnectivity_ = new VTK_DataArray("connectivity", data_start_, shape_, strides_);
+    NoCells_ = no_cells;
+    GeometryVersion_++;
+    polyhedra_ = false;
+    Faces_.reset();
+    FaceOffsets_.reset();
+}
@@ -1,6 +1,7 @@
 #include <iostream>
 #include <array>
 #include <vector>
+#include <string>
 
 #include <vtk_array.hpp>
 
@@ -36,4 +37,28 @@ int main()
     std::vector<dummy> DVec({{1, -9.87, 'a', 5.43}, {2, 8.76, 'b', -4.32}, {3, -7.65, 'c', 3.21}, {4, 6.54, 'd', -2.1}});
     VTK_DataArray("ObjectVectorExample", &DVec[0].value, {DVec.size(), 2}, {sizeof(DVec[0]), stride_between_values}).print();
 
-}
\ No newline at end of file
+    // The gather kernels of all layouts against the value by value access
+    int failures = 0;
+    std::vector<double> values(12*20);
+    for (size_t i=0; i<values.size(); i++) values[i] = 0.5*i;
+    // {components, entity stride, component stride} in values
+    for (const std::array<size_t, 3> layout : std::vector<std::array<size_t, 3>>{{3, 3, 1}, {1, 12, 1}, {3, 12, 1}, {4, 12, 1}, {9, 12, 1}, {3, 1, 20}, {5, 12, 2}})
+    {
+        const size_t noentities = (values.size()-(layout[0]-1)*layout[2])/layout[1];
+        VTK_DataArray<double> data("Gather", values.data(), {noentities, layout[0]}, {layout[1]*sizeof(double), layout[2]*sizeof(double)});
+        for (size_t first : {size_t(0), size_t(1), size_t(5)})
+        {
+            const size_t n = noentities-first;
+            std::vector<double> gathered(n*layout[0]);
+            data.gather(first, n, reinterpret_cast<char*>(gathered.data()));
+            for (size_t i=0; i<n; i++)
+                for (size_t c=0; c<layout[0]; c++)
+                    if (gathered[i*layout[0]+c] != values[(first+i)*layout[1]+c*layout[2]])
+                    {
+                        std::cout << "Gather of layout {" << layout[0] << ", " << layout[1] << ", " << layout[2] << "} failed" << std::endl;
+                        failures++;
+                    }
+        }
+    }
+    return failures;
+}
@@ -0,0 +1,98 @@
+#include <iostream>
+#include <array>
+#include <vector>
+#include <string>
+#include <cmath>
+
+#include <vtk_timeseries.hpp>
+
+#include "test_assets/hexmesh1.hpp"
+#include "vtk_test_helpers.hpp"
+
+// magnitude of the flow of one cell
+double flowMagnitude(size_t cell)
+{
+    return std::sqrt(HexMesh1CellData[3*cell]*HexMesh1CellData[3*cell]+HexMesh1CellData[3*cell+1]*HexMesh1CellData[3*cell+1]+HexMesh1CellData[3*cell+2]*HexMesh1CellData[3*cell+2]);
+}
+
+int main()
+{
+    std::cout << "Test generated data" << std::endl;
+
+    const size_t nocells = HexMesh1CellData.size()/3;
+    std::vector<double> magnitude(nocells);
+    for (size_t i=0; i<nocells; i++) magnitude[i] = flowMagnitude(i);
+
+    // the materialized fields
+    VTK_UnstructuredGrid reference;
+    reference.setNumberOfThreads(2);
+    reference.setPoints(HexMesh1XI);
+    reference.setElements(HexMesh1Elmt, VTK_HEXAHEDRON);
+    reference.addCellData("Flow", HexMesh1CellData, 3);
+    reference.addCellData("Magnitude", magnitude, 1);
+    reference.addNodeData("Bin", HexMesh1NodeData, 1);
+
+    // the same fields computed while writing, per value and per range
+    VTK_UnstructuredGrid generated;
+    generated.setNumberOfThreads(2);
+    generated.setPoints(HexMesh1XI);
+    generated.setElements(HexMesh1Elmt, VTK_HEXAHEDRON);
+    generated.addCellData("Flow", 3, [](size_t cell, size_t comp){ return HexMesh1CellData[3*cell+comp]; });
+    generated.addCellData<double>("Magnitude", 1, [](size_t first, size_t n, double* values){ for (size_t i=0; i<n; i++) values[i] = flowMagnitude(first+i); });
+    generated.addNodeData<int>("Bin", 1, [](size_t node, size_t){ return HexMesh1NodeData[node]; });
+
+    // every format and the Float32 output of the fields
+    std::vector<VTK_WriteSettings> settings = testSettings();
+    settings.push_back(settings[2]);
+    settings.back().float32_fields = true;
+    int failures = 0;
+    for (size_t s=0; s<settings.size(); s++)
+    {
+        const std::string file = "msh_h1_generated"+std::to_string(s)+".vtu";
+        const std::string reference_file = "msh_h1_generated_reference"+std::to_string(s)+".vtu";
+        reference.setWriteSettings(settings[s]);
+        generated.setWriteSettings(settings[s]);
+        reference.write(reference_file);
+        generated.write(file);
+        if (readFile(file) != readFile(reference_file))
+        {
+            std::cout << file << " differs from " << reference_file << std::endl;
+            failures++;
+        }
+    }
+
+    // gathering into an unaligned buffer
+    {
+        VTK_GeneratedArray<double, double(*)(size_t, size_t)> flow("Flow", nocells, 3, [](size_t cell, size_t comp){ return HexMesh1CellData[3*cell+comp]; });
+        std::vector<char> buffer(flow.ByteSize()+1);
+        flow.gather(0, nocells, buffer.data()+1);
+        if (std::memcmp(buffer.data()+1, HexMesh1CellData.data(), flow.ByteSize()) != 0)
+        {
+            std::cout << "The unaligned gather differs from the data" << std::endl;
+            failures++;
+        }
+    }
+
+    // the time series evaluates the generator into its snapshot
+    {
+        VTK_TimeSeries series("generated_series");
+        series.setFormat(VTK_APPENDED_RAW);
+        series.setPoints(HexMesh1XI);
+        series.setElements(HexMesh1Elmt, VTK_HEXAHEDRON);
+        series.addCellData("Flow", HexMesh1CellData, 3);
+        series.addCellData("Magnitude", magnitude, 1);
+        series.addNodeData("Bin", HexMesh1NodeData, 1);
+        series.write(0.0);
+        series.addCellData("Flow", 3, [](size_t cell, size_t comp){ return HexMesh1CellData[3*cell+comp]; });
+        series.addCellData<double>("Magnitude", 1, [](size_t first, size_t n, double* values){ for (size_t i=0; i<n; i++) values[i] = flowMagnitude(first+i); });
+        series.addNodeData<int>("Bin", 1, [](size_t node, size_t){ return HexMesh1NodeData[node]; });
+        series.write(1.0);
+        series.finish();
+        if (readFile("generated_series_000000.vtu") != readFile("generated_series_000001.vtu"))
+        {
+            std::cout << "The generated step of the time series differs" << std::endl;
+            failures++;
+        }
+    }
+    return failures;
+}
@@ -0,0 +1,111 @@
+#include <iostream>
+#include <array>
+#include <vector>
+#include <string>
+
+#include <vtk_hdf.hpp>
+
+#include "test_assets/hexmesh1.hpp"
+#include "vtk_test_helpers.hpp"
+
+// reads a whole dataset of the file, the size of the first dimension is returned in rows
+template <typename T>
+std::vector<T> readDataset(hid_t file, const std::string& name, hid_t type, size_t& rows)
+{
+    hid_t dataset = H5Dopen2(file, name.c_str(), H5P_DEFAULT);
+    if (dataset < 0) return std::vector<T>();
+    hid_t space = H5Dget_space(dataset);
+    hsize_t dims[2] = {0, 1};
+    H5Sget_simple_extent_dims(space, dims, nullptr);
+    std::vector<T> values(dims[0]*dims[1]);
+    H5Dread(dataset, type, H5S_ALL, H5S_ALL, H5P_DEFAULT, values.data());
+    H5Sclose(space);
+    H5Dclose(dataset);
+    rows = dims[0];
+    return values;
+}
+
+int main()
+{
+    std::cout << "Test VTKHDF" << std::endl;
+    int failures = 0;
+    auto check = checker(failures);
+
+    const size_t nopoints = HexMesh1XI.size()/3, nocells = HexMesh1Elmt.size()/8;
+    {
+        VTK_UnstructuredGrid VTKOUT;
+        VTKOUT.setPoints(HexMesh1XI);
+        VTKOUT.setElements(HexMesh1Elmt, VTK_HEXAHEDRON);
+        VTKOUT.setCompressor(VTK_ZLIB);
+        VTK_HDFTimeSeries series("msh_h1.vtkhdf");
+        series.setChunkSize(100);
+        for (size_t step=0; step<4; step++)
+        {
+            // the last step moves to a new geometry
+            if (step == 3) VTKOUT.setElements(HexMesh1Elmt, VTK_HEXAHEDRON);
+            VTKOUT.clearData();
+            VTKOUT.addNodeData("Bin", HexMesh1NodeData, 1);
+            VTKOUT.addCellData("Flow", HexMesh1CellData, 3);
+            VTKOUT.addCellData("Step", 1, [step](size_t, size_t){ return static_cast<int>(step); });
+            series.write(VTKOUT, 0.5*step);
+        }
+        check(series.NoSteps() == 4, "Expected 4 steps");
+
+        // every step provides the fields of the first step
+        VTKOUT.clearData();
+        check(throws([&]() { series.write(VTKOUT, 2.0); }), "Writing a step without the fields did not fail");
+    }
+
+    hid_t file = H5Fopen("msh_h1.vtkhdf", H5F_ACC_RDONLY, H5P_DEFAULT);
+    if (file < 0)
+    {
+        std::cout << "Cannot open msh_h1.vtkhdf" << std::endl;
+        return 1;
+    }
+    hid_t root = H5Gopen2(file, "VTKHDF", H5P_DEFAULT);
+    hid_t attribute = H5Aopen(root, "Type", H5P_DEFAULT);
+    hid_t string_type = H5Aget_type(attribute);
+    std::string type(H5Tget_size(string_type), ' ');
+    H5Aread(attribute, string_type, &type[0]);
+    check(type == "UnstructuredGrid", "Wrong Type "+type);
+    H5Tclose(string_type);
+    H5Aclose(attribute);
+    int64_t nosteps = 0;
+    hid_t steps = H5Gopen2(root, "Steps", H5P_DEFAULT);
+    attribute = H5Aopen(steps, "NSteps", H5P_DEFAULT);
+    H5Aread(attribute, H5T_NATIVE_INT64, &nosteps);
+    H5Aclose(attribute);
+    H5Gclose(steps);
+    H5Gclose(root);
+    check(nosteps == 4, "Wrong NSteps "+std::to_string(nosteps));
+
+    // the geometry is stored twice, the fields once per step
+    size_t rows = 0;
+    const std::vector<double> points = readDataset<double>(file, "VTKHDF/Points", H5T_NATIVE_DOUBLE, rows);
+    check(rows == 2*nopoints && std::equal(HexMesh1XI.begin(), HexMesh1XI.end(), points.begin()), "Wrong Points");
+    const std::vector<int64_t> connectivity = readDataset<int64_t>(file, "VTKHDF/Connectivity", H5T_NATIVE_INT64, rows);
+    check(rows == 2*HexMesh1Elmt.size() && std::equal(HexMesh1Elmt.begin(), HexMesh1Elmt.end(), connectivity.begin()), "Wrong Connectivity");
+    const std::vector<int64_t> offsets = readDataset<int64_t>(file, "VTKHDF/Offsets", H5T_NATIVE_INT64, rows);
+    check(rows == 2*(nocells+1) && offsets[0] == 0 && offsets[nocells] == static_cast<int64_t>(8*nocells) && offsets[nocells+1] == 0, "Wrong Offsets");
+    const std::vector<int64_t> nopoints_parts = readDataset<int64_t>(file, "VTKHDF/NumberOfPoints", H5T_NATIVE_INT64, rows);
+    check(rows == 2 && nopoints_parts[1] == static_cast<int64_t>(nopoints), "Wrong NumberOfPoints");
+    const std::vector<int64_t> point_offsets = readDataset<int64_t>(file, "VTKHDF/Steps/PointOffsets", H5T_NATIVE_INT64, rows);
+    check(point_offsets == std::vector<int64_t>({0, 0, 0, static_cast<int64_t>(nopoints)}), "Wrong PointOffsets");
+    const std::vector<int64_t> part_offsets = readDataset<int64_t>(file, "VTKHDF/Steps/PartOffsets", H5T_NATIVE_INT64, rows);
+    check(part_offsets == std::vector<int64_t>({0, 0, 0, 1}), "Wrong PartOffsets");
+    const std::vector<int64_t> id_offsets = readDataset<int64_t>(file, "VTKHDF/Steps/ConnectivityIdOffsets", H5T_NATIVE_INT64, rows);
+    check(id_offsets.size() == 4 && id_offsets[3] == static_cast<int64_t>(HexMesh1Elmt.size()), "Wrong ConnectivityIdOffsets");
+    const std::vector<double> times = readDataset<double>(file, "VTKHDF/Steps/Values", H5T_NATIVE_DOUBLE, rows);
+    check(times == std::vector<double>({0.0, 0.5, 1.0, 1.5}), "Wrong Values");
+
+    const std::vector<double> flow = readDataset<double>(file, "VTKHDF/CellData/Flow", H5T_NATIVE_DOUBLE, rows);
+    check(rows == 4*nocells && std::equal(HexMesh1CellData.begin(), HexMesh1CellData.end(), flow.begin()+3*nocells), "Wrong Flow");
+    const std::vector<int> stepdata = readDataset<int>(file, "VTKHDF/CellData/Step", H5T_NATIVE_INT, rows);
+    check(rows == 4*nocells && stepdata[2*nocells] == 2, "Wrong Step");
+    const std::vector<int> bin = readDataset<int>(file, "VTKHDF/PointData/Bin", H5T_NATIVE_INT, rows);
+    check(rows == 4*nopoints && std::equal(HexMesh1NodeData.begin(), HexMesh1NodeData.end(), bin.begin()+3*nopoints), "Wrong Bin");
+    const std::vector<int64_t> bin_offsets = readDataset<int64_t>(file, "VTKHDF/Steps/PointDataOffsets/Bin", H5T_NATIVE_INT64, rows);
+    check(bin_offsets == std::vector<int64_t>({0, static_cast<int64_t>(nopoints), static_cast<int64_t>(2*nopoints), static_cast<int64_t>(3*nopoints)}), "Wrong PointDataOffsets");
+    H5Fclose(file);
+    return failures;
+}
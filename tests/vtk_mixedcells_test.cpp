@@ -0,0 +1,148 @@
+#include <iostream>
+#include <sstream>
+#include <array>
+#include <vector>
+#include <string>
+
+#include <vtk_partitionedgrid.hpp>
+#include <vtk_timeseries.hpp>
+
+#include "vtk_test_helpers.hpp"
+
+// packed bytes of an array
+std::vector<char> gatherAll(const VTK_Array& data)
+{
+    std::vector<char> bytes(data.ByteSize());
+    data.gather(0, data.NoEntities(), bytes.data());
+    return bytes;
+}
+
+// ascii values of an array
+std::string formatAll(const VTK_Array& data)
+{
+    std::ostringstream out;
+    VTK_AsciiFormatter formatter;
+    formatter.attach(&out);
+    data.format(formatter, 0, data.NoEntities());
+    formatter.flush();
+    return out.str();
+}
+
+int main()
+{
+    std::cout << "Test mixed cells" << std::endl;
+    int failures = 0;
+    auto check = checker(failures);
+
+    // a hexahedron with a wedge, a pyramid, a tetrahedron, a pentagon and a cube given as polyhedron attached
+    std::vector<double> XI = {0,0,0, 1,0,0, 1,1,0, 0,1,0, 0,0,1, 1,0,1, 1,1,1, 0,1,1,
+                              2,0,0, 2,1,0, 2,0,1, 2,1,1, 0.5,0.5,2, 0.5,-1,0, 0.5,-1,1, 0.5,2,0, 0,0.5,1.5};
+    std::vector<size_t> Elmt = {0,1,2,3,4,5,6,7,  0,1,13,4,5,14,  4,5,6,7,12,  3,2,7,15,  0,3,7,16,4,  1,8,9,2,5,10,11,6};
+    std::vector<size_t> offsets = {0, 8, 14, 19, 23, 28, 36};
+    std::vector<VTK_CELLTYPE> types = {VTK_HEXAHEDRON, VTK_WEDGE, VTK_PYRAMID, VTK_TETRA, VTK_POLYGON, VTK_POLYHEDRON};
+    std::vector<size_t> faces = {6, 4,1,8,9,2, 4,5,10,11,6, 4,1,8,10,5, 4,2,9,11,6, 4,1,2,6,5, 4,8,9,11,10};
+    std::vector<size_t> faceoffsets = {0, 0, 0, 0, 0, 0, faces.size()};
+    std::vector<double> Volume = {1.0, 0.5, 1.0/3.0, 1.0/6.0, 0.0, 1.0};
+
+    VTK_UnstructuredGrid VTKOUT;
+    VTKOUT.setPoints(XI);
+    VTKOUT.setElements(Elmt, offsets, types);
+    VTKOUT.addCellData("Volume", Volume, 1);
+    check(VTKOUT.NoCells() == 6 && VTKOUT.CellType() == VTK_EMPTY_CELL, "Wrong cells of the mixed grid");
+
+    // polyhedra need their faces
+    check(throws([&]() { VTKOUT.write("mixed_without_faces.vtu"); }), "Writing polyhedra without faces did not fail");
+
+    VTKOUT.setFaces(faces, faceoffsets);
+    VTKOUT.write("mixed_cells.vtu");
+    const std::string ascii = readFile("mixed_cells.vtu");
+    check(ascii.find("Name=\"offsets\" format=\"ascii\" type=\"Int32\" >8 14 19 23 28 36 </DataArray>") != std::string::npos, "Wrong offsets");
+    check(ascii.find("Name=\"types\" format=\"ascii\" type=\"UInt8\" >12 13 14 10 7 42 </DataArray>") != std::string::npos, "Wrong types");
+    check(ascii.find("Name=\"faceoffsets\" format=\"ascii\" type=\"Int64\" >-1 -1 -1 -1 -1 31 </DataArray>") != std::string::npos, "Wrong faceoffsets");
+    check(ascii.find("Name=\"faces\" format=\"ascii\" type=\"Int64\" >6 4 1 8 9 2 ") != std::string::npos, "Wrong faces");
+
+    const std::vector<VTK_WriteSettings> settings = testSettings();
+    for (size_t s=0; s<settings.size(); s++)
+    {
+        VTKOUT.setWriteSettings(settings[s]);
+        const std::string file = "mixed_cells"+std::to_string(s)+".vtu";
+        VTKOUT.write(file);
+        check(readFile(file).find("Name=\"faceoffsets\"") != std::string::npos, file+" misses the faceoffsets");
+    }
+
+    // runs of equal cells are written from blocks, which match the explicit offsets and types
+    {
+        std::vector<size_t> RunElmt, RunOffsets = {0};
+        std::vector<VTK_CELLTYPE> RunTypes;
+        for (size_t c=0; c<5; c++)
+            for (size_t i=0; i<40; i++)
+            {
+                RunElmt.insert(RunElmt.end(), Elmt.begin()+offsets[c], Elmt.begin()+offsets[c+1]);
+                RunOffsets.push_back(RunElmt.size());
+                RunTypes.push_back(types[c]);
+            }
+        const std::vector<VTK_CellBlock> blocks = {{VTK_HEXAHEDRON, 40}, {VTK_WEDGE, 40}, {VTK_PYRAMID, 40}, {VTK_TETRA, 40}, {VTK_POLYGON, 40, 5}};
+        const VTK_CellOffsetArray explicit_offsets(RunOffsets.data(), RunTypes.size()), block_offsets(blocks);
+        const VTK_CellTypeArray explicit_types(RunTypes.data(), RunTypes.size()), block_types(blocks);
+        check(gatherAll(explicit_offsets) == gatherAll(block_offsets) && formatAll(explicit_offsets) == formatAll(block_offsets), "The offsets of the blocks differ");
+        check(gatherAll(explicit_types) == gatherAll(block_types) && formatAll(explicit_types) == formatAll(block_types), "The types of the blocks differ");
+        check(block_types.blocks(30, 20).size() == 2 && block_types.blocks(30, 20)[1].no_cells == 10, "Wrong blocks of a cell range");
+
+        VTK_UnstructuredGrid csr, blocked;
+        for (auto* grid : {&csr, &blocked})
+        {
+            grid->setFormat(VTK_APPENDED_RAW);
+            grid->setPoints(XI);
+        }
+        csr.setElements(RunElmt, RunOffsets, RunTypes);
+        blocked.setElements(RunElmt, blocks);
+        check(csr.Types()->Blocked(), "The runs of the CSR cells were not detected");
+        csr.write("mixed_runs_csr.vtu");
+        blocked.write("mixed_runs_blocks.vtu");
+        check(readFile("mixed_runs_csr.vtu") == readFile("mixed_runs_blocks.vtu"), "The CSR and the block cells differ");
+
+        // the pieces of a partitioned mixed grid keep their cells
+        for (auto* grid : {&csr, &blocked})
+        {
+            VTK_PartitionedGrid partitioned(3);
+            partitioned.partition(*grid);
+            std::vector<size_t> connectivity;
+            std::string pieces_types;
+            size_t no_nodes = 0;
+            for (size_t p=0; p<partitioned.NoPieces(); p++)
+            {
+                const VTK_UnstructuredGrid& piece = partitioned.piece(p);
+                pieces_types += formatAll(*piece.Types());
+                std::vector<size_t> piece_connectivity(piece.Connectivity()->NoEntities()*piece.Connectivity()->NoComponents());
+                std::vector<double> points(3*piece.NoPoints());
+                piece.Connectivity()->gather(0, piece.Connectivity()->NoEntities(), reinterpret_cast<char*>(piece_connectivity.data()));
+                piece.Points()->gather(0, piece.NoPoints(), reinterpret_cast<char*>(points.data()));
+                for (size_t i=0; i<piece_connectivity.size(); i++)
+                    check(points[3*piece_connectivity[i]] == XI[3*RunElmt[no_nodes+i]], "Piece "+std::to_string(p)+" has wrong coordinates");
+                no_nodes += piece_connectivity.size();
+            }
+            check(pieces_types == formatAll(explicit_types) && no_nodes == RunElmt.size(), "The pieces do not hold the mixed cells");
+            partitioned.write("mixed_runs.pvtu");
+        }
+    }
+
+    // the time series encodes the mixed geometry once
+    {
+        VTK_TimeSeries series("mixed_series");
+        series.setFormat(VTK_APPENDED_RAW);
+        series.setPoints(XI);
+        series.setElements(Elmt, offsets, types);
+        series.setFaces(faces, faceoffsets);
+        for (size_t step=0; step<2; step++)
+        {
+            series.addCellData("Volume", Volume, 1);
+            series.write(1.0*step);
+        }
+        series.finish();
+        VTKOUT.setWriteSettings(VTK_WriteSettings());
+        VTKOUT.setFormat(VTK_APPENDED_RAW);
+        VTKOUT.write("mixed_cells_appended.vtu");
+        check(readFile("mixed_series_000001.vtu") == readFile("mixed_cells_appended.vtu"), "The step of the time series differs from the grid");
+    }
+    return failures;
+}
@@ -0,0 +1,50 @@
+#include <iostream>
+#include <array>
+#include <vector>
+#include <string>
+
+#include <vtk_unstructuredgrid.hpp>
+
+#include "vtk_test_helpers.hpp"
+
+int main()
+{
+    std::cout << "Test ParallelWrite" << std::endl;
+
+    // Structured block of n^3 hexahedra, large enough to be split into many pieces
+    const size_t n = 40;
+    const std::vector<double> XI = blockPoints({n+1, n+1, n+1}, [](size_t i, size_t j, size_t k) { return std::array<double, 3>{i*0.1, j*0.1+0.01*i, k*0.1}; });
+    const std::vector<size_t> Elmt = blockHexahedra({n+1, n+1, n+1});
+
+    // strided node data: every second entry of an interleaved vector
+    std::vector<double> Interleaved(2*XI.size()/3);
+    for (size_t i=0; i<Interleaved.size(); i++) Interleaved[i] = 0.5*i;
+    std::vector<int> CellIds(n*n*n);
+    for (size_t i=0; i<CellIds.size(); i++) CellIds[i] = static_cast<int>(i);
+
+    VTK_UnstructuredGrid VTKOUT;
+    VTKOUT.setPoints(XI);
+    VTKOUT.setElements(Elmt, VTK_HEXAHEDRON);
+    VTKOUT.addNodeData("Strided", Interleaved.data(), {XI.size()/3, 1}, {2*sizeof(double), sizeof(double)});
+    VTKOUT.addNodeData("Coordinates", XI, 3);
+    VTKOUT.addCellData("Id", CellIds, 1);
+
+    // The output has to be byte identical for any number of threads
+    const std::vector<VTK_WriteSettings> settings = testSettings();
+    int failures = 0;
+    for (size_t s=0; s<settings.size(); s++)
+    {
+        const std::string suffix = std::to_string(s);
+        VTKOUT.setWriteSettings(settings[s]);
+        VTKOUT.setNumberOfThreads(1);
+        const std::string serial = "msh_block"+suffix+"_serial.vtu";
+        if (!VTKOUT.write(serial)) failures++;
+        VTKOUT.setNumberOfThreads(4);
+        const std::string parallel = "msh_block"+suffix+"_parallel.vtu";
+        if (!VTKOUT.write(parallel)) failures++;
+        const bool identical = readFile(serial) == readFile(parallel);
+        std::cout << "setting " << suffix << (identical ? " identical" : " DIFFERENT") << std::endl;
+        if (!identical) failures++;
+    }
+    return failures;
+}
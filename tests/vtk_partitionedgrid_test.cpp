@@ -0,0 +1,81 @@
+#include <iostream>
+#include <array>
+#include <vector>
+#include <string>
+
+#include <vtk_partitionedgrid.hpp>
+
+#include "test_assets/hexmesh1.hpp"
+#include "vtk_test_helpers.hpp"
+
+int main()
+{
+    std::cout << "Test PartitionedGrid" << std::endl;
+
+    VTK_UnstructuredGrid VTKOUT;
+    VTKOUT.setPoints(HexMesh1XI);
+    VTKOUT.setElements(HexMesh1Elmt, VTK_HEXAHEDRON);
+    VTKOUT.addNodeData("NodeData", HexMesh1NodeData, 1);
+    VTKOUT.addCellData("CellData", HexMesh1CellData, 3);
+
+    int failures = 0;
+    const std::vector<VTK_WriteSettings> settings = testSettings();
+    for (size_t s=0; s<settings.size(); s++)
+    {
+        const std::string basename = "msh_h1_partitioned"+std::to_string(s);
+        VTK_PartitionedGrid partitioned(3);
+        partitioned.setWriteSettings(settings[s]);
+        partitioned.setNumberOfThreads(3);
+        partitioned.partition(VTKOUT);
+        partitioned.write(basename+".pvtu");
+
+        // the pieces cover all cells and reference the original coordinates
+        size_t no_cells = 0;
+        for (size_t p=0; p<partitioned.NoPieces(); p++)
+        {
+            const VTK_UnstructuredGrid& piece = partitioned.piece(p);
+            const size_t first = no_cells;
+            no_cells += piece.NoCells();
+            std::vector<size_t> connectivity(piece.NoCells()*8);
+            std::vector<double> points(3*piece.NoPoints());
+            piece.Connectivity()->gather(0, piece.NoCells(), reinterpret_cast<char*>(connectivity.data()));
+            piece.Points()->gather(0, piece.NoPoints(), reinterpret_cast<char*>(points.data()));
+            for (size_t i=0; i<connectivity.size(); i++)
+                for (size_t c=0; c<3; c++)
+                    if (points[3*connectivity[i]+c] != HexMesh1XI[3*HexMesh1Elmt[8*first+i]+c])
+                    {
+                        std::cout << "Piece " << p << " has wrong coordinates" << std::endl;
+                        return 1;
+                    }
+            std::vector<double> celldata(3*piece.NoCells());
+            piece.CellData()[0]->gather(0, piece.NoCells(), reinterpret_cast<char*>(celldata.data()));
+            if (!std::equal(celldata.begin(), celldata.end(), HexMesh1CellData.begin()+3*first))
+            {
+                std::cout << "Piece " << p << " has wrong CellData" << std::endl;
+                failures++;
+            }
+            if (readFile(VTK_PieceFileName(basename+".pvtu", p)).find("NumberOfCells=\""+std::to_string(piece.NoCells())+"\"") == std::string::npos)
+            {
+                std::cout << VTK_PieceFileName(basename+".pvtu", p) << " is incomplete" << std::endl;
+                failures++;
+            }
+        }
+        if (no_cells != VTKOUT.NoCells())
+        {
+            std::cout << "The pieces hold " << no_cells << " of " << VTKOUT.NoCells() << " cells" << std::endl;
+            failures++;
+        }
+
+        // the master file lists the fields and the pieces
+        const std::string pvtu = readFile(basename+".pvtu");
+        for (const std::string& entry : std::vector<std::string>{"<PDataArray type=\"Int32\" Name=\"NodeData\" NumberOfComponents=\"1\" />",
+                                        "<PDataArray type=\"Float64\" Name=\"CellData\" NumberOfComponents=\"3\" />",
+                                        "<Piece Source=\""+basename+"_2.vtu\"/>"})
+            if (pvtu.find(entry) == std::string::npos)
+            {
+                std::cout << basename << ".pvtu misses " << entry << std::endl;
+                failures++;
+            }
+    }
+    return failures;
+}
@@ -0,0 +1,172 @@
+#include <iostream>
+#include <array>
+#include <vector>
+#include <string>
+#include <cmath>
+#include <limits>
+#include <random>
+#include <map>
+#include <functional>
+
+#include <vtk_reader.hpp>
+#include <vtk_unstructuredgrid.hpp>
+
+#include "vtk_test_helpers.hpp"
+
+// largest error of written against values, relative to |values| if relative
+template <typename T>
+double maxError(const std::vector<T>& values, const std::vector<T>& written, bool relative)
+{
+    double error = (values.size() == written.size()) ? 0 : std::numeric_limits<double>::infinity();
+    for (size_t i=0; i<std::min(values.size(), written.size()); i++)
+    {
+        const double difference = std::fabs(double(written[i])-double(values[i]));
+        error = std::max(error, relative ? difference/std::fabs(double(values[i])) : difference);
+    }
+    return error;
+}
+
+int main()
+{
+    std::cout << "Test error bounded fields" << std::endl;
+    int failures = 0;
+    auto check = checker(failures);
+
+    // the kernels on values of all magnitudes
+    std::mt19937 random(11);
+    std::uniform_real_distribution<double> mantissa(-1, 1);
+    std::uniform_int_distribution<int> exponent(-40, 40);
+    std::vector<double> values(10000);
+    for (auto &value : values) value = std::ldexp(mantissa(random), exponent(random));
+    for (double bound : {0.5, 1e-3, 1e-7})
+    {
+        std::vector<double> rounded = values;
+        VTK_RoundMantissa(rounded.data(), rounded.size(), VTK_MantissaBits<double>(bound));
+        check(maxError(values, rounded, true) <= bound, "The rounded mantissa exceeds the relative bound "+std::to_string(bound));
+        std::vector<float> valuesf(values.begin(), values.end()), roundedf = valuesf;
+        VTK_RoundMantissa(roundedf.data(), roundedf.size(), VTK_MantissaBits<float>(bound));
+        check(maxError(valuesf, roundedf, true) <= bound, "The rounded Float32 mantissa exceeds the relative bound "+std::to_string(bound));
+        rounded = values;
+        VTK_RoundToStep(rounded.data(), rounded.size(), VTK_QuantizationStep<double>(bound));
+        check(maxError(values, rounded, false) <= bound, "The rounded steps exceed the absolute bound "+std::to_string(bound));
+        roundedf = valuesf;
+        VTK_RoundToStep(roundedf.data(), roundedf.size(), VTK_QuantizationStep<float>(bound));
+        check(maxError(valuesf, roundedf, false) <= bound, "The rounded Float32 steps exceed the absolute bound "+std::to_string(bound));
+    }
+    const double infinity = std::numeric_limits<double>::infinity(), largest = std::numeric_limits<double>::max();
+    std::vector<double> special = {0.0, -0.0, infinity, -infinity, std::numeric_limits<double>::denorm_min(), largest}, kept = special;
+    VTK_RoundMantissa(kept.data(), kept.size(), 3);
+    check(kept == special, "Zeros, infinities, subnormals or the largest value are rounded");
+    kept = {std::numeric_limits<double>::quiet_NaN()};
+    VTK_RoundMantissa(kept.data(), kept.size(), 3);
+    VTK_RoundToStep(kept.data(), kept.size(), 0.5);
+    check(std::isnan(kept[0]), "NaN is rounded");
+
+    // a block of 40x30x20 hexahedra with smooth fields
+    const std::array<size_t, 3> n = {41, 31, 21};
+    const std::vector<double> XI = blockPoints(n, [](size_t i, size_t j, size_t k) { return std::array<double, 3>{0.1*i, 0.1*j, 0.1*k}; });
+    const std::vector<size_t> Elmt = blockHexahedra(n);
+    const size_t nopoints = XI.size()/3, nocells = Elmt.size()/8;
+    std::vector<double> Stress(nopoints), Velocity(3*nopoints);
+    std::vector<float> Pressure(nocells);
+    std::vector<int> Material(nocells);
+    for (size_t p=0; p<nopoints; p++)
+    {
+        Stress[p] = 2e8*std::sin(XI[3*p])*std::cos(XI[3*p+1])+1e5*XI[3*p+2]+1.0;
+        for (size_t d=0; d<3; d++) Velocity[3*p+d] = std::sin(XI[3*p]+1.3*XI[3*p+1]+0.7*XI[3*p+2]+d)*(1+0.1*XI[3*p+d]);
+    }
+    for (size_t c=0; c<nocells; c++)
+    {
+        Pressure[c] = 1e5f+1e3f*std::sin(0.01f*c);
+        Material[c] = int(c%3);
+    }
+
+    VTK_UnstructuredGrid VTKOUT;
+    VTKOUT.setPoints(XI);
+    VTKOUT.setElements(Elmt, VTK_HEXAHEDRON);
+    VTKOUT.addNodeData("Stress", Stress, 1);
+    VTKOUT.addNodeData("Velocity", Velocity, 3);
+    VTKOUT.addCellData("Pressure", Pressure, 1);
+    VTKOUT.addCellData("Material", Material, 1);
+    VTK_WriteSettings settings;
+    settings.format = VTK_APPENDED_RAW;
+#ifdef VTK_WITH_ZLIB
+    settings.compressor = VTK_ZLIB;
+#endif
+    VTKOUT.setWriteSettings(settings);
+    // encoded bytes of every array in the last write
+    std::map<std::string, size_t> encoded;
+    VTKOUT.setStatisticsCallback([&encoded](const VTK_WriteStatistics& statistics){ for (auto &array : statistics.arrays) encoded[array.name] = array.encoded_bytes; });
+    VTKOUT.write("quantization_lossless.vtu");
+    const std::map<std::string, size_t> lossless = encoded;
+
+    const double stress_bound = 1e-4, velocity_bound = 1e-5, pressure_bound = 1.0;
+    VTKOUT.setErrorBound("Stress", VTK_RELATIVE_ERROR, stress_bound);
+    VTKOUT.setErrorBound("Velocity", VTK_ABSOLUTE_ERROR, velocity_bound, VTK_QUANTIZED_INTEGERS);
+    VTKOUT.setErrorBound("Pressure", VTK_ABSOLUTE_ERROR, pressure_bound);
+    std::vector<VTK_OUTPUTFORMAT> formats = {VTK_ASCII, VTK_BINARY, VTK_APPENDED_RAW};
+    for (auto format : formats)
+    {
+        const std::string suffix = std::to_string(int(format));
+        VTKOUT.setFormat(format);
+        VTKOUT.setNumberOfThreads(1);
+        VTKOUT.write("quantization_bounded"+suffix+".vtu");
+#ifdef VTK_WITH_ZLIB
+        if (format == VTK_APPENDED_RAW)
+            for (auto name : {"Stress", "Velocity", "Pressure"})
+            {
+                check(encoded.at(name) < lossless.at(name)*2/3, std::string(name)+" does not compress better within its error bound");
+            }
+#endif
+        VTKOUT.setNumberOfThreads(4);
+        VTKOUT.write("quantization_bounded"+suffix+"_parallel.vtu");
+        check(readFile("quantization_bounded"+suffix+".vtu") == readFile("quantization_bounded"+suffix+"_parallel.vtu"), "The bounded fields depend on the number of threads in format "+suffix);
+
+        VTK_Reader reader("quantization_bounded"+suffix+".vtu");
+        check(reader.values<double>("Points", "Coordinates") == XI, "The coordinates are not lossless in format "+suffix);
+        check(reader.values<int>("CellData", "Material") == Material, "The integer field is not lossless in format "+suffix);
+        check(maxError(Stress, reader.values<double>("PointData", "Stress"), true) <= stress_bound, "Stress exceeds its relative bound in format "+suffix);
+        check(maxError(Velocity, reader.values<double>("PointData", "Velocity"), false) <= velocity_bound, "Velocity exceeds its absolute bound in format "+suffix);
+        check(maxError(Pressure, reader.values<float>("CellData", "Pressure"), false) <= pressure_bound, "Pressure exceeds its absolute bound in format "+suffix);
+        check(reader.read("PointData", "Velocity")->Type() == "UInt32" && reader.read("PointData", "Stress")->Type() == "Float64", "Wrong types of the bounded fields in format "+suffix);
+    }
+    const std::string bounded = readFile("quantization_bounded1.vtu");
+    check(bounded.find("QuantizationScale=\"") != std::string::npos && bounded.find("QuantizationOffset=\"") != std::string::npos, "The quantization is not described in the DataArray tag");
+
+    // Float32 output of a rounded Float64 field, the bound is coarser than Float32
+    VTKOUT.setFloat32Fields(true);
+    VTKOUT.write("quantization_float32.vtu");
+    {
+        VTK_Reader reader("quantization_float32.vtu");
+        check(reader.read("PointData", "Stress")->Type() == "Float32", "Stress is not written as Float32");
+        check(maxError(Stress, reader.values<double>("PointData", "Stress"), true) <= stress_bound, "The Float32 Stress exceeds its relative bound");
+    }
+    VTKOUT.setFloat32Fields(false);
+
+    // the bounds are removed again
+    for (auto name : {"Stress", "Velocity", "Pressure"}) VTKOUT.setErrorBound(name, VTK_LOSSLESS, 0);
+    VTKOUT.write("quantization_lossless_again.vtu");
+    check(readFile("quantization_lossless_again.vtu") == readFile("quantization_lossless.vtu"), "The fields are not lossless after the bounds are removed");
+
+    check(throws([&]() { VTKOUT.setErrorBound("Stress", VTK_RELATIVE_ERROR, 1e-3, VTK_QUANTIZED_INTEGERS); }), "Relative bounds are quantized");
+    check(throws([&]() { VTKOUT.setErrorBound("Stress", VTK_ABSOLUTE_ERROR, -1); }), "A negative bound is accepted");
+    check(throws([&]()
+    {
+        VTKOUT.setErrorBound("Material", VTK_ABSOLUTE_ERROR, 1);
+        VTKOUT.write("quantization_integer.vtu");
+    }), "An integer field is rounded");
+    VTKOUT.setErrorBound("Material", VTK_LOSSLESS, 0);
+    check(throws([&]()
+    {
+        std::vector<double> invalid(nopoints, 1.0);
+        invalid[5] = std::numeric_limits<double>::quiet_NaN();
+        VTK_DataArray<double> data("Invalid", invalid.data(), {nopoints, 1}, {sizeof(double), sizeof(double)});
+        VTK_QuantizedArray<double> quantized(data, 1e-3);
+    }), "NaN is quantized");
+    check(throws([&]()
+    {
+        VTK_DataArray<double> data("Stress", Stress.data(), {nopoints, 1}, {sizeof(double), sizeof(double)});
+        VTK_QuantizedArray<double> quantized(data, 1e-9);
+    }), "More than 2^32 steps are quantized");
+    return failures;
+}
@@ -0,0 +1,168 @@
+#include <iostream>
+#include <fstream>
+#include <array>
+#include <vector>
+#include <string>
+#include <functional>
+#include <cstring>
+#include <cstdint>
+
+#include <vtk_reader.hpp>
+#include <vtk_polydata.hpp>
+#include <vtk_structuredgrid.hpp>
+#include <vtk_unstructuredgrid.hpp>
+
+#include "vtk_test_helpers.hpp"
+
+int main()
+{
+    std::cout << "Test reader" << std::endl;
+    int failures = 0;
+    auto check = checker(failures);
+
+    // a block of 30x20x10 hexahedra with a few tetrahedra on top, large enough for several compression blocks per array
+    const std::array<size_t, 3> n = {31, 21, 11};
+    const std::vector<double> XI = blockPoints(n, [](size_t i, size_t j, size_t k) { return std::array<double, 3>{0.1*i, 0.2*j+0.01*i, 0.3*k}; });
+    std::vector<size_t> Elmt = blockHexahedra(n), offsets = {0};
+    std::vector<VTK_CELLTYPE> types(Elmt.size()/8, VTK_HEXAHEDRON);
+    for (size_t c=0; c<types.size(); c++) offsets.push_back(8*(c+1));
+    auto point = [&n](size_t i, size_t j, size_t k) { return blockPoint(n, i, j, k); };
+    for (size_t i=0; i<n[0]-1; i++)
+    {
+        Elmt.insert(Elmt.end(), {point(i,0,n[2]-1), point(i+1,0,n[2]-1), point(i,1,n[2]-1), point(i,0,n[2]-2)});
+        offsets.push_back(Elmt.size());
+        types.push_back(VTK_TETRA);
+    }
+    const size_t nopoints = XI.size()/3, nocells = types.size();
+    std::vector<double> Temperature(nopoints), Velocity(4*nopoints);
+    std::vector<float> Pressure(nocells);
+    std::vector<int> Material(2*nocells);
+    for (size_t p=0; p<nopoints; p++) Temperature[p] = 300.0+1.0/(p+1);
+    for (size_t v=0; v<Velocity.size(); v++) Velocity[v] = -0.5*v;
+    for (size_t c=0; c<nocells; c++) Pressure[c] = 1.0f/(c+3);
+    for (size_t m=0; m<Material.size(); m++) Material[m] = int(m%5)-2;
+
+    VTK_UnstructuredGrid VTKOUT;
+    VTKOUT.setPoints(XI);
+    VTKOUT.setElements(Elmt, offsets, types);
+    VTKOUT.addNodeData("Temperature", Temperature, 1);
+    VTKOUT.addNodeData("Velocity", Velocity.data(), {nopoints, 3}, {4*sizeof(double), sizeof(double)});
+    VTKOUT.addCellData("Pressure", Pressure, 1);
+    VTKOUT.addCellData("Material", Material, 2);
+    std::vector<double> Velocity3;
+    for (size_t p=0; p<nopoints; p++) Velocity3.insert(Velocity3.end(), {Velocity[4*p], Velocity[4*p+1], Velocity[4*p+2]});
+
+    const std::vector<VTK_WriteSettings> settings = testSettings();
+    for (size_t s=0; s<settings.size(); s++)
+    {
+        const std::string suffix = std::to_string(s);
+        VTKOUT.setWriteSettings(settings[s]);
+        VTKOUT.write("reader_grid"+suffix+".vtu");
+        for (unsigned int no_threads : {1u, 4u})
+        {
+            const std::string setting = suffix+" with "+std::to_string(no_threads)+" threads";
+            VTK_Reader reader("reader_grid"+suffix+".vtu");
+            reader.setNumberOfThreads(no_threads);
+            check(reader.Type() == "UnstructuredGrid" && reader.NoPoints() == nopoints && reader.NoCells() == nocells, "Wrong grid in setting "+setting);
+            check(reader.Arrays().size() == 8, "Wrong number of arrays in setting "+setting);
+            check(reader.values<double>("Points", "Coordinates") == XI, "Wrong coordinates in setting "+setting);
+            check(reader.values<size_t>("Cells", "connectivity") == Elmt, "Wrong connectivity in setting "+setting);
+            check(reader.values<size_t>("Cells", "offsets") == std::vector<size_t>(offsets.begin()+1, offsets.end()), "Wrong offsets in setting "+setting);
+            check(reader.values<VTK_CELLTYPE>("Cells", "types") == types, "Wrong types in setting "+setting);
+            check(reader.values<double>("PointData", "Temperature") == Temperature, "Wrong Temperature in setting "+setting);
+            check(reader.values<double>("PointData", "Velocity") == Velocity3, "Wrong Velocity in setting "+setting);
+            check(reader.values<float>("CellData", "Pressure") == Pressure, "Wrong Pressure in setting "+setting);
+            check(reader.values<int>("CellData", "Material") == Material, "Wrong Material in setting "+setting);
+            std::shared_ptr<const VTK_ReadArray> pressure = reader.read("CellData", "Pressure");
+            check(pressure->NoEntities() == nocells && pressure->data<float>()[7] == Pressure[7], "Wrong typed view of Pressure in setting "+setting);
+        }
+
+        // the read arrays are written again as they were read
+        VTK_Reader reader("reader_grid"+suffix+".vtu");
+        std::vector<std::shared_ptr<const VTK_ReadArray>> arrays;
+        for (auto &info : reader.Arrays()) arrays.push_back(reader.read(info.section, info.name));
+        const std::vector<const VTK_Array*> geometry = {arrays[0].get(), arrays[1].get(), arrays[2].get(), arrays[3].get()};
+        VTK_WriteUnstructuredGridFile("reader_rewritten"+suffix+".vtu", settings[s], nopoints, nocells, geometry, nullptr, {arrays[4].get(), arrays[5].get()}, {arrays[6].get(), arrays[7].get()}, nullptr);
+        check(readFile("reader_rewritten"+suffix+".vtu") == readFile("reader_grid"+suffix+".vtu"), "The read arrays are not written identically in setting "+suffix);
+    }
+
+    // uncompressed appended values are aligned by the writer and viewed in the mapped file
+    {
+        VTK_Reader reader("reader_grid2.vtu");
+        for (auto &info : reader.Arrays()) check(reader.read(info.section, info.name)->Mapped(), "The values of "+info.name+" are not viewed in the mapped file");
+        VTK_Reader binary("reader_grid1.vtu");
+        check(!binary.read("Cells", "types")->Mapped(), "Base64 values are viewed in the mapped file");
+    }
+
+#ifdef VTK_WITH_ZLIB
+    // VTK's compressors write 0 as the size of the last block if it is full
+    {
+        const size_t nofull = 2*VTK_COMPRESSION_BLOCK_BYTES/sizeof(double);
+        std::vector<double> points(3*nofull), values(nofull);
+        for (size_t i=0; i<points.size(); i++) points[i] = 0.001*i;
+        for (size_t p=0; p<nofull; p++) values[p] = 0.5*(p%1000);
+        VTK_UnstructuredGrid full;
+        full.setPoints(points);
+        full.setElements(std::vector<size_t>{0, 1, 2, 3, 4, 5, 6, 7}, VTK_HEXAHEDRON);
+        full.addNodeData("Temperature", values, 1);
+        VTK_WriteSettings zlib;
+        zlib.format = VTK_APPENDED_RAW;
+        zlib.compressor = VTK_ZLIB;
+        full.setWriteSettings(zlib);
+        full.write("reader_full_block.vtu");
+
+        std::string content = readFile("reader_full_block.vtu");
+        const size_t tag = content.find("offset=\"", content.find("Name=\"Temperature\""))+std::string("offset=\"").size();
+        const size_t header = content.find('_', content.find("<AppendedData"))+1+std::stoul(content.substr(tag));
+        uint32_t last_size;
+        std::memcpy(&last_size, content.data()+header+2*sizeof(uint32_t), sizeof(uint32_t));
+        check(last_size == VTK_COMPRESSION_BLOCK_BYTES, "The last block of Temperature is not full");
+        std::memset(&content[header+2*sizeof(uint32_t)], 0, sizeof(uint32_t));
+        std::ofstream("reader_full_block_vtk.vtu", std::ios::binary) << content;
+        VTK_Reader reader("reader_full_block_vtk.vtu");
+        check(reader.values<double>("PointData", "Temperature") == values, "A full last block with the size 0 is not read");
+    }
+#endif
+
+    // structured grids and poly data
+    const std::array<size_t, 3> dims = {6, 5, 1};
+    std::vector<double> Image(dims[0]*dims[1]);
+    for (size_t p=0; p<Image.size(); p++) Image[p] = 0.5*p;
+    VTK_ImageData image(dims, {1, 2, 3}, {0.5, 0.5, 1});
+    image.addNodeData("Image", Image, 1);
+    image.write("reader_image.vti");
+    VTK_Reader vti("reader_image.vti");
+    check(vti.Type() == "ImageData" && vti.NoPoints() == 30 && vti.NoCells() == 20, "Wrong image");
+    check(vti.Attribute("Spacing") == "0.5 0.5 1" && vti.values<double>("PointData", "Image") == Image, "Wrong image data");
+
+    std::vector<double> x = {0, 1, 3}, y = {0, 2}, z = {-1, 0, 1, 2};
+    VTK_RectilinearGrid rectilinear(x, y, z);
+    VTK_WriteSettings appended;
+    appended.format = VTK_APPENDED_RAW;
+    rectilinear.setWriteSettings(appended);
+    rectilinear.write("reader_rectilinear.vtr");
+    VTK_Reader vtr("reader_rectilinear.vtr");
+    check(vtr.NoPoints() == 24 && vtr.NoCells() == 6, "Wrong rectilinear grid");
+    check(vtr.values<double>("Coordinates", "z_coordinates") == z, "Wrong rectilinear coordinates");
+
+    VTK_PolyData polydata;
+    polydata.setPoints(std::vector<double>(XI.begin(), XI.begin()+12));
+    const std::vector<size_t> polygon = {0, 1, 2, 3}, polygon_offsets = {0, 4};
+    polydata.setPolygons(polygon, polygon_offsets);
+    polydata.write("reader_polydata.vtp");
+    VTK_Reader vtp("reader_polydata.vtp");
+    check(vtp.NoPoints() == 4 && vtp.NoCells() == 1 && vtp.values<size_t>("Polys", "connectivity") == polygon, "Wrong poly data");
+
+    VTK_Reader reader("reader_grid0.vtu");
+    check(throws([&]() { reader.read("PointData", "Pressure"); }), "An array of the wrong section is read");
+    check(throws([&]() { reader.read("CellData", "Pressure")->data<double>(); }), "A typed view of the wrong type is returned");
+    check(throws([&]() { VTK_Reader missing("reader_missing.vtu"); }), "A missing file is read");
+    const std::string content = readFile("reader_grid2.vtu");
+    std::ofstream("reader_truncated.vtu", std::ios::binary) << content.substr(0, content.size()/2);
+    check(throws([&]()
+    {
+        VTK_Reader truncated("reader_truncated.vtu");
+        for (auto &info : truncated.Arrays()) truncated.read(info.section, info.name);
+    }), "A truncated file is read");
+    return failures;
+}
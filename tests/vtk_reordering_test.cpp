@@ -0,0 +1,144 @@
+#include <iostream>
+#include <array>
+#include <vector>
+#include <string>
+#include <random>
+#include <algorithm>
+
+#include <vtk_reader.hpp>
+#include <vtk_unstructuredgrid.hpp>
+
+#include "vtk_test_helpers.hpp"
+
+// mean distance of the lowest and highest point of the cells
+double meanBandwidth(const std::vector<size_t>& Elmt, size_t no_nodes)
+{
+    double bandwidth = 0;
+    for (size_t first=0; first<Elmt.size(); first+=no_nodes)
+    {
+        const auto range = std::minmax_element(Elmt.begin()+first, Elmt.begin()+first+no_nodes);
+        bandwidth += *range.second-*range.first;
+    }
+    return bandwidth/(Elmt.size()/no_nodes);
+}
+
+int main()
+{
+    std::cout << "Test reordering" << std::endl;
+    int failures = 0;
+    auto check = checker(failures);
+
+    // the Hilbert curve visits the points of a 8x8x8 grid one neighbour after another
+    std::vector<std::pair<uint64_t, std::array<uint32_t, 3>>> curve;
+    for (uint32_t i=0; i<8; i++)
+        for (uint32_t j=0; j<8; j++)
+            for (uint32_t k=0; k<8; k++) curve.push_back({VTK_HilbertKey({i, j, k}, 3), {i, j, k}});
+    std::sort(curve.begin(), curve.end());
+    for (size_t p=0; p<curve.size(); p++)
+    {
+        check(curve[p].first == p, "The Hilbert keys are no permutation");
+        if (p == 0) continue;
+        uint32_t distance = 0;
+        for (size_t d=0; d<3; d++) distance += std::max(curve[p].second[d], curve[p-1].second[d])-std::min(curve[p].second[d], curve[p-1].second[d]);
+        check(distance == 1, "The Hilbert curve jumps at key "+std::to_string(p));
+    }
+    check(VTK_MortonKey({1, 0, 0}, 1) == 4 && VTK_MortonKey({0, 1, 0}, 1) == 2 && VTK_MortonKey({0, 0, 1}, 1) == 1 && VTK_MortonKey({3, 0, 0}, 2) == 36, "Wrong Morton keys");
+
+    // a block of 16x12x8 hexahedra with shuffled points and cells
+    const std::array<size_t, 3> n = {17, 13, 9};
+    const size_t nopoints = n[0]*n[1]*n[2];
+    std::vector<size_t> shuffle(nopoints);
+    for (size_t p=0; p<nopoints; p++) shuffle[p] = p;
+    std::mt19937 random(7);
+    std::shuffle(shuffle.begin(), shuffle.end(), random);
+    const std::vector<double> block = blockPoints(n);
+    std::vector<double> XI(3*nopoints);
+    for (size_t p=0; p<nopoints; p++) std::copy(&block[3*p], &block[3*p+3], &XI[3*shuffle[p]]);
+    const std::vector<size_t> hexahedra = blockHexahedra(n);
+    std::vector<std::array<size_t, 8>> cells(hexahedra.size()/8);
+    for (size_t c=0; c<cells.size(); c++)
+        for (size_t v=0; v<8; v++) cells[c][v] = shuffle[hexahedra[8*c+v]];
+    std::shuffle(cells.begin(), cells.end(), random);
+    std::vector<size_t> Elmt;
+    for (auto &cell : cells) Elmt.insert(Elmt.end(), cell.begin(), cell.end());
+    const size_t nocells = cells.size();
+    std::vector<double> Temperature(nopoints), Velocity(3*nopoints);
+    std::vector<int> Material(nocells);
+    for (size_t p=0; p<nopoints; p++) Temperature[p] = XI[3*p]+10*XI[3*p+1]+100*XI[3*p+2];
+    for (size_t v=0; v<Velocity.size(); v++) Velocity[v] = XI[v]*0.5;
+    for (size_t c=0; c<nocells; c++) Material[c] = int(c);
+    const std::vector<double> XI0 = XI;
+    const std::vector<size_t> Elmt0 = Elmt;
+
+    VTK_UnstructuredGrid VTKOUT;
+    VTKOUT.setPoints(XI);
+    VTKOUT.setElements(Elmt, VTK_HEXAHEDRON);
+    VTKOUT.addNodeData("Temperature", Temperature, 1);
+    VTKOUT.addNodeData("Velocity", Velocity, 3);
+    VTKOUT.addCellData("Material", Material, 1);
+    VTK_WriteSettings settings;
+    settings.format = VTK_APPENDED_RAW;
+#ifdef VTK_WITH_ZLIB
+    settings.compressor = VTK_ZLIB;
+#endif
+    VTKOUT.setWriteSettings(settings);
+    VTKOUT.write("reordering_none.vtu");
+    const size_t shuffled_size = readFile("reordering_none.vtu").size();
+    const double shuffled_bandwidth = meanBandwidth(Elmt, 8);
+
+    const std::vector<std::pair<std::string, VTK_REORDERING>> methods = {{"morton", VTK_MORTON}, {"hilbert", VTK_HILBERT}, {"rcm", VTK_RCM}};
+    for (auto &method : methods)
+    {
+        VTKOUT.setReordering(method.second);
+        VTKOUT.setNumberOfThreads(1);
+        VTKOUT.write("reordering_"+method.first+".vtu");
+        std::shared_ptr<const VTK_Reordering> order = VTKOUT.Reordered();
+        check(VTKOUT.Reordered() == order, "The order of "+method.first+" is computed again for the same geometry");
+        VTKOUT.setNumberOfThreads(4);
+        VTKOUT.write("reordering_"+method.first+"_parallel.vtu");
+        check(readFile("reordering_"+method.first+".vtu") == readFile("reordering_"+method.first+"_parallel.vtu"), "The order of "+method.first+" depends on the number of threads");
+        check(XI == XI0 && Elmt == Elmt0, "The buffers of the caller are changed by "+method.first);
+
+        // the same mesh and fields in the new order
+        VTK_Reader reader("reordering_"+method.first+".vtu");
+        const std::vector<double> XIr = reader.values<double>("Points", "Coordinates");
+        const std::vector<size_t> Elmtr = reader.values<size_t>("Cells", "connectivity");
+        const std::vector<double> Temperaturer = reader.values<double>("PointData", "Temperature");
+        const std::vector<int> Materialr = reader.values<int>("CellData", "Material");
+        bool same_points = true, same_cells = true;
+        for (size_t p=0; p<nopoints; p++)
+        {
+            const size_t source = (*order->node_ids)[p];
+            for (size_t d=0; d<3; d++) same_points &= XIr[3*p+d] == XI[3*source+d];
+            same_points &= Temperaturer[p] == Temperature[source];
+        }
+        for (size_t c=0; c<nocells; c++)
+        {
+            same_cells &= Materialr[c] == Material[(*order->cell_ids)[c]];
+            for (size_t i=0; i<8; i++)
+                for (size_t d=0; d<3; d++) same_cells &= XIr[3*Elmtr[8*c+i]+d] == XI[3*cells[Materialr[c]][i]+d];
+        }
+        check(same_points, "The points or node data do not follow the order of "+method.first);
+        check(same_cells, "The cells or cell data do not follow the order of "+method.first);
+        const double bandwidth = meanBandwidth(Elmtr, 8);
+        check(bandwidth < shuffled_bandwidth/5, "The cells of "+method.first+" are not local, mean bandwidth "+std::to_string(bandwidth));
+#ifdef VTK_WITH_ZLIB
+        check(readFile("reordering_"+method.first+".vtu").size() < shuffled_size, "The file of "+method.first+" is not smaller");
+#endif
+    }
+    VTKOUT.setReordering(VTK_NO_REORDERING);
+    VTKOUT.write("reordering_off.vtu");
+    check(readFile("reordering_off.vtu") == readFile("reordering_none.vtu"), "The grid is reordered after the reordering is switched off");
+
+    check(throws([]()
+    {
+        std::vector<double> XIp = {0,0,0, 1,0,0, 0,1,0, 0,0,1};
+        std::vector<size_t> Elmtp = {0, 1, 2, 3};
+        VTK_UnstructuredGrid polyhedra;
+        polyhedra.setPoints(XIp);
+        polyhedra.setElements(Elmtp, {{VTK_POLYHEDRON, 1, 4}});
+        polyhedra.setReordering(VTK_HILBERT);
+        polyhedra.Reordered();
+    }), "Polyhedra are reordered");
+    return failures;
+}
@@ -0,0 +1,8 @@
+// A second translation unit of vtuexporttest, the headers have to link without multiple definitions
+#include <vtk_partitionedgrid.hpp>
+#include <vtk_polydata.hpp>
+#include <vtk_reader.hpp>
+#include <vtk_streamingwriter.hpp>
+#include <vtk_structuredgrid.hpp>
+#include <vtk_timeseries.hpp>
+#include <vtk_unstructuredgrid.hpp>
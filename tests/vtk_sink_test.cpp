@@ -0,0 +1,87 @@
+#include <iostream>
+#include <array>
+#include <vector>
+#include <string>
+#include <csignal>
+
+#include <vtk_unstructuredgrid.hpp>
+#ifdef VTK_WITH_POSIX_SINKS
+#include <sys/resource.h>
+#endif
+
+#include "test_assets/hexmesh1.hpp"
+#include "vtk_test_helpers.hpp"
+
+int main()
+{
+    std::cout << "Test Sinks" << std::endl;
+
+    VTK_UnstructuredGrid VTKOUT;
+    VTKOUT.setNumberOfThreads(2);
+    VTKOUT.setPoints(HexMesh1XI);
+    VTKOUT.setElements(HexMesh1Elmt, VTK_HEXAHEDRON);
+    VTKOUT.addCellData("Flow", HexMesh1CellData, 3);
+    VTKOUT.addNodeData("Bin", HexMesh1NodeData, 1);
+
+    const std::vector<VTK_WriteSettings> settings = testSettings();
+    int failures = 0;
+    auto check = checker(failures);
+    for (size_t s=0; s<settings.size(); s++)
+    {
+        VTKOUT.setWriteSettings(settings[s]);
+        const std::string reference = "msh_h1_sink_reference"+std::to_string(s)+".vtu";
+        VTKOUT.write(reference);
+        const std::string expected = readFile(reference);
+
+        // every backend writes the identical file
+        for (VTK_FILEBACKEND backend : {VTK_MAPPED_FILE, VTK_ASYNC_FILE})
+        {
+            const std::string file = "msh_h1_sink"+std::to_string(s)+"_"+std::to_string(backend)+".vtu";
+            VTKOUT.setFileBackend(backend);
+            VTKOUT.write(file);
+            VTKOUT.setFileBackend(VTK_STREAM_FILE);
+            check(readFile(file) == expected, file+" differs from "+reference);
+        }
+
+        // many small requests in flight at the same time
+        {
+            VTK_AsyncFileSink sink("msh_h1_sink_async"+std::to_string(s)+".vtu", 1000, 3);
+            VTKOUT.write(sink);
+        }
+        check(readFile("msh_h1_sink_async"+std::to_string(s)+".vtu") == expected, "The small requests of the async sink differ from "+reference);
+
+        VTK_MemorySink memory;
+        VTKOUT.write(memory);
+        check(std::string(memory.data(), memory.size()) == expected, "The memory sink differs from "+reference);
+    }
+
+    // failures of every backend reach the caller
+    for (VTK_FILEBACKEND backend : {VTK_STREAM_FILE, VTK_MAPPED_FILE, VTK_ASYNC_FILE})
+        for (const std::string path : {"missing_directory/msh_h1.vtu", "/dev/full"})
+        {
+            VTKOUT.setFileBackend(backend);
+            check(throws([&]() { VTKOUT.write(path); }), "Writing "+path+" with backend "+std::to_string(backend)+" did not fail");
+        }
+
+#ifdef VTK_WITH_POSIX_SINKS
+    // a mapping beyond the space of the disk throws when it is allocated, a limited file size stands in for the full disk
+    {
+        struct rlimit limit, previous;
+        getrlimit(RLIMIT_FSIZE, &previous);
+        limit = previous;
+        limit.rlim_cur = 1 << 16;
+        std::signal(SIGXFSZ, SIG_IGN);
+        setrlimit(RLIMIT_FSIZE, &limit);
+        const bool thrown = throws([]()
+        {
+            VTK_MappedFileSink sink("sink_full.vtu");
+            const std::vector<char> bytes(1 << 18, 'x');
+            sink.write(bytes.data(), bytes.size());
+            sink.close();
+        });
+        setrlimit(RLIMIT_FSIZE, &previous);
+        check(thrown, "The mapped file sink did not fail on a full disk");
+    }
+#endif
+    return failures;
+}
@@ -0,0 +1,85 @@
+#include <iostream>
+#include <array>
+#include <vector>
+#include <string>
+
+#include <vtk_timeseries.hpp>
+
+#include "test_assets/hexmesh1.hpp"
+#include "vtk_test_helpers.hpp"
+
+int main()
+{
+    std::cout << "Test WriteStatistics" << std::endl;
+
+    const std::vector<VTK_WriteSettings> settings = testSettings();
+    int failures = 0;
+    auto check = checker(failures);
+
+    for (size_t s=0; s<settings.size(); s++)
+    {
+        const std::string file = "msh_h1_statistics"+std::to_string(s)+".vtu";
+        VTK_UnstructuredGrid VTKOUT;
+        VTKOUT.setWriteSettings(settings[s]);
+        VTKOUT.setNumberOfThreads(2);
+        VTKOUT.setPoints(HexMesh1XI);
+        VTKOUT.setElements(HexMesh1Elmt, VTK_HEXAHEDRON);
+        VTKOUT.addCellData("Flow", HexMesh1CellData, 3);
+        VTKOUT.addNodeData("Bin", HexMesh1NodeData, 1);
+        VTKOUT.write("msh_h1_reference.vtu");
+
+        VTK_WriteStatistics statistics;
+        size_t calls = 0;
+        VTKOUT.setStatisticsCallback([&](const VTK_WriteStatistics& written){ statistics = written; calls++; });
+        VTKOUT.setStatisticsSidecar(true);
+        VTKOUT.write(file);
+
+        // measuring does not change the file
+        const std::string content = readFile(file);
+        check(content == readFile("msh_h1_reference.vtu"), file+" differs from the file written without statistics");
+        check(calls == 1, "The callback is called once per write");
+        check(statistics.file_bytes == content.size(), "The file bytes do not match the file size");
+        check(statistics.arrays.size() == 6, "Expected statistics of 6 arrays");
+        if (statistics.arrays.size() != 6) continue;
+
+        const std::vector<std::string> names = {"Coordinates", "connectivity", "offsets", "types", "Bin", "Flow"};
+        size_t encoded = 0;
+        for (size_t i=0; i<names.size(); i++)
+        {
+            check(statistics.arrays[i].name == names[i], "Expected array "+names[i]+", got "+statistics.arrays[i].name);
+            check(statistics.arrays[i].encoded_bytes > 0, names[i]+" has no encoded bytes");
+            encoded += statistics.arrays[i].encoded_bytes;
+        }
+        check(encoded < statistics.file_bytes, "The arrays exceed the file");
+        check(statistics.arrays[1].type == "UInt32" && statistics.arrays[1].raw_bytes == HexMesh1Elmt.size()*sizeof(uint32_t), "Wrong connectivity statistics");
+        check(statistics.arrays[5].entities == 360 && statistics.arrays[5].components == 3, "Wrong Flow statistics");
+        check(statistics.threads == 2, "Wrong number of threads");
+
+        const std::string json = readFile(file+".json");
+        check(json == statistics.json(), "The sidecar differs from the statistics");
+        check(json.find("\"name\": \"Flow\", \"type\": \"Float64\", \"entities\": 360, \"components\": 3") != std::string::npos, "The sidecar misses Flow");
+    }
+
+    // The time series reports the reused geometry as well
+    {
+        std::vector<VTK_WriteStatistics> steps;
+        VTK_TimeSeries series("statistics_series");
+        series.setFormat(VTK_APPENDED_RAW);
+        series.setStatisticsCallback([&steps](const VTK_WriteStatistics& written){ steps.push_back(written); });
+        series.setPoints(HexMesh1XI);
+        series.setElements(HexMesh1Elmt, VTK_HEXAHEDRON);
+        for (size_t step=0; step<2; step++)
+        {
+            series.addCellData("Flow", HexMesh1CellData, 3);
+            series.write(1.0*step);
+        }
+        series.finish();
+        check(steps.size() == 2, "Expected statistics of 2 steps");
+        for (auto &written : steps)
+        {
+            check(written.arrays.size() == 5 && written.arrays[0].name == "Coordinates" && written.arrays[4].name == "Flow", "Wrong arrays of "+written.file);
+            check(written.file_bytes == readFile(written.file).size(), "The file bytes do not match the size of "+written.file);
+        }
+    }
+    return failures;
+}
@@ -0,0 +1,142 @@
+#include <iostream>
+#include <array>
+#include <vector>
+#include <string>
+#include <functional>
+
+#include <vtk_streamingwriter.hpp>
+#include <vtk_unstructuredgrid.hpp>
+
+#include "vtk_test_helpers.hpp"
+
+// removes the zero padding of the offsets written by the streaming writer and the spaces which align the appended data
+std::string stripOffsets(std::string content)
+{
+    const std::string start = "<AppendedData encoding=\"raw\">\n";
+    const size_t appended = content.find(start);
+    if (appended != std::string::npos) content.erase(appended+start.size(), content.find('_', appended)-appended-start.size());
+    const std::string attribute = "offset=\"";
+    for (size_t position = content.find(attribute); position != std::string::npos; position = content.find(attribute, position+1))
+    {
+        const size_t first = position+attribute.size();
+        size_t last = first;
+        while (content[last] == '0' && content[last+1] != '"') last++;
+        content.erase(first, last-first);
+    }
+    return content;
+}
+
+int main()
+{
+    std::cout << "Test streaming writer" << std::endl;
+    int failures = 0;
+    auto check = checker(failures);
+
+    // a block of 24x20x16 hexahedra, large enough for several compression blocks per array
+    const std::array<size_t, 3> n = {25, 21, 17};
+    std::vector<double> XI = blockPoints(n);
+    std::vector<size_t> Elmt = blockHexahedra(n);
+    const size_t nopoints = XI.size()/3, nocells = Elmt.size()/8;
+    std::vector<size_t> offsets(nocells);
+    for (size_t c=0; c<nocells; c++) offsets[c] = 8*(c+1);
+    std::vector<VTK_CELLTYPE> types(nocells, VTK_HEXAHEDRON);
+    // the velocity is stored with a fourth unused component, written through a strided view
+    std::vector<double> Temperature(nopoints), Velocity(4*nopoints);
+    std::vector<float> Pressure(nocells);
+    std::vector<int> Material(2*nocells);
+    for (size_t p=0; p<nopoints; p++) Temperature[p] = 0.25*p;
+    for (size_t v=0; v<Velocity.size(); v++) Velocity[v] = 1.0/(v+1);
+    for (size_t c=0; c<nocells; c++) Pressure[c] = 0.5f*c;
+    for (size_t m=0; m<Material.size(); m++) Material[m] = int(m%7);
+
+    VTK_UnstructuredGrid VTKOUT;
+    VTKOUT.setPoints(XI);
+    VTKOUT.setElements(Elmt, VTK_HEXAHEDRON);
+    VTKOUT.addNodeData("Temperature", Temperature, 1);
+    VTKOUT.addNodeData("Velocity", Velocity.data(), {nopoints, 3}, {4*sizeof(double), sizeof(double)});
+    VTKOUT.addCellData("Pressure", Pressure, 1);
+    VTKOUT.addCellData("Material", Material, 2);
+
+    // appends every array in blocks of rows
+    const size_t rows = 1001;
+    auto stream = [&](const std::string& path, VTK_COMPRESSOR compressor, unsigned int no_threads)
+    {
+        VTK_StreamingWriter writer(path, nopoints, nocells, Elmt.size());
+        writer.setCompressor(compressor);
+        writer.setNumberOfThreads(no_threads);
+        writer.addCellData<float>("Pressure", 1);
+        writer.addNodeData<double>("Temperature", 1);
+        writer.addCellData<int>("Material", 2);
+        writer.addNodeData<double>("Velocity", 3);
+        writer.begin();
+        check(writer.Current() == "Coordinates", "The coordinates are not appended first");
+        for (size_t first=0; first<nopoints; first+=rows) writer.append(XI.data()+3*first, std::min(rows, nopoints-first));
+        for (size_t first=0; first<Elmt.size(); first+=8*rows) writer.append(Elmt.data()+first, std::min(8*rows, Elmt.size()-first));
+        for (size_t first=0; first<nocells; first+=rows) writer.append(offsets.data()+first, std::min(rows, nocells-first));
+        for (size_t first=0; first<nocells; first+=rows) writer.append(types.data()+first, std::min(rows, nocells-first));
+        check(writer.Current() == "Temperature", "The node data does not follow the cells");
+        for (size_t first=0; first<nopoints; first+=rows) writer.append(Temperature.data()+first, std::min(rows, nopoints-first));
+        for (size_t first=0; first<nopoints; first+=rows)
+            writer.append(VTK_DataArray<double>("Velocity", Velocity.data()+4*first, {std::min(rows, nopoints-first), 3}, {4*sizeof(double), sizeof(double)}));
+        for (size_t first=0; first<nocells; first+=rows) writer.append(Pressure.data()+first, std::min(rows, nocells-first));
+        for (size_t first=0; first<nocells; first+=rows) writer.append(Material.data()+2*first, std::min(rows, nocells-first));
+        check(writer.Current().empty(), "Arrays are left after all data is appended");
+        return writer.finish();
+    };
+
+    std::vector<VTK_COMPRESSOR> compressors = {VTK_NO_COMPRESSION};
+#ifdef VTK_WITH_ZLIB
+    compressors.push_back(VTK_ZLIB);
+#endif
+    for (size_t c=0; c<compressors.size(); c++)
+    {
+        const std::string suffix = std::to_string(c);
+        VTK_WriteSettings settings;
+        settings.format = VTK_APPENDED_RAW;
+        settings.compressor = compressors[c];
+        VTKOUT.setWriteSettings(settings);
+        VTKOUT.write("streaming_reference"+suffix+".vtu");
+        stream("streaming_sequential"+suffix+".vtu", compressors[c], 1);
+        stream("streaming_parallel"+suffix+".vtu", compressors[c], 4);
+        const std::string reference = readFile("streaming_reference"+suffix+".vtu");
+        check(stripOffsets(readFile("streaming_sequential"+suffix+".vtu")) == stripOffsets(reference), "The streamed file differs from the grid in setting "+suffix);
+        check(readFile("streaming_sequential"+suffix+".vtu") == readFile("streaming_parallel"+suffix+".vtu"), "The streamed file depends on the number of threads in setting "+suffix);
+    }
+
+    // a grid without cells
+    {
+        VTK_StreamingWriter writer("streaming_points.vtu", 2, 0, 0);
+        writer.begin();
+        writer.append(XI.data(), 2);
+        check(writer.Current().empty(), "The empty cell arrays are not complete");
+        writer.finish();
+        check(readFile("streaming_points.vtu").find("NumberOfCells=\"0\" NumberOfPoints=\"2\"") != std::string::npos, "Wrong piece of a grid without cells");
+    }
+
+    check(throws([&]()
+    {
+        VTK_StreamingWriter writer("streaming_error.vtu", nopoints, nocells, Elmt.size());
+        writer.begin();
+        writer.append(XI.data(), nopoints+1);
+    }), "Too many rows are accepted");
+    check(throws([&]()
+    {
+        VTK_StreamingWriter writer("streaming_error.vtu", nopoints, nocells, Elmt.size());
+        writer.begin();
+        writer.append(Pressure.data(), nopoints);
+    }), "Rows of the wrong type are accepted");
+    check(throws([&]()
+    {
+        VTK_StreamingWriter writer("streaming_error.vtu", nopoints, nocells, Elmt.size());
+        writer.begin();
+        writer.append(XI.data(), nopoints);
+        writer.finish();
+    }), "An incomplete file is finished");
+    check(throws([&]()
+    {
+        VTK_StreamingWriter writer("streaming_error.vtu", nopoints, nocells, Elmt.size());
+        writer.begin();
+        writer.addNodeData<double>("Temperature", 1);
+    }), "Data is declared after begin()");
+    return failures;
+}
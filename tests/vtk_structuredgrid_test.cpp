@@ -0,0 +1,89 @@
+#include <iostream>
+#include <array>
+#include <vector>
+#include <string>
+
+#include <vtk_structuredgrid.hpp>
+#include <vtk_unstructuredgrid.hpp>
+
+#include "vtk_test_helpers.hpp"
+
+int main()
+{
+    std::cout << "Test structured grids" << std::endl;
+    int failures = 0;
+    auto check = checker(failures);
+
+    // a uniform 20x15x10 grid of points, x numbered fastest
+    const std::array<size_t, 3> n = {20, 15, 10};
+    const std::array<double, 3> origin = {1.0, -0.5, 0.0}, spacing = {0.25, 0.5, 0.1};
+    std::vector<double> x(n[0]), y(n[1]), z(n[2]);
+    for (size_t i=0; i<n[0]; i++) x[i] = origin[0]+i*spacing[0];
+    for (size_t j=0; j<n[1]; j++) y[j] = origin[1]+j*spacing[1];
+    for (size_t k=0; k<n[2]; k++) z[k] = origin[2]+k*spacing[2];
+    const size_t nopoints = n[0]*n[1]*n[2], nocells = (n[0]-1)*(n[1]-1)*(n[2]-1);
+    std::vector<double> Temperature(nopoints), Velocity(3*nocells);
+    for (size_t p=0; p<nopoints; p++) Temperature[p] = 0.5*p;
+    for (size_t c=0; c<3*nocells; c++) Velocity[c] = 1.0/(c+1);
+
+    VTK_ImageData image(n, origin, spacing);
+    check(image.NoPoints() == nopoints && image.NoCells() == nocells, "Wrong number of points or cells of the image");
+    image.addNodeData("Temperature", Temperature, 1);
+    image.addCellData("Velocity", Velocity, 3);
+
+    VTK_RectilinearGrid rectilinear(x, y, z);
+    check(rectilinear.NoPoints() == nopoints && rectilinear.NoCells() == nocells, "Wrong number of points or cells of the rectilinear grid");
+    rectilinear.addNodeData("Temperature", Temperature, 1);
+    rectilinear.addCellData("Velocity", Velocity, 3);
+
+    // the same grid as explicit hexahedra
+    const std::vector<double> XI = blockPoints(n, [&](size_t i, size_t j, size_t k) { return std::array<double, 3>{x[i], y[j], z[k]}; });
+    const std::vector<size_t> Elmt = blockHexahedra(n);
+    VTK_UnstructuredGrid hexahedra;
+    hexahedra.setPoints(XI);
+    hexahedra.setElements(Elmt, VTK_HEXAHEDRON);
+    hexahedra.addNodeData("Temperature", Temperature, 1);
+    hexahedra.addCellData("Velocity", Velocity, 3);
+
+    const std::vector<VTK_WriteSettings> settings = testSettings();
+    for (size_t s=0; s<settings.size(); s++)
+    {
+        const std::string suffix = std::to_string(s);
+        image.setWriteSettings(settings[s]);
+        rectilinear.setWriteSettings(settings[s]);
+        hexahedra.setWriteSettings(settings[s]);
+        image.write("structured_image"+suffix+".vti");
+        rectilinear.write("structured_rectilinear"+suffix+".vtr");
+        hexahedra.write("structured_hexahedra"+suffix+".vtu");
+        const std::string vti = readFile("structured_image"+suffix+".vti");
+        const std::string vtr = readFile("structured_rectilinear"+suffix+".vtr");
+        const std::string vtu = readFile("structured_hexahedra"+suffix+".vtu");
+
+        check(vti.find("<ImageData WholeExtent=\"0 19 0 14 0 9\" Origin=\"1 -0.5 0\" Spacing=\"0.25 0.5 0.1\">") != std::string::npos, "Wrong ImageData element in setting "+suffix);
+        check(vti.find("<Piece Extent=\"0 19 0 14 0 9\">") != std::string::npos, "Wrong ImageData piece in setting "+suffix);
+        check(vti.find("<Points>") == std::string::npos && vti.find("<Cells>") == std::string::npos, "The image writes points or cells in setting "+suffix);
+        check(vtr.find("<RectilinearGrid WholeExtent=\"0 19 0 14 0 9\">") != std::string::npos, "Wrong RectilinearGrid element in setting "+suffix);
+        check(vtr.find("<Coordinates>") != std::string::npos && vtr.find("Name=\"z_coordinates\"") != std::string::npos, "Missing coordinates in setting "+suffix);
+
+        // the fields are written exactly as for the unstructured grid, the geometry is a fraction of it
+        const std::string fields = vtu.substr(vtu.find("<PointData>"), vtu.find("</CellData>")-vtu.find("<PointData>"));
+        if (settings[s].format != VTK_APPENDED_RAW) check(vti.find(fields) != std::string::npos && vtr.find(fields) != std::string::npos, "The fields differ from the unstructured grid in setting "+suffix);
+        if (settings[s].format != VTK_APPENDED_RAW) check(vti.size() < fields.size()+1000 && vtr.size() < fields.size()+2000, "The structured geometry is not negligible in setting "+suffix);
+        check(vti.size() < vtu.size() && vtr.size() < vtu.size(), "The structured files are not smaller than the unstructured file in setting "+suffix);
+    }
+
+    // ascii values of the coordinates and the fields
+    const std::string vtr = readFile("structured_rectilinear0.vtr");
+    check(vtr.find(">1 1.25 1.5 1.75 2 ") != std::string::npos, "Wrong x coordinates");
+    check(readFile("structured_image0.vti").find(">0 0.5 1 1.5 2 ") != std::string::npos, "Wrong Temperature");
+
+    // 2D data: a single point in z direction
+    VTK_ImageData plane({4, 3, 1});
+    check(plane.NoPoints() == 12 && plane.NoCells() == 6, "Wrong number of points or cells of a plane");
+    plane.write("structured_plane.vti");
+    check(readFile("structured_plane.vti").find("WholeExtent=\"0 3 0 2 0 0\" Origin=\"0 0 0\" Spacing=\"1 1 1\"") != std::string::npos, "Wrong extent of a plane");
+
+    check(throws([&]() { image.addNodeData("Wrong", Velocity.data(), {nocells, 3}, {3*sizeof(double), sizeof(double)}); }), "Node data of the wrong size is accepted");
+    check(throws([]() { VTK_ImageData empty({4, 0, 1}); }), "An image without points is accepted");
+    return failures;
+}
@@ -0,0 +1,110 @@
+#include <iostream>
+#include <sstream>
+#include <array>
+#include <vector>
+#include <string>
+
+#include <vtk_unstructuredgrid.hpp>
+
+#include "vtk_test_helpers.hpp"
+
+int main()
+{
+    std::cout << "Test surface extraction" << std::endl;
+    int failures = 0;
+    auto check = checker(failures);
+
+    // a block of 4x3x2 hexahedra
+    const std::array<size_t, 3> n = {5, 4, 3};
+    std::vector<double> XI = blockPoints(n);
+    std::vector<size_t> Elmt = blockHexahedra(n);
+    const size_t nopoints = XI.size()/3, nocells = Elmt.size()/8;
+    std::vector<double> Temperature(nopoints), Pressure(nocells);
+    for (size_t p=0; p<nopoints; p++) Temperature[p] = p;
+    for (size_t c=0; c<nocells; c++) Pressure[c] = 0.5*c;
+
+    VTK_UnstructuredGrid VTKOUT;
+    VTKOUT.setPoints(XI);
+    VTKOUT.setElements(Elmt, VTK_HEXAHEDRON);
+    VTKOUT.addNodeData("Temperature", Temperature, 1);
+    VTKOUT.addCellData("Pressure", Pressure, 1);
+
+    // 2*(4*3+3*2+2*4) quadrilaterals on all points but the 3*2*1 interior ones
+    std::shared_ptr<const VTK_Surface> surface = VTKOUT.Surface();
+    check(surface->cell_ids->size() == 52 && surface->offsets.size() == 53 && surface->connectivity.size() == 4*52, "Wrong number of boundary faces");
+    check(surface->node_ids->size() == nopoints-6, "Wrong number of surface points");
+    check(VTKOUT.Surface() == surface, "The surface is extracted again for the same geometry");
+    for (size_t f=0; f<surface->cell_ids->size(); f++)
+    {
+        // the normals point outwards
+        std::array<double, 3> centroid = {0, 0, 0}, a, b;
+        std::array<std::array<double, 3>, 4> corners;
+        for (size_t i=0; i<4; i++)
+            for (size_t d=0; d<3; d++)
+            {
+                corners[i][d] = XI[3*(*surface->node_ids)[surface->connectivity[surface->offsets[f]+i]]+d];
+                centroid[d] += corners[i][d]/4;
+            }
+        for (size_t d=0; d<3; d++)
+        {
+            a[d] = corners[1][d]-corners[0][d];
+            b[d] = corners[2][d]-corners[1][d];
+        }
+        const std::array<double, 3> normal = {a[1]*b[2]-a[2]*b[1], a[2]*b[0]-a[0]*b[2], a[0]*b[1]-a[1]*b[0]};
+        double outwards = 0;
+        for (size_t d=0; d<3; d++) outwards += normal[d]*(centroid[d]-0.5*(n[d]-1));
+        check(outwards > 0, "Face "+std::to_string(f)+" points inwards");
+    }
+
+    // the file is identical for any number of threads, node and cell data follow the points and cells
+    const std::vector<VTK_WriteSettings> settings = testSettings();
+    for (size_t s=0; s<settings.size(); s++)
+    {
+        const std::string suffix = std::to_string(s);
+        VTKOUT.setWriteSettings(settings[s]);
+        VTKOUT.setNumberOfThreads(1);
+        VTKOUT.writeSurface("surface_sequential"+suffix+".vtp");
+        VTKOUT.setNumberOfThreads(4);
+        VTKOUT.setPoints(XI);
+        VTKOUT.setElements(Elmt, VTK_HEXAHEDRON);
+        VTKOUT.clearData();
+        VTKOUT.addNodeData("Temperature", Temperature, 1);
+        VTKOUT.addCellData("Pressure", Pressure, 1);
+        VTKOUT.writeSurface("surface_parallel"+suffix+".vtp");
+        check(readFile("surface_sequential"+suffix+".vtp") == readFile("surface_parallel"+suffix+".vtp"), "The surface depends on the number of threads in setting "+suffix);
+    }
+    const std::string vtp = readFile("surface_sequential0.vtp");
+    check(vtp.find("<PolyData>\n<Piece NumberOfPoints=\"54\" NumberOfVerts=\"0\" NumberOfLines=\"0\" NumberOfStrips=\"0\" NumberOfPolys=\"52\">") != std::string::npos, "Wrong PolyData piece");
+    check(vtp.find("<Polys>") != std::string::npos, "Missing polygons");
+    surface = VTKOUT.Surface();
+    std::ostringstream temperature, pressure;
+    for (auto &node : *surface->node_ids) temperature << Temperature[node] << " ";
+    for (auto &cell : *surface->cell_ids) pressure << Pressure[cell] << " ";
+    check(vtp.find(">"+temperature.str()) != std::string::npos, "Wrong node data on the surface");
+    check(vtp.find(">"+pressure.str()) != std::string::npos, "Wrong cell data on the surface");
+
+    // mixed and quadratic cells: a hexahedron with a wedge, a pyramid and a tetrahedron attached, and a separate quadratic tetrahedron
+    std::vector<double> XIm = {0,0,0, 1,0,0, 1,1,0, 0,1,0, 0,0,1, 1,0,1, 1,1,1, 0,1,1, 0.5,0.5,2, 0.5,-1,0, 0.5,-1,1, 0.5,2,0,
+                               5,0,0, 6,0,0, 5,1,0, 5,0,1, 5.5,0,0, 5.5,0.5,0, 5,0.5,0, 5,0,0.5, 5.5,0,0.5, 5,0.5,0.5};
+    std::vector<size_t> Elmtm = {0,1,2,3,4,5,6,7,  0,1,9,4,5,10,  4,5,6,7,8,  3,2,7,11,  12,13,14,15,16,17,18,19,20,21};
+    std::vector<size_t> offsets = {0, 8, 14, 19, 23, 33};
+    std::vector<VTK_CELLTYPE> types = {VTK_HEXAHEDRON, VTK_WEDGE, VTK_PYRAMID, VTK_TETRA, VTK_QUADRATIC_TETRA};
+    VTK_UnstructuredGrid mixed;
+    mixed.setPoints(XIm);
+    mixed.setElements(Elmtm, offsets, types);
+    surface = mixed.Surface();
+    // hexahedron 6-2, wedge 5-1, pyramid 5-1, tetrahedron 4 (its triangle does not match the quadrilateral), quadratic tetrahedron 4
+    check(surface->cell_ids->size() == 4+4+4+4+4, "Wrong number of boundary faces of the mixed cells, got "+std::to_string(surface->cell_ids->size()));
+    check(surface->node_ids->size() == XIm.size()/3, "Wrong number of surface points of the mixed cells");
+    check(surface->offsets.back()-surface->offsets[surface->offsets.size()-2] == 6, "The faces of the quadratic tetrahedron are not 6 node polygons");
+    mixed.writeSurface("surface_mixed.vtp");
+
+    check(throws([&]()
+    {
+        VTK_UnstructuredGrid polyhedra;
+        polyhedra.setPoints(XIm);
+        polyhedra.setElements(Elmtm, {{VTK_POLYHEDRON, 1, 8}, {VTK_POLYHEDRON, 1, 6}, {VTK_PYRAMID, 1}, {VTK_TETRA, 1}, {VTK_QUADRATIC_TETRA, 1}});
+        polyhedra.Surface();
+    }), "The surface of polyhedra is extracted");
+    return failures;
+}
@@ -0,0 +1,100 @@
+#pragma once
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <array>
+#include <functional>
+#include <stdexcept>
+
+#include <vtk_definitions.hpp>
+
+// reads a whole file into a string
+inline std::string readFile(const std::string& path)
+{
+    std::ifstream infile(path, std::ios::binary);
+    std::stringstream content;
+    content << infile.rdbuf();
+    return content.str();
+}
+
+// check(condition, message) prints the message and counts a failure if the condition does not hold
+inline std::function<void(bool, const std::string&)> checker(int& failures)
+{
+    return [&failures](bool condition, const std::string& message)
+    {
+        if (condition) return;
+        std::cout << message << std::endl;
+        failures++;
+    };
+}
+
+// true if task throws a std::runtime_error
+inline bool throws(const std::function<void()>& task)
+{
+    try
+    {
+        task();
+    }
+    catch (const std::runtime_error& error)
+    {
+        return true;
+    }
+    return false;
+}
+
+// the settings every writer is tested in: ascii, binary and appended raw, then the compressed formats of the available compressors
+inline std::vector<VTK_WriteSettings> testSettings()
+{
+    std::vector<VTK_WriteSettings> settings(3);
+    settings[1].format = VTK_BINARY;
+    settings[2].format = VTK_APPENDED_RAW;
+#ifdef VTK_WITH_ZLIB
+    for (auto format : {VTK_BINARY, VTK_APPENDED_RAW})
+    {
+        settings.push_back(VTK_WriteSettings());
+        settings.back().format = format;
+        settings.back().compressor = VTK_ZLIB;
+    }
+#endif
+#ifdef VTK_WITH_LZ4
+    settings.push_back(VTK_WriteSettings());
+    settings.back().format = VTK_APPENDED_RAW;
+    settings.back().compressor = VTK_LZ4;
+#endif
+    return settings;
+}
+
+// index of point (i, j, k) of a block of n[0] x n[1] x n[2] points
+inline size_t blockPoint(const std::array<size_t, 3>& n, size_t i, size_t j, size_t k) { return i+n[0]*(j+n[1]*k); }
+
+// coordinates of the points of a block, coordinate(i, j, k) places point (i, j, k), by default at (i, j, k)
+inline std::vector<double> blockPoints(const std::array<size_t, 3>& n, const std::function<std::array<double, 3>(size_t, size_t, size_t)>& coordinate = nullptr)
+{
+    std::vector<double> XI;
+    XI.reserve(3*n[0]*n[1]*n[2]);
+    for (size_t k=0; k<n[2]; k++)
+        for (size_t j=0; j<n[1]; j++)
+            for (size_t i=0; i<n[0]; i++)
+            {
+                const std::array<double, 3> x = coordinate ? coordinate(i, j, k) : std::array<double, 3>{double(i), double(j), double(k)};
+                XI.insert(XI.end(), x.begin(), x.end());
+            }
+    return XI;
+}
+
+// connectivity of the (n[0]-1) x (n[1]-1) x (n[2]-1) hexahedra of a block of points, in the order of their corner (i, j, k)
+inline std::vector<size_t> blockHexahedra(const std::array<size_t, 3>& n)
+{
+    std::vector<size_t> Elmt;
+    Elmt.reserve(8*(n[0]-1)*(n[1]-1)*(n[2]-1));
+    auto point = [&n](size_t i, size_t j, size_t k) { return blockPoint(n, i, j, k); };
+    for (size_t k=0; k+1<n[2]; k++)
+        for (size_t j=0; j+1<n[1]; j++)
+            for (size_t i=0; i+1<n[0]; i++)
+                Elmt.insert(Elmt.end(), {point(i,j,k), point(i+1,j,k), point(i+1,j+1,k), point(i,j+1,k),
+                                         point(i,j,k+1), point(i+1,j,k+1), point(i+1,j+1,k+1), point(i,j+1,k+1)});
+    return Elmt;
+}
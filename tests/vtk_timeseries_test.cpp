@@ -0,0 +1,79 @@
+#include <iostream>
+#include <array>
+#include <vector>
+#include <string>
+
+#include <vtk_timeseries.hpp>
+
+#include "test_assets/hexmesh1.hpp"
+#include "vtk_test_helpers.hpp"
+
+int main()
+{
+    std::cout << "Test TimeSeries" << std::endl;
+
+    const std::vector<VTK_WriteSettings> settings = testSettings();
+    int failures = 0;
+    for (size_t s=0; s<settings.size(); s++)
+    {
+        const std::string basename = "series"+std::to_string(s);
+        std::vector<double> XI = HexMesh1XI;
+        std::vector<double> Temperature(XI.size()/3);
+        std::vector<double> Flow = HexMesh1CellData;
+
+        // Write four steps through the series, the mesh moves before the last one
+        VTK_TimeSeries series(basename);
+        series.setWriteSettings(settings[s]);
+        series.setNumberOfThreads(2);
+        series.setPoints(XI);
+        series.setElements(HexMesh1Elmt, VTK_HEXAHEDRON);
+        for (size_t step=0; step<4; step++)
+        {
+            if (step == 3)
+            {
+                for (auto &x : XI) x *= 2.0;
+                series.setPoints(XI);
+                series.setElements(HexMesh1Elmt, VTK_HEXAHEDRON);
+            }
+            for (size_t i=0; i<Temperature.size(); i++) Temperature[i] = 0.1*step+i;
+            series.addNodeData("Temperature", Temperature, 1);
+            series.addCellData("Flow", Flow, 3);
+            series.write(0.5*step);
+            // the snapshot is taken, the solver can go on modifying its buffers
+            for (auto &f : Flow) f += 1.0;
+        }
+        series.finish();
+
+        // Every step has to match the direct export
+        std::vector<double> Reference = HexMesh1XI;
+        std::vector<double> ReferenceFlow = HexMesh1CellData;
+        for (size_t step=0; step<4; step++)
+        {
+            if (step == 3) for (auto &x : Reference) x *= 2.0;
+            for (size_t i=0; i<Temperature.size(); i++) Temperature[i] = 0.1*step+i;
+            VTK_UnstructuredGrid VTKOUT;
+            VTKOUT.setWriteSettings(settings[s]);
+            VTKOUT.setPoints(Reference);
+            VTKOUT.setElements(HexMesh1Elmt, VTK_HEXAHEDRON);
+            VTKOUT.addNodeData("Temperature", Temperature, 1);
+            VTKOUT.addCellData("Flow", ReferenceFlow, 3);
+            VTKOUT.write(basename+"_reference.vtu");
+            for (auto &f : ReferenceFlow) f += 1.0;
+            const std::string file = basename+"_00000"+std::to_string(step)+".vtu";
+            if (readFile(file) != readFile(basename+"_reference.vtu"))
+            {
+                std::cout << file << " differs from the direct export" << std::endl;
+                failures++;
+            }
+        }
+
+        // The collection lists all steps
+        const std::string pvd = readFile(basename+".pvd");
+        if (pvd.find("timestep=\"1.5\" group=\"\" part=\"0\" file=\""+basename+"_000003.vtu\"") == std::string::npos)
+        {
+            std::cout << basename << ".pvd is incomplete" << std::endl;
+            failures++;
+        }
+    }
+    return failures;
+}
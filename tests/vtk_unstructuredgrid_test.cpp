@@ -1,12 +1,12 @@
 #include <iostream>
-#include <fstream>
-#include <sstream>
 #include <array>
 #include <vector>
+#include <string>
 
 #include <vtk_unstructuredgrid.hpp>
 
 #include "test_assets/hexmesh1.hpp"
+#include "vtk_test_helpers.hpp"
 
 int main()
 {
@@ -41,5 +41,36 @@ int main()
     VTKOUT_2.addNodeData("Bin", HexMesh1NodeData, 1);
     VTKOUT_2.write("msh_h1.vtu");
 
+    // Test 3:
+    // Export both meshes again as raw binary into the appended data section
+    VTKOUT_1.setFormat(VTK_APPENDED_RAW);
+    if (!VTKOUT_1.write("msh_t1_appended.vtu")) return 1;
+    VTKOUT_2.setFormat(VTK_APPENDED_RAW);
+    if (!VTKOUT_2.write("msh_h1_appended.vtu")) return 1;
+
+    // Test 4:
+    // Export base64 encoded inline binary, with and without zlib block compression on four threads
+    VTKOUT_2.setFormat(VTK_BINARY);
+    if (!VTKOUT_2.write("msh_h1_binary.vtu")) return 1;
+#ifdef VTK_WITH_ZLIB
+    VTKOUT_2.setCompressor(VTK_ZLIB);
+    VTKOUT_2.setNumberOfThreads(4);
+    if (!VTKOUT_2.write("msh_h1_binary_zlib.vtu")) return 1;
+    VTKOUT_2.setFormat(VTK_APPENDED_RAW);
+    if (!VTKOUT_2.write("msh_h1_appended_zlib.vtu")) return 1;
+#endif
+
+    // Test 5:
+    // Narrowed types: UInt32 connectivity, Float32 fields, Int64 offsets beyond 2^31
+    VTKOUT_2.setFloat32Fields(true);
+    if (!VTKOUT_2.write("msh_h1_appended_float32.vtu")) return 1;
+    const std::string content = readFile("msh_h1_appended_float32.vtu");
+    for (const std::string type : {"Name=\"connectivity\" format=\"appended\" type=\"UInt32\"", "Name=\"Flow\" NumberOfComponents=\"3\" format=\"appended\" type=\"Float32\""})
+        if (content.find(type) == std::string::npos) return 1;
+    VTK_CellOffsetArray offsets(300000000, 8);
+    int64_t last_offset;
+    offsets.gather(offsets.NoEntities()-1, 1, reinterpret_cast<char*>(&last_offset));
+    if (offsets.Type() != "Int64" || last_offset != int64_t(2400000000)) return 1;
+
     return 0;
 }